@@ -0,0 +1,103 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       GcsBatchCheck.cpp
+ * \author     Pavel Kriz
+ * \date       17/10/2026
+ * \brief      Standalone check of the batch localization (sm::solve3Kto2Kand1UBatch) against the per triple sm::solve3Kto2Kand1U
+ *
+ *  The program is built separately from the application (with impl/SpaceModule.cpp and OpenCV core).
+ *  The fixed triples of several references are localized by the batch function and one by one by the per triple function,
+ *  the batch is run with fewer triples than sm::GCS_BATCH_STRIPE_SIZE (one stripe) and with more of them (parallel stripes).
+ *  It returns 0 when all the coordinates are within GCS_TOLERANCE, 1 otherwise.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "../impl/SpaceModule.h"
+
+using namespace std;
+using namespace cv;
+
+const vector<sm::SGcsCoords> REFERENCE_P2 = { sm::SGcsCoords(14.4213, 50.0870), sm::SGcsCoords(16.6080, 49.1951), sm::SGcsCoords(-0.1276, 51.5072) }; ///< global locations of p2 of the references
+const vector<sm::SGcsCoords> REFERENCE_P3 = { sm::SGcsCoords(14.4209, 50.0872), sm::SGcsCoords(16.6082, 49.1955), sm::SGcsCoords(-0.1279, 51.5071) }; ///< global locations of p3 of the references
+const double GCS_TOLERANCE = 1e-9; ///< maximal difference (degrees) of the batch and per triple coordinates (about 0.1 mm)
+
+/**
+ * @brief Creates the fixed triples, the corners p2, p3 of the reference are about 10 units apart and the camera p1 is in front of them
+ * @param count number of the triples
+ * @return the triples, their reference indices go through all the references
+*/
+static sm::SPlanarTriplesBatch fixedTriples(size_t count)
+{
+	sm::SPlanarTriplesBatch triples;
+	triples.reserve(count);
+	//fixed seed, the triples are the same in every run
+	RNG rng(0x6C5);
+	for (size_t i = 0; i < count; ++i) {
+		Point2d p3(rng.uniform(-5.0, 5.0), rng.uniform(-5.0, 5.0));
+		Point2d p2 = p3 + Point2d(rng.uniform(8.0, 12.0), rng.uniform(-1.0, 1.0));
+		Point2d p1((p2.x + p3.x) / 2 + rng.uniform(-10.0, 10.0), p3.y - rng.uniform(5.0, 40.0));
+		triples.push_back(p1, p2, p3, (int)(i % REFERENCE_P2.size()));
+	}
+	return triples;
+}
+
+/**
+ * @brief Localizes the triples by both functions and compares the coordinates
+ * @param count number of the triples
+ * @return true if all the coordinates are within GCS_TOLERANCE
+*/
+static bool checkBatch(size_t count)
+{
+	sm::SPlanarTriplesBatch triples = fixedTriples(count);
+	vector<sm::SGcsReferenceFrame> frames;
+	for (size_t r = 0; r < REFERENCE_P2.size(); ++r) {
+		frames.push_back(sm::createGcsReferenceFrame(REFERENCE_P2[r], REFERENCE_P3[r]));
+	}
+	vector<double> longitudes, latitudes;
+	sm::solve3Kto2Kand1UBatch(triples, frames, longitudes, latitudes);
+
+	//the per triple function does not log anything
+	Ptr<CLogger> logger;
+	double maxDifference = 0.0;
+	for (size_t i = 0; i < count; ++i) {
+		int r = triples.referenceIndex_[i];
+		sm::SGcsCoords expected = sm::solve3Kto2Kand1U(Point2d(triples.p1x_[i], triples.p1y_[i]), Point2d(triples.p2x_[i], triples.p2y_[i]),
+			Point2d(triples.p3x_[i], triples.p3y_[i]), REFERENCE_P2[r], REFERENCE_P3[r], logger);
+		maxDifference = max(maxDifference, max(abs(longitudes[i] - expected.longitude), abs(latitudes[i] - expected.latitude_)));
+	}
+	bool passed = longitudes.size() == count && latitudes.size() == count && maxDifference <= GCS_TOLERANCE;
+	cout << (passed ? "[OK]     " : "[FAILED] ") << count << " triples, maximal difference: " << maxDifference
+		<< "[deg] (tolerance: " << GCS_TOLERANCE << ")" << endl;
+	return passed;
+}
+
+int main()
+{
+	cout << "Batch localization check:" << endl;
+	bool passed = true;
+	for (size_t count : { (size_t)1, (size_t)100, sm::GCS_BATCH_STRIPE_SIZE * 3 + 7 }) {
+		passed &= checkBatch(count);
+	}
+
+	//the reference index out of range has to be rejected
+	sm::SPlanarTriplesBatch invalid = fixedTriples(1);
+	invalid.referenceIndex_[0] = (int)REFERENCE_P2.size();
+	vector<double> longitudes, latitudes;
+	bool rejected = false;
+	try {
+		sm::solve3Kto2Kand1UBatch(invalid, vector<sm::SGcsReferenceFrame>(REFERENCE_P2.size()), longitudes, latitudes);
+	}
+	catch (const invalid_argument&) {
+		rejected = true;
+	}
+	cout << (rejected ? "[OK]     " : "[FAILED] ") << "reference index out of range is rejected" << endl;
+	passed &= rejected;
+
+	cout << (passed ? "Batch localization check passed." : "Batch localization check FAILED.") << endl;
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       PoseSolversCheck.cpp
+ * \author     Pavel Kriz
+ * \date       17/10/2026
+ * \brief      Standalone check and microbenchmark of the IPPE pose solver (pp::solvePlanarPose) against the iterative solvePnP
+ *
+ *  The program is built separately from the application (with impl/PlanarPose.cpp and OpenCV core and calib3d).
+ *  The corners of the fixed references are projected with the fixed poses (noiseless), both solvers have to give the same pose
+ *  within ROTATION_TOLERANCE and TRANSLATION_TOLERANCE. Then the time of both solvers is measured on the same corners.
+ *  It returns 0 when the check passes, 1 otherwise.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <string>
+
+//solvePnP
+#include <opencv2/calib3d.hpp>
+
+#include "../impl/PlanarPose.h"
+
+using namespace std;
+using namespace cv;
+
+const vector<Size> REFERENCE_SIZES = { Size(1000, 700), Size(640, 960), Size(1600, 400) }; ///< sizes of the references (the facades)
+const vector<Vec3d> ROTATIONS = { Vec3d(0.0, 0.0, 0.0), Vec3d(0.3, 0.0, 0.0), Vec3d(0.0, -0.4, 0.0),
+	Vec3d(0.2, 0.35, 0.1), Vec3d(-0.25, -0.3, -0.15) }; ///< rotation vectors of the poses
+const double ROTATION_TOLERANCE = 0.01; ///< maximal rotation difference (degrees) of the IPPE and iterative poses
+const double TRANSLATION_TOLERANCE = 1e-4; ///< maximal translation difference (relative to the distance) of the IPPE and iterative poses
+const int BENCHMARK_REPETITIONS = 1000; ///< number of the repetitions of every solver in the benchmark
+
+/**
+ * @brief Test case - the corners of the reference and their noiseless projections
+*/
+struct SPoseCase {
+	string name_; ///< description of the case
+	vector<Point3d> objCorners3D_; ///< 3D reference corners (0, 0, 1), (w, 0, 1), (w, h, 1), (0, h, 1) as in CImageLocator3D::calcLocation
+	vector<Point2d> sceneCorners_; ///< projected corners
+};
+
+/**
+ * @brief the iterative solver of CImageLocator3D::solvePoseIterative (two runs of solvePnP, the second one starts from the first one)
+*/
+static void solvePoseIterative(const vector<Point3d>& objCorners3D, const vector<Point2d>& sceneCorners, const Matx33d& cameraMatrix, Vec3d& rVec, Vec3d& tVec)
+{
+	solvePnP(objCorners3D, sceneCorners, cameraMatrix, noArray(), rVec, tVec, false, SOLVEPNP_ITERATIVE);
+	solvePnP(objCorners3D, sceneCorners, cameraMatrix, noArray(), rVec, tVec, true, SOLVEPNP_ITERATIVE);
+}
+
+/**
+ * @brief the IPPE solver called the same way as CImageLocator3D::solvePoseIppe
+*/
+static bool solvePoseIppe(const vector<Point3d>& objCorners3D, const vector<Point2d>& sceneCorners, const Matx33d& cameraMatrix, bool refine, pp::SPlanarPose& pose)
+{
+	array<Point2d, pp::PLANAR_POSE_POINTS> objectPoints, imagePoints;
+	for (int i = 0; i < pp::PLANAR_POSE_POINTS; ++i) {
+		objectPoints[i] = Point2d(objCorners3D[i].x, objCorners3D[i].y);
+		imagePoints[i] = sceneCorners[i];
+	}
+	return pp::solvePlanarPose(objectPoints, objCorners3D[0].z, imagePoints, cameraMatrix, refine, pose);
+}
+
+/**
+ * @brief Creates the cases - every reference with every pose, the center of the reference is on the optical axis and it spans about a half of the image width
+ * @param cameraMatrix the camera intrinsics
+ * @return the cases
+*/
+static vector<SPoseCase> createCases(const Matx33d& cameraMatrix)
+{
+	vector<SPoseCase> cases;
+	for (const Size& size : REFERENCE_SIZES) {
+		vector<Point3d> objCorners3D = { Point3d(0.0, 0.0, 1.0), Point3d(size.width, 0.0, 1.0), Point3d(size.width, size.height, 1.0), Point3d(0.0, size.height, 1.0) };
+		Vec3d center(size.width / 2.0, size.height / 2.0, 1.0);
+		double distance = cameraMatrix(0, 0) * size.width / cameraMatrix(0, 2);
+		for (size_t p = 0; p < ROTATIONS.size(); ++p) {
+			Matx33d R = pp::rotationVectorToMatrix(ROTATIONS[p]);
+			Vec3d t = Vec3d(0.0, 0.0, distance) - R * center;
+			SPoseCase poseCase;
+			poseCase.name_ = "reference " + to_string(size.width) + "x" + to_string(size.height) + ", pose " + to_string(p);
+			poseCase.objCorners3D_ = objCorners3D;
+			for (const Point3d& corner : objCorners3D) {
+				Vec3d projected = cameraMatrix * (R * Vec3d(corner.x, corner.y, corner.z) + t);
+				poseCase.sceneCorners_.emplace_back(projected[0] / projected[2], projected[1] / projected[2]);
+			}
+			cases.push_back(move(poseCase));
+		}
+	}
+	return cases;
+}
+
+/**
+ * @brief Solves the case by both solvers and compares the poses
+ * @param poseCase the case
+ * @param cameraMatrix the camera intrinsics
+ * @param refine whether the IPPE pose is refined
+ * @return true if the poses are within the tolerances
+*/
+static bool checkCase(const SPoseCase& poseCase, const Matx33d& cameraMatrix, bool refine)
+{
+	string name = poseCase.name_ + (refine ? ", IPPE refined" : ", IPPE");
+	Vec3d iterativeRVec, iterativeTVec;
+	solvePoseIterative(poseCase.objCorners3D_, poseCase.sceneCorners_, cameraMatrix, iterativeRVec, iterativeTVec);
+	pp::SPlanarPose ippe;
+	if (!solvePoseIppe(poseCase.objCorners3D_, poseCase.sceneCorners_, cameraMatrix, refine, ippe)) {
+		cout << "[FAILED] " << name << ": IPPE failed (degenerated corners)" << endl;
+		return false;
+	}
+	//angle of the relative rotation and the translation difference relative to the distance of the reference
+	double rotationDifference = norm(pp::rotationMatrixToVector(ippe.R_.t() * pp::rotationVectorToMatrix(iterativeRVec))) * 180.0 / CV_PI;
+	double translationDifference = norm(ippe.t_ - iterativeTVec) / max(norm(iterativeTVec), numeric_limits<double>::epsilon());
+	bool passed = rotationDifference <= ROTATION_TOLERANCE && translationDifference <= TRANSLATION_TOLERANCE;
+	cout << (passed ? "[OK]     " : "[FAILED] ") << name << ": rotation difference: " << rotationDifference
+		<< "[deg], relative translation difference: " << translationDifference << endl;
+	return passed;
+}
+
+/**
+ * @brief Measures the time of both solvers on all the cases and prints it
+ * @param cases the cases
+ * @param cameraMatrix the camera intrinsics
+*/
+static void benchmark(const vector<SPoseCase>& cases, const Matx33d& cameraMatrix)
+{
+	Vec3d rVec, tVec;
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	for (int i = 0; i < BENCHMARK_REPETITIONS; ++i) {
+		for (const SPoseCase& poseCase : cases) {
+			solvePoseIterative(poseCase.objCorners3D_, poseCase.sceneCorners_, cameraMatrix, rVec, tVec);
+		}
+	}
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	const double solvedPoses = (double)BENCHMARK_REPETITIONS * cases.size();
+	cout << "iterative: " << chrono::duration<double, micro>(end - begin).count() / solvedPoses << "[us] per pose" << endl;
+
+	for (bool refine : { false, true }) {
+		pp::SPlanarPose pose;
+		begin = chrono::steady_clock::now();
+		for (int i = 0; i < BENCHMARK_REPETITIONS; ++i) {
+			for (const SPoseCase& poseCase : cases) {
+				solvePoseIppe(poseCase.objCorners3D_, poseCase.sceneCorners_, cameraMatrix, refine, pose);
+			}
+		}
+		end = chrono::steady_clock::now();
+		cout << (refine ? "IPPE refined: " : "IPPE: ") << chrono::duration<double, micro>(end - begin).count() / solvedPoses << "[us] per pose" << endl;
+	}
+}
+
+int main()
+{
+	//intrinsics of 4032x3024 image in the form of CImageLocator3D::createCameraIntrinsicsMatrix (focal length 4.25 mm, chip 5.64 x 4.23 mm)
+	const double width = 4032.0, height = 3024.0;
+	const Matx33d cameraMatrix(
+		width * 4.25 / 5.64, 0.0, width / 2,
+		0.0, height * 4.25 / 4.23, height / 2,
+		0.0, 0.0, 1.0);
+	vector<SPoseCase> cases = createCases(cameraMatrix);
+
+	cout << "Pose solvers check (noiseless corners):" << endl;
+	bool passed = true;
+	for (const SPoseCase& poseCase : cases) {
+		for (bool refine : { false, true }) {
+			passed &= checkCase(poseCase, cameraMatrix, refine);
+		}
+	}
+
+	cout << "Pose solvers benchmark (" << BENCHMARK_REPETITIONS << " repetitions of " << cases.size() << " poses):" << endl;
+	benchmark(cases, cameraMatrix);
+
+	cout << (passed ? "Pose solvers check passed." : "Pose solvers check FAILED.") << endl;
+	return passed ? 0 : 1;
+}
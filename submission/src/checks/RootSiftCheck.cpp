@@ -0,0 +1,189 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       RootSiftCheck.cpp
+ * \author     Pavel Kriz
+ * \date       17/10/2026
+ * \brief      Standalone check of the RootSIFT kernels (dk::rootSiftRow) against the original CImage implementation
+ *
+ *  The program is built separately from the application (with impl/DescriptorKernels.cpp and OpenCV core).
+ *  Every kernel (scalar, AVX2 when the CPU supports it, precise) and dk::rootSiftNormalize is run on the fixed descriptors
+ *  and compared with the original implementation, the AVX2 kernel is also compared with the scalar one.
+ *  It returns 0 when all the differences are within dk::ROOTSIFT_TOLERANCE, 1 otherwise.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#include <iostream>
+#include <string>
+
+#include "../impl/DescriptorKernels.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief the original CImage::fastRootSiftDescriptorsAdjust (baseline), without the logging
+*/
+static void baselineFastRootSift(Mat& keypointsDescriptors_)
+{
+	double eps = 1e-7;
+	//for every descriptor do some processing
+	for (size_t i = 0; i < keypointsDescriptors_.rows; ++i) {
+
+		//L1 normalization
+		double norm1Sum = 0;
+		for (size_t j = 0; j < keypointsDescriptors_.cols; ++j) {
+			//the values in the descriptor vector should be in range [0,1]
+			norm1Sum += keypointsDescriptors_.at<float>(i, j);
+		}
+
+		double norm2Sum = 0;
+
+		//converting the descriptor to the Hellinger kernel
+		for (size_t j = 0; j < keypointsDescriptors_.cols; ++j) {
+			//no problem here with the sqrt since the descriptopr will be always positive
+			(keypointsDescriptors_.at<float>(i, j) = sqrt((keypointsDescriptors_.at<float>(i, j) + eps) / norm1Sum));
+			norm2Sum += (keypointsDescriptors_.at<float>(i, j) * keypointsDescriptors_.at<float>(i, j));
+		}
+
+		norm2Sum += eps;
+
+		//L2 normalisation
+		for(size_t j = 0; j < keypointsDescriptors_.cols; ++j) {
+			keypointsDescriptors_.at<float>(i, j) = keypointsDescriptors_.at<float>(i, j) / norm2Sum;
+		}
+	}
+}
+
+/**
+ * @brief the original CImage::preciseRootSiftDescriptorsAdjust (baseline), without the logging
+*/
+static void baselinePreciseRootSift(Mat& keypointsDescriptors_)
+{
+	double eps = 1e-7;
+
+	Mat floatDescriptors;
+	keypointsDescriptors_.convertTo(floatDescriptors, CV_64F);
+
+	//for every descriptor do some processing
+	for (size_t i = 0; i < floatDescriptors.rows; ++i) {
+
+		double norm1Sum = 0;
+		for (size_t j = 0; j < floatDescriptors.cols; ++j) {
+			//the values in the descriptor vector should be in range [0,1]
+			norm1Sum += floatDescriptors.at<double>(i, j);
+		}
+
+		double norm2Sum = 0;
+		//converting the descriptor to the Hellinger kernel
+		for (size_t j = 0; j < floatDescriptors.cols; ++j) {
+			//no problem here with the sqrt since the descriptopr will be always positive
+			(floatDescriptors.at<double>(i, j) = sqrt((floatDescriptors.at<double>(i, j) + eps) / norm1Sum));
+			norm2Sum += (floatDescriptors.at<double>(i, j) * floatDescriptors.at<double>(i, j));
+		}
+
+		norm2Sum += eps;
+
+		//L2 normalisation
+		for (size_t j = 0; j < floatDescriptors.cols; ++j) {
+			//the values in the descriptor vector should be in range [0,1]
+			keypointsDescriptors_.at<float>(i, j) = (float)floatDescriptors.at<double>(i, j) / norm2Sum;
+		}
+	}
+}
+
+/**
+ * @brief Creates the fixed SIFT-like descriptors (values in range [0, 255], no zero descriptor - the baseline divides it by zero)
+ * @param cols number of the values of the descriptor (not a multiple of 8 to check the tails of the vectorised kernel)
+ * @return the descriptors (CV_32F)
+*/
+static Mat fixedDescriptors(int cols)
+{
+	const int rows = 512;
+	Mat descriptors(rows, cols, CV_32F);
+	//fixed seed, the descriptors are the same in every run
+	RNG rng(0x5EED);
+	rng.fill(descriptors, RNG::UNIFORM, 0.0, 256.0);
+	for (int i = 0; i < rows; ++i) {
+		float* row = descriptors.ptr<float>(i);
+		for (int j = 0; j < cols; ++j) {
+			row[j] = floor(row[j]);
+			//SIFT descriptors are sparse, every second row has most of the values zero
+			if (i % 2 == 1 && (j % 5) != 0) {
+				row[j] = 0.0f;
+			}
+		}
+	}
+	//extreme rows - only one non zero value, all values maximal, all values minimal non zero
+	descriptors.row(0).setTo(0.0f);
+	descriptors.at<float>(0, cols / 2) = 255.0f;
+	descriptors.row(1).setTo(255.0f);
+	descriptors.row(2).setTo(1.0f);
+	return descriptors;
+}
+
+/**
+ * @brief Runs the kernel on the copy of the descriptors
+ * @param descriptors the SIFT descriptors
+ * @param kernel the kernel
+ * @return the RootSIFT descriptors
+*/
+static Mat runKernel(const Mat& descriptors, dk::ERootSiftKernel kernel)
+{
+	Mat result = descriptors.clone();
+	for (int i = 0; i < result.rows; ++i) {
+		dk::rootSiftRow(result.ptr<float>(i), result.cols, kernel);
+	}
+	return result;
+}
+
+/**
+ * @brief Compares the descriptors and prints the result
+ * @param name name of the comparison
+ * @param computed the checked descriptors
+ * @param expected the expected descriptors
+ * @return true if the maximal absolute difference is within dk::ROOTSIFT_TOLERANCE
+*/
+static bool compare(const string& name, const Mat& computed, const Mat& expected)
+{
+	double maxDifference = norm(computed, expected, NORM_INF);
+	bool passed = maxDifference <= dk::ROOTSIFT_TOLERANCE;
+	cout << (passed ? "[OK]     " : "[FAILED] ") << name << ", maximal difference: " << maxDifference
+		<< " (tolerance: " << dk::ROOTSIFT_TOLERANCE << ")" << endl;
+	return passed;
+}
+
+int main()
+{
+	bool passed = true;
+	for (int cols : { 128, 61 }) {
+		cout << "Descriptors with " << cols << " values:" << endl;
+		Mat descriptors = fixedDescriptors(cols);
+		Mat baselineFast = descriptors.clone();
+		baselineFastRootSift(baselineFast);
+		Mat baselinePrecise = descriptors.clone();
+		baselinePreciseRootSift(baselinePrecise);
+
+		Mat scalar = runKernel(descriptors, dk::ERootSiftKernel::SCALAR);
+		passed &= compare("scalar kernel vs the original fast RootSIFT", scalar, baselineFast);
+		passed &= compare("precise kernel vs the original precise RootSIFT", runKernel(descriptors, dk::ERootSiftKernel::PRECISE), baselinePrecise);
+		if (dk::rootSiftKernelSupported(dk::ERootSiftKernel::AVX2)) {
+			Mat avx2 = runKernel(descriptors, dk::ERootSiftKernel::AVX2);
+			passed &= compare("AVX2 kernel vs the original fast RootSIFT", avx2, baselineFast);
+			passed &= compare("AVX2 kernel vs the scalar kernel", avx2, scalar);
+		}
+		else {
+			cout << "[SKIPPED] AVX2 kernel is not supported on this platform or CPU" << endl;
+		}
+
+		//the dispatch used by CImage (rows in parallel)
+		Mat normalized = descriptors.clone();
+		dk::rootSiftNormalize(normalized, false);
+		passed &= compare("rootSiftNormalize vs the original fast RootSIFT", normalized, baselineFast);
+		normalized = descriptors.clone();
+		dk::rootSiftNormalize(normalized, true);
+		passed &= compare("precise rootSiftNormalize vs the original precise RootSIFT", normalized, baselinePrecise);
+	}
+	cout << (passed ? "RootSIFT check passed." : "RootSIFT check FAILED.") << endl;
+	return passed ? 0 : 1;
+}
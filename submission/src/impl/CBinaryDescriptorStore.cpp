@@ -0,0 +1,37 @@
+#include "CBinaryDescriptorStore.h"
+
+CBinaryDescriptorStore::CBinaryDescriptorStore(const Mat& descriptors)
+	:
+	rows_(descriptors.rows),
+	descriptorBytes_(descriptors.cols)
+{
+	if (!descriptors.empty() && descriptors.type() != CV_8U) {
+		throw invalid_argument("Only the binary descriptors (CV_8U) can be packed");
+	}
+	//whole 256 bit blocks, the padding is zero so it does not change the distance
+	int words = (descriptorBytes_ + 7) / 8;
+	strideWords_ = max(4, (words + 3) / 4 * 4);
+
+	size_t size = max((size_t)1, (size_t)rows_ * strideWords_) * sizeof(uint64_t);
+	//fastMalloc alignment depends on the OpenCV build, so the pointer is aligned here explicitly
+	allocation_ = fastMalloc(size + ALIGNMENT);
+	data_ = alignPtr(static_cast<uint64_t*>(allocation_), (int)ALIGNMENT);
+	memset(data_, 0, size);
+
+	for (int i = 0; i < rows_; ++i) {
+		memcpy(data_ + (size_t)i * strideWords_, descriptors.ptr<uchar>(i), descriptorBytes_);
+	}
+}
+
+CBinaryDescriptorStore::~CBinaryDescriptorStore()
+{
+	fastFree(allocation_);
+}
+
+void CBinaryDescriptorStore::findTop2(const CBinaryDescriptorStore& train, dk::STop2Matches& result) const
+{
+	if (rows_ > 0 && train.rows_ > 0 && descriptorBytes_ != train.descriptorBytes_) {
+		throw invalid_argument("Packed binary descriptors of different length can't be matched");
+	}
+	dk::top2Hamming(data_, rows_, train.data_, train.rows_, strideWords_, result);
+}
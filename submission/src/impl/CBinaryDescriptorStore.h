@@ -0,0 +1,80 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CBinaryDescriptorStore.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class that keeps the binary descriptors (ORB, BEBLID) packed in 64 bit words for the fast Hamming matching
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+//Matrices, aligned allocation
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/utility.hpp>
+
+#include "DescriptorKernels.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Class that keeps the binary descriptors (ORB, BEBLID) packed in 64 bit words for the fast Hamming matching
+ * 
+ * The rows are stored in one 64 byte aligned array, every row has the same stride (multiple of 4 words, the padding is zero)
+ * so the rows can be loaded by the aligned SIMD instructions.
+ * 
+ * Usage is following: construct from the descriptors matrix -> findTop2 with other store (train descriptors)
+ * 
+*/
+class CBinaryDescriptorStore
+{
+	static constexpr size_t ALIGNMENT = 64; ///< alignment of the data array in bytes
+
+	void* allocation_ = nullptr; ///< owned memory of the packed descriptors
+	uint64_t* data_ = nullptr; ///< packed descriptors (inside allocation_, aligned to ALIGNMENT)
+	int rows_ = 0; ///< number of the descriptors
+	int descriptorBytes_ = 0; ///< number of the bytes of one descriptor
+	int strideWords_ = 0; ///< number of the words of one row (with the padding)
+public:
+	/**
+	 * @brief Constructor, it packs the descriptors
+	 * @param descriptors binary descriptors (CV_8U, one descriptor per row)
+	 * @throw invalid_argument if the descriptors are not CV_8U
+	*/
+	CBinaryDescriptorStore(const Mat& descriptors);
+	CBinaryDescriptorStore(const CBinaryDescriptorStore&) = delete;
+	CBinaryDescriptorStore& operator=(const CBinaryDescriptorStore&) = delete;
+	/**
+	 * @brief Destructor, it frees the aligned data
+	*/
+	~CBinaryDescriptorStore();
+	/**
+	 * @brief Finds two nearest train descriptors (Hamming distance) for every descriptor of this store (the fastest kernel supported by the CPU is used)
+	 * @param train the store of the train descriptors (descriptors of the same length)
+	 * @param result output nearest neighbours, flat arrays indexed by the descriptors of this store
+	 * @throw invalid_argument if the descriptors have different length
+	*/
+	void findTop2(const CBinaryDescriptorStore& train, dk::STop2Matches& result) const;
+	/**
+	 * @brief Gives the packed row
+	 * @param i index of the descriptor
+	 * @return pointer to the first word of the row
+	*/
+	const uint64_t* row(int i) const { return data_ + (size_t)i * strideWords_; }
+	/**
+	 * @brief Gives number of the descriptors
+	 * @return the number
+	*/
+	int rows() const { return rows_; }
+	/**
+	 * @brief Gives the memory used by the packed descriptors
+	 * @return number of the bytes
+	*/
+	size_t bytes() const { return (size_t)rows_ * strideWords_ * sizeof(uint64_t); }
+};
@@ -0,0 +1,22 @@
+#include "CBufferLogger.h"
+
+CBufferLogger::CBufferLogger(bool timing, unsigned int sectionLevel) : COstreamLogger(timing)
+{
+	currentSectionLevel_ = sectionLevel;
+}
+
+void CBufferLogger::replay(CLogger& logger)
+{
+	logger.log(out_.str());
+	for (auto& it : images_) {
+		logger.putImage(it.first, it.second);
+	}
+
+	clear();
+}
+
+void CBufferLogger::clear()
+{
+	out_.str(std::string());
+	images_.clear();
+}
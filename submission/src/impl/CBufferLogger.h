@@ -0,0 +1,65 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CBufferLogger.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class for logging output into a memory buffer
+ *
+ *  It is designed for the work done on more threads, every task logs into its own buffer and the buffers are then replayed in the right order.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "COstreamLogger.h"
+
+using namespace std;
+
+/**
+ * @brief Class for logging output into a memory buffer
+ * 
+ * It is designed for the work done on more threads, every task logs into its own buffer (the loggers are not thread safe)
+ * and the buffers are then replayed in the deterministic order into the main logger by the method replay.
+ * 
+*/
+class CBufferLogger : public COstreamLogger {
+protected:
+	ostringstream out_; ///< buffer with the logged text
+	/**
+	 * @brief It returns the stream that the logger is using
+	 * @return It returns internal ostream (buffer)
+	*/
+	inline virtual ostream& out() override { return out_; }
+public:
+	/**
+	 * @brief Empty constructor is deleted.
+	*/
+	CBufferLogger() = delete;
+	/**
+	 * @brief Constructor of the class
+	 * @param timing information whether the timing optimalization will take place and the images wont be saved
+	 * @param sectionLevel section level of the logger into which the buffer will be replayed (so the indentation is the same)
+	*/
+	CBufferLogger(bool timing, unsigned int sectionLevel);
+	/**
+	 * @brief default virtual destructor
+	*/
+	virtual ~CBufferLogger() override {}
+	/**
+	 * @brief Logs the buffered text and images into the given logger and clears the buffer
+	 * @param logger logger into which the buffer is replayed
+	*/
+	void replay(CLogger& logger);
+	/**
+	 * @brief Drops the buffered text and images
+	*/
+	void clear();
+	/**
+	 * @brief The buffer is kept until it is replayed, so flush does nothing
+	*/
+	virtual void flush() override {}
+};
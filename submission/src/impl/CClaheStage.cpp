@@ -0,0 +1,97 @@
+#include "CClaheStage.h"
+
+CClaheStage::CClaheStage(const SClaheParams& params)
+	:
+	params_(params)
+{
+	int bands = params_.parallelBands_ > 0 ? params_.parallelBands_ : getNumThreads();
+	//every band has at least one own tile row
+	bands = max(1, min(bands, params_.tilesGrid_));
+	for (int i = 0; i < bands; ++i) {
+		//wikipedia:  Common values limit the resulting amplification to between 3 and 4. 
+		//from a test I got a better result with 3
+		clahes_.push_back(createCLAHE(params_.clipLimit_, Size(params_.tilesGrid_, params_.tilesGrid_)));
+	}
+	bandResults_.resize(bands);
+}
+
+bool CClaheStage::claheNeeded(const Mat& image) const
+{
+	int tileWidth = image.cols / params_.tilesGrid_;
+	int tileHeight = image.rows / params_.tilesGrid_;
+	if (tileWidth == 0 || tileHeight == 0) {
+		return true;
+	}
+
+	int lowContrastTiles = 0;
+	for (int ty = 0; ty < params_.tilesGrid_; ++ty) {
+		for (int tx = 0; tx < params_.tilesGrid_; ++tx) {
+			Scalar mean, stdDev;
+			meanStdDev(image(Rect(tx * tileWidth, ty * tileHeight, tileWidth, tileHeight)), mean, stdDev);
+			if (stdDev[0] < CLAHE_LOW_CONTRAST_TILE_STDDEV) {
+				++lowContrastTiles;
+			}
+		}
+	}
+	double lowContrastRatio = (double)lowContrastTiles / (double)(params_.tilesGrid_ * params_.tilesGrid_);
+	return lowContrastRatio > CLAHE_MAX_LOW_CONTRAST_TILES_RATIO;
+}
+
+void CClaheStage::applyClahe(Mat& image)
+{
+	int bands = (int)clahes_.size();
+	if (bands == 1) {
+		clahes_[0]->apply(image, image);
+		return;
+	}
+
+	//the same padding as the OpenCV CLAHE does so the tiles are the same
+	const int tiles = params_.tilesGrid_;
+	int padBottom = image.rows % tiles == 0 ? 0 : tiles - image.rows % tiles;
+	int padRight = image.cols % tiles == 0 ? 0 : tiles - image.cols % tiles;
+	//the copy is always needed, because the bands are reading overlapping rows while the result is written to the image
+	copyMakeBorder(image, padded_, 0, padBottom, 0, padRight, BORDER_REFLECT_101);
+	const int tileHeight = padded_.rows / tiles;
+
+	parallel_for_(Range(0, bands), [&](const Range& range) {
+		for (int band = range.start; band < range.end; ++band) {
+			//tile rows that belong to the band
+			int firstTile = band * tiles / bands;
+			int endTile = (band + 1) * tiles / bands;
+			//the band is extended by one tile row on both sides (needed for the interpolation)
+			int firstExtTile = max(firstTile - 1, 0);
+			int endExtTile = min(endTile + 1, tiles);
+
+			clahes_[band]->setTilesGridSize(Size(tiles, endExtTile - firstExtTile));
+			clahes_[band]->apply(padded_.rowRange(firstExtTile * tileHeight, endExtTile * tileHeight), bandResults_[band]);
+
+			//copy the own rows (without the extension and padding) to the image
+			int firstRow = firstTile * tileHeight;
+			int endRow = min(endTile * tileHeight, image.rows);
+			if (firstRow >= endRow) {
+				continue;
+			}
+			int bandOffset = (firstTile - firstExtTile) * tileHeight;
+			bandResults_[band](Range(bandOffset, bandOffset + endRow - firstRow), Range(0, image.cols))
+				.copyTo(image.rowRange(firstRow, endRow));
+		}
+	});
+}
+
+void CClaheStage::apply(Mat& image)
+{
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+
+	lastWasGlobal_ = (params_.mode_ == EContrastEnhancement::ADAPTIVE) && !claheNeeded(image);
+	if (lastWasGlobal_) {
+		equalizeHist(image, image);
+	}
+	else {
+		applyClahe(image);
+	}
+
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	lastDurationMs_ = chrono::duration<double, milli>(end - begin).count();
+	totalDurationMs_ += lastDurationMs_;
+	++imagesCount_;
+}
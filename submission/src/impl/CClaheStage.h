@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CClaheStage.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class of the contrast enhancement preprocessing stage (CLAHE - Contrast Limited Adaptive Histogram Equalisation)
+ *
+ *  The stage is reused for all the images, it keeps the CLAHE objects and scratch buffers and it measures its own time.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+//Matrices
+#include <opencv2/core/mat.hpp>
+//parallel_for_
+#include <opencv2/core/utility.hpp>
+//clahe and other image processing
+#include <opencv2/imgproc.hpp>
+
+#include "SProcessParams.h"
+#include "parameters.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Class of the contrast enhancement preprocessing stage (CLAHE - Contrast Limited Adaptive Histogram Equalisation)
+ * 
+ * Usage is following: construct (once) -> call apply for every image -> optionaly read the timing information
+ * 
+ * The image is split into horizontal bands aligned to the CLAHE tiles, every band is extended by one tile row on both sides
+ * (the interpolation of the border pixels needs the neighbouring tiles) and the bands are processed in parallel.
+ * Because the tiles are the same as in the whole image CLAHE the result is the same (up to rare rounding of the interpolation).
+ * 
+ * In the adaptive mode the stage checks the local contrast of the tiles first and if none of the tiles (only small part of them) has low contrast
+ * the CLAHE is not needed and cheaper global histogram equalisation is used.
+ * 
+ * The object is not safe to be used from more threads at once (it has own scratch buffers), every thread should have its own stage.
+ * 
+*/
+class CClaheStage
+{
+	const SClaheParams params_; ///< parameters of the stage
+	vector<Ptr<CLAHE>> clahes_; ///< one CLAHE object for every band (they keep their inner buffers between the images)
+	Mat padded_; ///< scratch buffer - image padded to be divisible by the tiles grid
+	vector<Mat> bandResults_; ///< scratch buffers - CLAHE results of the bands
+	bool lastWasGlobal_ = false; ///< whether the global equalisation was used for the last image instead of CLAHE
+	double lastDurationMs_ = 0.0; ///< duration of processing of the last image in milliseconds
+	double totalDurationMs_ = 0.0; ///< duration of processing of all the images in milliseconds
+	size_t imagesCount_ = 0; ///< number of processed images
+
+	/**
+	 * @brief Checks the local contrast of the tiles to find out whether CLAHE is needed
+	 * @param image grayscale image
+	 * @return true if the CLAHE is needed (there are enough low contrast tiles)
+	*/
+	bool claheNeeded(const Mat& image) const;
+	/**
+	 * @brief CLAHE of the image in parallel bands
+	 * @param image grayscale image, the result is written into it
+	*/
+	void applyClahe(Mat& image);
+public:
+	/**
+	 * @brief Constructor, it creates the CLAHE objects
+	 * @param params parameters of the stage
+	*/
+	CClaheStage(const SClaheParams& params);
+	/**
+	 * @brief Enhances the contrast of the image in place (CLAHE or the global histogram equalisation in the adaptive mode)
+	 * @param image grayscale (CV_8U) image
+	*/
+	void apply(Mat& image);
+	/**
+	 * @brief Gives information whether the global histogram equalisation was used for the last image instead of CLAHE
+	 * @return true if the global equalisation was used
+	*/
+	bool lastWasGlobal() const { return lastWasGlobal_; }
+	/**
+	 * @brief Gives duration of processing of the last image
+	 * @return the duration in milliseconds
+	*/
+	double getLastDurationMs() const { return lastDurationMs_; }
+	/**
+	 * @brief Gives duration of processing of all the images by this stage
+	 * @return the duration in milliseconds
+	*/
+	double getTotalDurationMs() const { return totalDurationMs_; }
+	/**
+	 * @brief Gives number of the images processed by this stage
+	 * @return the number of images
+	*/
+	size_t getImagesCount() const { return imagesCount_; }
+};
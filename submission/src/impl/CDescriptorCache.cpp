@@ -0,0 +1,164 @@
+#include "CDescriptorCache.h"
+
+uint64_t CDescriptorCache::hashBytes(const void* data, size_t size, uint64_t hash)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+uint64_t CDescriptorCache::hashParams(const SProcessParams& params)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+	hash = hashValue(CACHE_FORMAT_VERSION, hash);
+	//methods
+	hash = hashValue(static_cast<int>(params.detectMethod_), hash);
+	hash = hashValue(static_cast<int>(params.describeMethod_), hash);
+	//contrast enhancement (the parallel bands give the same result)
+	hash = hashValue(static_cast<int>(params.claheParams_.mode_), hash);
+	hash = hashValue(params.claheParams_.clipLimit_, hash);
+	hash = hashValue(params.claheParams_.tilesGrid_, hash);
+	//working resolution (only the reference images are cached)
+	hash = hashValue(params.resolutionParams_.maxReferenceResolution_, hash);
+	//grid detection
+	hash = hashValue(params.gridParams_.cols_, hash);
+	hash = hashValue(params.gridParams_.rows_, hash);
+	hash = hashValue(params.gridParams_.cellFeaturesLimit_, hash);
+	//SIFT (nfeatures_ is the features limit)
+	hash = hashValue(params.siftParams_.nfeatures_, hash);
+	hash = hashValue(params.siftParams_.nOctaveLayers_, hash);
+	hash = hashValue(params.siftParams_.contrastThreshold_, hash);
+	hash = hashValue(params.siftParams_.edgeTreshold_, hash);
+	hash = hashValue(params.siftParams_.sigma_, hash);
+	//ORB (nfeatures_ is the features limit)
+	hash = hashValue(params.orbParams_.nfeatures_, hash);
+	hash = hashValue(params.orbParams_.scaleFactor_, hash);
+	hash = hashValue(params.orbParams_.nlevels_, hash);
+	hash = hashValue(params.orbParams_.edgeTreshold_, hash);
+	hash = hashValue(params.orbParams_.firstLevel_, hash);
+	hash = hashValue(params.orbParams_.WTA_K_, hash);
+	hash = hashValue(static_cast<int>(params.orbParams_.scoreType_), hash);
+	hash = hashValue(params.orbParams_.patchSize_, hash);
+	hash = hashValue(params.orbParams_.fastTreshold_, hash);
+#ifdef COMPILE_EXPERIMENTAL_MODULES_ENABLED
+	//BEBLID
+	hash = hashValue(params.beblidParams_.scale_factor_, hash);
+	hash = hashValue(static_cast<int>(params.beblidParams_.n_bits_), hash);
+#endif
+	return hash;
+}
+
+uint64_t CDescriptorCache::hashFileContent(const string& filePath)
+{
+	ifstream in(filePath, ios::binary);
+	if (!in.good()) {
+		throw ios_base::failure("Descriptor cache can't read image with file path: " + filePath);
+	}
+	uint64_t hash = FNV_OFFSET_BASIS;
+	vector<char> buffer(1 << 16);
+	while (in) {
+		in.read(buffer.data(), buffer.size());
+		hash = hashBytes(buffer.data(), static_cast<size_t>(in.gcount()), hash);
+	}
+	return hash;
+}
+
+string CDescriptorCache::hashToStr(uint64_t hash)
+{
+	ostringstream out;
+	out << hex << setw(16) << setfill('0') << hash;
+	return out.str();
+}
+
+string CDescriptorCache::entryFilePath(const string& imageFilePath) const
+{
+	//the whole relative filepath is used so images with the same name in different directories do not collide
+	string name = imageFilePath;
+	for (auto& c : name) {
+		if (!isalnum(static_cast<unsigned char>(c))) {
+			c = '_';
+		}
+	}
+	return directory_ + name + ".yml.gz";
+}
+
+//=================================================================================================
+
+CDescriptorCache::CDescriptorCache(const SDescriptorCacheParams& cacheParams, const SProcessParams& params)
+	:
+	directory_((cacheParams.directory_.back() == '/' || cacheParams.directory_.back() == '\\') ? cacheParams.directory_ : cacheParams.directory_ + "/"),
+	paramsHash_(hashParams(params))
+{
+	try {
+		boost::filesystem::create_directories(directory_);
+	}
+	catch (exception& e) {
+		throw ios_base::failure(string("Descriptor cache directory can't be created! System message: ") + e.what());
+	}
+}
+
+bool CDescriptorCache::load(CImage& image, Ptr<CLogger>& logger) const
+{
+	string entryPath = entryFilePath(image.getFilePath());
+	if (!boost::filesystem::exists(entryPath)) {
+		logger->log("  Descriptor cache miss for image: " + image.getFilePath()).endl();
+		return false;
+	}
+
+	try {
+		FileStorage fs(entryPath, FileStorage::READ);
+		if (!fs.isOpened()) {
+			logger->log("  Descriptor cache entry can't be opened and will be rebuilt: " + entryPath).endl();
+			return false;
+		}
+
+		string storedImageHash, storedParamsHash;
+		fs["image_hash"] >> storedImageHash;
+		fs["params_hash"] >> storedParamsHash;
+		if (storedParamsHash != hashToStr(paramsHash_) || storedImageHash != hashToStr(hashFileContent(image.getFilePath()))) {
+			logger->log("  Descriptor cache entry is stale and will be rebuilt: " + entryPath).endl();
+			return false;
+		}
+
+		vector<KeyPoint> keypoints;
+		Mat descriptors;
+		fs["keypoints"] >> keypoints;
+		fs["descriptors"] >> descriptors;
+		if (keypoints.size() != static_cast<size_t>(descriptors.rows)) {
+			logger->log("  Descriptor cache entry is corrupted and will be rebuilt: " + entryPath).endl();
+			return false;
+		}
+		image.setFeatures(keypoints, descriptors);
+	}
+	catch (cv::Exception& e) {
+		logger->log("  Descriptor cache entry is corrupted and will be rebuilt: " + entryPath + " (" + e.what() + ")").endl();
+		return false;
+	}
+
+	logger->log("  Descriptor cache hit for image: " + image.getFilePath() + ", keypoints count: ").log(to_string(image.getKeypoints().size())).endl();
+	return true;
+}
+
+void CDescriptorCache::store(const CImage& image, Ptr<CLogger>& logger) const
+{
+	string entryPath = entryFilePath(image.getFilePath());
+	try {
+		FileStorage fs(entryPath, FileStorage::WRITE);
+		if (!fs.isOpened()) {
+			logger->log("  Descriptor cache entry can't be written: " + entryPath).endl();
+			return;
+		}
+		fs << "image_hash" << hashToStr(hashFileContent(image.getFilePath()));
+		fs << "params_hash" << hashToStr(paramsHash_);
+		fs << "keypoints" << image.getKeypoints();
+		fs << "descriptors" << image.getDescriptors();
+	}
+	catch (cv::Exception& e) {
+		logger->log("  Descriptor cache entry can't be written: " + entryPath + " (" + e.what() + ")").endl();
+		return;
+	}
+	logger->log("  Descriptor cache entry was stored: " + entryPath).endl();
+}
@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CDescriptorCache.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class that stores keypoints and descriptors of the reference images on the disk
+ *
+ *  Every entry is keyed by the hash of the image file content and by the hash of the parameters that influence the features.
+ *  When any of them changes the entry is considered stale and it is rebuilt.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <boost/filesystem.hpp>
+
+//Matrices
+#include <opencv2/core/mat.hpp>
+//file storage - persistence of the keypoints and descriptors
+#include <opencv2/core/persistence.hpp>
+
+#include "CImage.h"
+#include "CLogger.h"
+#include "SProcessParams.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Class that stores keypoints and descriptors of the reference images on the disk
+ *
+ * Usage is following: construct -> load (before the image is processed) -> store (after the image was processed, only if the load failed)
+ *
+ * The entry is valid only for the same image content and for the same parameters (method, SIFT/ORB/BEBLID parameters, features limit).
+ * A stale or corrupted entry is detected by the load method and the entry is then overwritten by the store method.
+ *
+*/
+class CDescriptorCache
+{
+	static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL; ///< FNV-1a 64 bit offset basis
+	static constexpr uint64_t FNV_PRIME = 1099511628211ULL; ///< FNV-1a 64 bit prime
+	static constexpr int CACHE_FORMAT_VERSION = 1; ///< has to be increased every time the processing of the image changes the features in other way than by parameters
+
+	const string directory_; ///< directory with the cache entries (ends with a slash)
+	const uint64_t paramsHash_; ///< hash of the parameters that influence the keypoints and descriptors
+
+	/**
+	 * @brief FNV-1a hash of given bytes
+	 * @param data bytes to be hashed
+	 * @param size number of the bytes
+	 * @param hash hash to continue with (offset basis for a new hash)
+	 * @return the hash
+	*/
+	static uint64_t hashBytes(const void* data, size_t size, uint64_t hash);
+	/**
+	 * @brief FNV-1a hash of a trivial value (continues with the given hash)
+	 * @tparam T type of the value (it has to be a trivial type without padding)
+	 * @param value value to be hashed
+	 * @param hash hash to continue with
+	 * @return the hash
+	*/
+	template<typename T>
+	static uint64_t hashValue(const T& value, uint64_t hash) { return hashBytes(&value, sizeof(T), hash); }
+	/**
+	 * @brief Computes hash of all the parameters that influence the keypoints and descriptors
+	 * @param params the processing parameters
+	 * @return the hash
+	*/
+	static uint64_t hashParams(const SProcessParams& params);
+	/**
+	 * @brief Computes hash of the file content
+	 * @param filePath filepath of the file (relative to the place where the app is running)
+	 * @return the hash
+	 * @throw ios_base::failure if the file cannot be read
+	*/
+	static uint64_t hashFileContent(const string& filePath);
+	/**
+	 * @brief Converts the hash to its hexadecimal string form (the file storage does not support 64 bit integers)
+	 * @param hash the hash
+	 * @return hexadecimal string
+	*/
+	static string hashToStr(uint64_t hash);
+	/**
+	 * @brief Gives the filepath of the cache entry that belongs to the image
+	 * @param imageFilePath filepath of the image
+	 * @return the filepath of the entry
+	*/
+	string entryFilePath(const string& imageFilePath) const;
+public:
+	/**
+	 * @brief Constructor, it creates the cache directory if it does not exist
+	 * @param cacheParams parameters of the cache (directory)
+	 * @param params processing parameters, the entries are valid only for these parameters
+	 * @throw ios_base::failure if the directory cannot be created
+	*/
+	CDescriptorCache(const SDescriptorCacheParams& cacheParams, const SProcessParams& params);
+	/**
+	 * @brief Loads the keypoints and descriptors of the image from the cache
+	 *
+	 * If the entry is missing, stale or corrupted nothing is set and the image has to be processed.
+	 *
+	 * @param image image to which the keypoints and descriptors are set
+	 * @param logger logger in which it will print information about the process
+	 * @return true if the features were loaded
+	*/
+	bool load(CImage& image, Ptr<CLogger>& logger) const;
+	/**
+	 * @brief Stores the keypoints and descriptors of the processed image to the cache (overwrites the previous entry)
+	 *
+	 * Failure to store the entry is not fatal, it is only logged.
+	 *
+	 * @param image already processed image
+	 * @param logger logger in which it will print information about the process
+	*/
+	void store(const CImage& image, Ptr<CLogger>& logger) const;
+};
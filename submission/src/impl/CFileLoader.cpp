@@ -9,7 +9,12 @@ void CFileLoader::loadCameraInfo()
     float sensorSizeX = 0;
     float sensorSizeY = 0;
     try {
-        string cameraInfoFilePath = sio::getFilePathWithoutSuffix(scenesFilepaths_[sceneIndex_]) + ".json";
+        //in the streaming mode the camera information is next to the stream source (video.json for video.mp4, frames.json for the frames directory)
+        string cameraInfoSource = streamSource_.empty() ? scenesFilepaths_[sceneIndex_] : streamSource_;
+        while (cameraInfoSource.size() > 1 && (cameraInfoSource.back() == '/' || cameraInfoSource.back() == '\\')) {
+            cameraInfoSource.pop_back();
+        }
+        string cameraInfoFilePath = sio::getFilePathWithoutSuffix(cameraInfoSource) + ".json";
         // Create a root
         pt::ptree root;
         // Load the json file in this ptree
@@ -70,12 +75,33 @@ void CFileLoader::loadProcessParameters()
     bool standingPersonOptimalisation = true;
     bool findProjection = true;
     bool findGPS;
+    SDescriptorCacheParams cacheParams;
+    int extractionThreads = 1;
+    int matchingThreads = 1;
+    SClaheParams claheParams;
+    string contrastEnhancement = CLAHE_STR;
+    SResolutionParams resolutionParams;
+    SGridDetectionParams gridParams;
+    SDescriptorStorageParams storageParams;
+    SRetrievalParams retrievalParams;
+    SMatchingParams matchingParams;
+    string matchingDirection = OBJECT_TO_SCENE_STR;
+    SHnswParams hnswParams;
+    SVerificationParams verificationParams;
+    SCascadeParams cascadeParams;
+    SGmsParams gmsParams;
+    STrackingParams trackingParams;
+    SPoseParams poseParams;
+    string poseSolver = ITERATIVE_POSE_STR;
+    SGpsPriorParams gpsPriorParams;
     try {
         // Create a root
         pt::ptree root;
         // Load the json file in this ptree
         // can throw exceptions if the json isn't valid
         pt::read_json(parametersJsonFilePath_, root);
+        //read before the required values, so it is respected also when some of them is missing
+        pauseAtExit_ = root.get<bool>(PAUSE_AT_EXIT_JSON_KEY, pauseAtExit_);
         outputType = root.get<string>(OUTPUT_TYPE_JSON_KEY);
         previewResult_ = root.get<bool>(PREVIEW_RESULT_JSON_KEY);
         timingOptimalisation_ = root.get<bool>(TIMING_OPTIMALISATION_JSON_KEY);
@@ -87,6 +113,57 @@ void CFileLoader::loadProcessParameters()
         standingPersonOptimalisation = root.get<bool>(STANDING_PERSON_OPTIMALISATION_JSON_KEY);
         findProjection = root.get<bool>(FIND_PROJECTION_JSON_KEY);
         findGPS = root.get<bool>(FIND_GPS_JSON_KEY);
+        //optional values
+        cacheParams.enabled_ = root.get<bool>(DESCRIPTOR_CACHE_JSON_KEY, cacheParams.enabled_);
+        cacheParams.directory_ = root.get<string>(DESCRIPTOR_CACHE_DIR_JSON_KEY, cacheParams.directory_);
+        extractionThreads = root.get<int>(EXTRACTION_THREADS_JSON_KEY, extractionThreads);
+        matchingThreads = root.get<int>(MATCHING_THREADS_JSON_KEY, matchingThreads);
+        contrastEnhancement = root.get<string>(CONTRAST_ENHANCEMENT_JSON_KEY, contrastEnhancement);
+        claheParams.clipLimit_ = root.get<double>(CLAHE_CLIP_LIMIT_JSON_KEY, claheParams.clipLimit_);
+        claheParams.tilesGrid_ = root.get<int>(CLAHE_TILES_GRID_JSON_KEY, claheParams.tilesGrid_);
+        claheParams.parallelBands_ = root.get<int>(CLAHE_PARALLEL_BANDS_JSON_KEY, claheParams.parallelBands_);
+        resolutionParams.maxSceneResolution_ = root.get<int>(MAX_SCENE_RESOLUTION_JSON_KEY, resolutionParams.maxSceneResolution_);
+        resolutionParams.maxReferenceResolution_ = root.get<int>(MAX_REFERENCE_RESOLUTION_JSON_KEY, resolutionParams.maxReferenceResolution_);
+        gridParams.cols_ = root.get<int>(DETECTION_GRID_COLS_JSON_KEY, gridParams.cols_);
+        gridParams.rows_ = root.get<int>(DETECTION_GRID_ROWS_JSON_KEY, gridParams.rows_);
+        gridParams.cellFeaturesLimit_ = root.get<int>(CELL_FEATURES_LIMIT_JSON_KEY, gridParams.cellFeaturesLimit_);
+        storageParams.quantizeReferences_ = root.get<bool>(QUANTIZED_REFERENCES_JSON_KEY, storageParams.quantizeReferences_);
+        storageParams.packBinaryDescriptors_ = root.get<bool>(PACKED_BINARY_DESCRIPTORS_JSON_KEY, storageParams.packBinaryDescriptors_);
+        retrievalParams.enabled_ = root.get<bool>(RETRIEVAL_JSON_KEY, retrievalParams.enabled_);
+        retrievalParams.branching_ = root.get<int>(VOCABULARY_BRANCHING_JSON_KEY, retrievalParams.branching_);
+        retrievalParams.depth_ = root.get<int>(VOCABULARY_DEPTH_JSON_KEY, retrievalParams.depth_);
+        retrievalParams.shortlistSize_ = root.get<int>(SHORTLIST_SIZE_JSON_KEY, retrievalParams.shortlistSize_);
+        retrievalParams.globalIndex_ = root.get<bool>(GLOBAL_DESCRIPTOR_INDEX_JSON_KEY, retrievalParams.globalIndex_);
+        matchingDirection = root.get<string>(MATCHING_DIRECTION_JSON_KEY, matchingDirection);
+        matchingParams.crossCheck_ = root.get<bool>(CROSS_CHECK_JSON_KEY, matchingParams.crossCheck_);
+        matchingParams.benchmarkGemm_ = root.get<bool>(GEMM_BENCHMARK_JSON_KEY, matchingParams.benchmarkGemm_);
+        hnswParams.M_ = root.get<int>(HNSW_M_JSON_KEY, hnswParams.M_);
+        hnswParams.efConstruction_ = root.get<int>(HNSW_EF_CONSTRUCTION_JSON_KEY, hnswParams.efConstruction_);
+        hnswParams.efSearch_ = root.get<int>(HNSW_EF_SEARCH_JSON_KEY, hnswParams.efSearch_);
+        hnswParams.indexFile_ = root.get<string>(HNSW_INDEX_FILE_JSON_KEY, hnswParams.indexFile_);
+        hnswParams.measureRecall_ = root.get<bool>(HNSW_MEASURE_RECALL_JSON_KEY, hnswParams.measureRecall_);
+        verificationParams.enabled_ = root.get<bool>(GEOMETRIC_VERIFICATION_JSON_KEY, verificationParams.enabled_);
+        verificationParams.topK_ = root.get<int>(VERIFICATION_TOP_K_JSON_KEY, verificationParams.topK_);
+        verificationParams.maxIterations_ = root.get<int>(VERIFICATION_MAX_ITERATIONS_JSON_KEY, verificationParams.maxIterations_);
+        verificationParams.minInliers_ = root.get<int>(VERIFICATION_MIN_INLIERS_JSON_KEY, verificationParams.minInliers_);
+        verificationParams.minConfidence_ = root.get<double>(VERIFICATION_MIN_CONFIDENCE_JSON_KEY, verificationParams.minConfidence_);
+        cascadeParams.enabled_ = root.get<bool>(CASCADE_REJECTION_JSON_KEY, cascadeParams.enabled_);
+        cascadeParams.subsetRatio_ = root.get<double>(CASCADE_SUBSET_RATIO_JSON_KEY, cascadeParams.subsetRatio_);
+        cascadeParams.tolerance_ = root.get<double>(CASCADE_TOLERANCE_JSON_KEY, cascadeParams.tolerance_);
+        gmsParams.enabled_ = root.get<bool>(GMS_FILTER_JSON_KEY, gmsParams.enabled_);
+        gmsParams.gridSize_ = root.get<int>(GMS_GRID_SIZE_JSON_KEY, gmsParams.gridSize_);
+        gmsParams.thresholdFactor_ = root.get<double>(GMS_THRESHOLD_FACTOR_JSON_KEY, gmsParams.thresholdFactor_);
+        trackingParams.enabled_ = root.get<bool>(TRACKING_JSON_KEY, trackingParams.enabled_);
+        trackingParams.minInliers_ = root.get<int>(TRACKING_MIN_INLIERS_JSON_KEY, trackingParams.minInliers_);
+        trackingParams.maxReprojectionError_ = root.get<double>(TRACKING_MAX_REPROJECTION_ERROR_JSON_KEY, trackingParams.maxReprojectionError_);
+        trackingParams.windowSize_ = root.get<int>(TRACKING_WINDOW_SIZE_JSON_KEY, trackingParams.windowSize_);
+        trackingParams.pyramidLevels_ = root.get<int>(TRACKING_PYRAMID_LEVELS_JSON_KEY, trackingParams.pyramidLevels_);
+        poseSolver = root.get<string>(POSE_SOLVER_JSON_KEY, poseSolver);
+        poseParams.refine_ = root.get<bool>(POSE_REFINEMENT_JSON_KEY, poseParams.refine_);
+        gpsPriorParams.enabled_ = root.get<bool>(GPS_PRIOR_JSON_KEY, gpsPriorParams.enabled_);
+        gpsPriorParams.longitude_ = root.get<double>(GPS_PRIOR_LONGITUDE_JSON_KEY, gpsPriorParams.longitude_);
+        gpsPriorParams.latitude_ = root.get<double>(GPS_PRIOR_LATITUDE_JSON_KEY, gpsPriorParams.latitude_);
+        gpsPriorParams.radius_ = root.get<double>(GPS_PRIOR_RADIUS_JSON_KEY, gpsPriorParams.radius_);
     }
     catch (exception& exc) {
         throw ios_base::failure(jsonErrorIntroduction_ + exc.what());
@@ -110,6 +187,36 @@ void CFileLoader::loadProcessParameters()
     else {
         throw ios_base::failure(jsonErrorIntroduction_ + OUTPUT_TYPE_JSON_KEY + " can have value only \"FILE\" or \"CONSOLE\"");
     }
+    if (contrastEnhancement == CLAHE_STR) {
+        claheParams.mode_ = EContrastEnhancement::CLAHE;
+    }
+    else if (contrastEnhancement == ADAPTIVE_CLAHE_STR) {
+        claheParams.mode_ = EContrastEnhancement::ADAPTIVE;
+    }
+    else {
+        throw ios_base::failure(jsonErrorIntroduction_ + CONTRAST_ENHANCEMENT_JSON_KEY + " can have value only \"" + CLAHE_STR + "\" or \"" + ADAPTIVE_CLAHE_STR + "\"");
+    }
+    if (poseSolver == IPPE_POSE_STR) {
+        poseParams.solver_ = EPoseSolver::IPPE;
+    }
+    else if (poseSolver == ITERATIVE_POSE_STR) {
+        poseParams.solver_ = EPoseSolver::ITERATIVE;
+    }
+    else {
+        throw ios_base::failure(jsonErrorIntroduction_ + POSE_SOLVER_JSON_KEY + " can have value only \"" + IPPE_POSE_STR + "\" or \"" + ITERATIVE_POSE_STR + "\"");
+    }
+    if (matchingDirection == OBJECT_TO_SCENE_STR) {
+        matchingParams.direction_ = EMatchingDirection::OBJECT_TO_SCENE;
+    }
+    else if (matchingDirection == SCENE_TO_OBJECT_STR) {
+        matchingParams.direction_ = EMatchingDirection::SCENE_TO_OBJECT;
+    }
+    else if (matchingDirection == AUTO_DIRECTION_STR) {
+        matchingParams.direction_ = EMatchingDirection::AUTO;
+    }
+    else {
+        throw ios_base::failure(jsonErrorIntroduction_ + MATCHING_DIRECTION_JSON_KEY + " can have value only \"" + OBJECT_TO_SCENE_STR + "\", \"" + SCENE_TO_OBJECT_STR + "\" or \"" + AUTO_DIRECTION_STR + "\"");
+    }
 
     //check values
     if (!sio::numberInPositiveRange<int>(featuresLimit)) {
@@ -118,6 +225,117 @@ void CFileLoader::loadProcessParameters()
     if (!sio::numberInRange<double>(ratioTestAlpha, 0.5, 1.0)) {
         throw ios_base::failure(jsonErrorIntroduction_ + "Lowe's ratio test alpha has to be in range <0.5, 1.0>!");
     }
+    if (cacheParams.enabled_ && cacheParams.directory_.empty()) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Descriptor cache directory cannot be empty!");
+    }
+    if (!sio::numberInPositiveRange<int>(extractionThreads)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Number of extraction threads has to be positive value (or 0 for all hardware threads)!");
+    }
+    if (!sio::numberInPositiveRange<int>(matchingThreads)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Number of matching threads has to be positive value (or 0 for all hardware threads)!");
+    }
+    if (claheParams.clipLimit_ <= 0) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "CLAHE clip limit has to be positive value!");
+    }
+    if (!sio::numberInRange<int>(claheParams.tilesGrid_, 1, 64)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "CLAHE tiles grid has to be in range <1, 64>!");
+    }
+    if (!sio::numberInPositiveRange<int>(claheParams.parallelBands_)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Number of CLAHE parallel bands has to be positive value (or 0 for the number of threads)!");
+    }
+    if (!sio::numberInPositiveRange<int>(resolutionParams.maxSceneResolution_) || !sio::numberInPositiveRange<int>(resolutionParams.maxReferenceResolution_)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Maximal working resolution has to be positive value (or 0 for the full resolution)!");
+    }
+    if (!sio::numberInRange<int>(gridParams.cols_, 0, 64) || !sio::numberInRange<int>(gridParams.rows_, 0, 64)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Detection grid columns and rows have to be in range <0, 64>!");
+    }
+    if ((gridParams.cols_ == 0) != (gridParams.rows_ == 0)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Detection grid columns and rows have to be both 0 (grid disabled) or both positive!");
+    }
+    if (!sio::numberInPositiveRange<int>(gridParams.cellFeaturesLimit_)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Features limit of the cell has to be positive value (or 0 for the features limit divided by the number of cells)!");
+    }
+    if (storageParams.quantizeReferences_ && desMethodAlg != EAlgorithm::ALG_SIFT && desMethodAlg != EAlgorithm::ALG_ROOTSIFT && desMethodAlg != EAlgorithm::ALG_PRECISE_ROOTSIFT) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Quantized references can be used only with the float descriptors (SIFT, RootSIFT)!");
+    }
+    if (storageParams.packBinaryDescriptors_ && (desMethodAlg == EAlgorithm::ALG_SIFT || desMethodAlg == EAlgorithm::ALG_ROOTSIFT || desMethodAlg == EAlgorithm::ALG_PRECISE_ROOTSIFT)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Packed descriptors can be used only with the binary descriptors (ORB, BEBLID)!");
+    }
+    if (!sio::numberInRange<int>(retrievalParams.branching_, 2, 100)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Vocabulary branching factor has to be in range <2, 100>!");
+    }
+    if (!sio::numberInRange<int>(retrievalParams.depth_, 1, 8)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Vocabulary depth has to be in range <1, 8>!");
+    }
+    if (!sio::numberInRange<int>(retrievalParams.shortlistSize_, 1, 100000)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Shortlist size has to be in range <1, 100000>!");
+    }
+    if (retrievalParams.enabled_ && retrievalParams.globalIndex_) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Vocabulary retrieval and global descriptor index can't be used together!");
+    }
+    if (matchingMethodAlg == EAlgorithm::ALG_HNSW_MATCHING && desMethodAlg != EAlgorithm::ALG_SIFT && desMethodAlg != EAlgorithm::ALG_ROOTSIFT && desMethodAlg != EAlgorithm::ALG_PRECISE_ROOTSIFT) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "HNSW matching can be used only with the float descriptors (SIFT, RootSIFT)!");
+    }
+    if (matchingMethodAlg == EAlgorithm::ALG_GEMM_MATCHING && desMethodAlg != EAlgorithm::ALG_SIFT && desMethodAlg != EAlgorithm::ALG_ROOTSIFT && desMethodAlg != EAlgorithm::ALG_PRECISE_ROOTSIFT) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "GEMM matching can be used only with the float descriptors (SIFT, RootSIFT)!");
+    }
+    if (!sio::numberInRange<int>(hnswParams.M_, 2, 128)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "HNSW M has to be in range <2, 128>!");
+    }
+    if (!sio::numberInRange<int>(hnswParams.efConstruction_, 1, 10000) || !sio::numberInRange<int>(hnswParams.efSearch_, 1, 10000)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "HNSW efConstruction and efSearch have to be in range <1, 10000>!");
+    }
+    if (!sio::numberInRange<int>(verificationParams.topK_, 1, 100)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Number of the verified candidates has to be in range <1, 100>!");
+    }
+    if (!sio::numberInRange<int>(verificationParams.maxIterations_, 10, 100000)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Iterations budget of the verification has to be in range <10, 100000>!");
+    }
+    if (!sio::numberInRange<int>(verificationParams.minInliers_, 4, 100000)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Minimal number of the verified inliers has to be in range <4, 100000>!");
+    }
+    if (!sio::numberInRange<double>(verificationParams.minConfidence_, 0.0, 1.0)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Minimal confidence of the verification has to be in range <0, 1>!");
+    }
+    if (cascadeParams.subsetRatio_ <= 0 || cascadeParams.subsetRatio_ >= 1) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Cascade subset ratio has to be in range (0, 1)!");
+    }
+    if (!sio::numberInRange<double>(cascadeParams.tolerance_, 0.0, 1.0)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Cascade tolerance has to be in range <0, 1>!");
+    }
+    if (cascadeParams.enabled_ && matchingThreads != 1) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Cascade rejection needs the sequential matching (the rejections depend on the order of the matching), set the matching threads to 1!");
+    }
+    if (cascadeParams.enabled_ && retrievalParams.globalIndex_) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Cascade rejection can't be used with the global descriptor index (the scene is matched in one pass)!");
+    }
+    if (!sio::numberInRange<int>(gmsParams.gridSize_, 2, 50)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "GMS grid size has to be in range <2, 50>!");
+    }
+    if (gmsParams.thresholdFactor_ <= 0) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "GMS threshold factor has to be positive value!");
+    }
+    if (trackingParams.enabled_ && !findProjection && !findGPS) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Tracking starts from the found pose, enable the projection from 3D or the GPS calculation!");
+    }
+    if (!sio::numberInRange<int>(trackingParams.minInliers_, 4, 100000)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Minimal number of the tracked inliers has to be in range <4, 100000>!");
+    }
+    if (trackingParams.maxReprojectionError_ <= 0) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Maximal reprojection error of the tracking has to be positive value!");
+    }
+    if (!sio::numberInRange<int>(trackingParams.windowSize_, 5, 101) || trackingParams.windowSize_ % 2 == 0) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Tracking window size has to be odd number in range <5, 101>!");
+    }
+    if (!sio::numberInRange<int>(trackingParams.pyramidLevels_, 0, 8)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Tracking pyramid levels have to be in range <0, 8>!");
+    }
+    if (!sio::numberInRange<double>(gpsPriorParams.longitude_, -180.0, 180.0) || !sio::numberInRange<double>(gpsPriorParams.latitude_, -89.0, 89.0)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "GPS prior longitude has to be in range <-180, 180> and latitude in range <-89, 89>!");
+    }
+    if (gpsPriorParams.radius_ <= 0) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "GPS prior radius has to be positive value!");
+    }
 
 //=========fill values============
     processParams_.detectMethod_ = detMethodAlg;
@@ -127,6 +345,22 @@ void CFileLoader::loadProcessParameters()
     processParams_.considerPhoneHoldHeight_ = standingPersonOptimalisation;
     processParams_.calcProjectionFrom3D_ = findProjection;
     processParams_.calcGCSLocation_ = findGPS;
+    processParams_.cacheParams_ = cacheParams;
+    processParams_.threadingParams_.extractionThreads_ = (unsigned int)extractionThreads;
+    processParams_.threadingParams_.matchingThreads_ = (unsigned int)matchingThreads;
+    processParams_.claheParams_ = claheParams;
+    processParams_.resolutionParams_ = resolutionParams;
+    processParams_.gridParams_ = gridParams;
+    processParams_.storageParams_ = storageParams;
+    processParams_.retrievalParams_ = retrievalParams;
+    processParams_.matchingParams_ = matchingParams;
+    processParams_.hnswParams_ = hnswParams;
+    processParams_.verificationParams_ = verificationParams;
+    processParams_.cascadeParams_ = cascadeParams;
+    processParams_.gmsParams_ = gmsParams;
+    processParams_.trackingParams_ = trackingParams;
+    processParams_.poseParams_ = poseParams;
+    processParams_.gpsPriorParams_ = gpsPriorParams;
 //SIFT
     SSIFTParams siftParams;
     siftParams.nfeatures_ = featuresLimit;
@@ -164,12 +398,27 @@ void CFileLoader::loadScenes()
         for (auto& item : root.get_child(SCENES_ARRAY_JSON_KEY)) {
             scenesFilepaths_.push_back(item.second.get_value<string>());
         }
+        //optional values
+        streamSource_ = root.get<string>(STREAM_SOURCE_JSON_KEY, streamSource_);
+        streamDropStaleFrames_ = root.get<bool>(STREAM_DROP_STALE_FRAMES_JSON_KEY, streamDropStaleFrames_);
+        streamMaxFrames_ = root.get<long long>(STREAM_MAX_FRAMES_JSON_KEY, streamMaxFrames_);
+        //the unattended stream run does not wait at the exit by default
+        pauseAtExit_ = streamSource_.empty();
     }
     catch (exception& exc) {
         throw ios_base::failure(jsonErrorIntroduction_ + exc.what());
     }
     
     //check values
+    if (!sio::numberInPositiveRange<long long>(streamMaxFrames_)) {
+        throw ios_base::failure(jsonErrorIntroduction_ + "Maximal number of the stream frames has to be positive value (or 0 for no limit)!");
+    }
+    //the scene index is not used in the streaming mode
+    if (!streamSource_.empty()) {
+        sceneIndex_ = 0;
+        scenesJsonLoaded = true;
+        return;
+    }
     if (!sio::numberInRange<int>(sceneIndex, (int)0, (int) scenesFilepaths_.size())) {
         throw ios_base::failure(jsonErrorIntroduction_ +
             "Scene index has to be a valid index (0 <= index < number of scenes in array )" + SCENES_ARRAY_JSON_KEY);
@@ -240,6 +489,47 @@ const vector<string>& CFileLoader::getReferencesFilepaths() const
     throw logic_error("The configurations have not been loaded yet.");
 }
 
+bool CFileLoader::streamMode() const
+{
+    if (loaded_) {
+        return !streamSource_.empty();
+    }
+
+    throw logic_error("The configurations have not been loaded yet.");
+}
+
+const string& CFileLoader::getStreamSource() const
+{
+    if (loaded_) {
+        return streamSource_;
+    }
+
+    throw logic_error("The configurations have not been loaded yet.");
+}
+
+bool CFileLoader::pauseAtExit() const
+{
+    return pauseAtExit_;
+}
+
+bool CFileLoader::streamDropStaleFrames() const
+{
+    if (loaded_) {
+        return streamDropStaleFrames_;
+    }
+
+    throw logic_error("The configurations have not been loaded yet.");
+}
+
+long long CFileLoader::streamMaxFrames() const
+{
+    if (loaded_) {
+        return streamMaxFrames_;
+    }
+
+    throw logic_error("The configurations have not been loaded yet.");
+}
+
 const string& CFileLoader::getSceneFilepath() const
 {
     if (loaded_) {
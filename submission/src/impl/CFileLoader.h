@@ -44,6 +44,9 @@ class CFileLoader
     //scenes
     size_t sceneIndex_; ///< index of the used scene image (index in the scenesFilepaths_) 
     vector<string> scenesFilepaths_; ///< array which contains all prepared scene images (their filepaths, relative to the directory where the app is running)
+    string streamSource_; ///< video file, image sequence (pattern or directory) or camera index processed in the streaming mode (empty if the single scene is processed)
+    bool streamDropStaleFrames_ = true; ///< whether the old frames are dropped when the processing falls behind the stream
+    long long streamMaxFrames_ = 0; ///< maximal number of the processed frames (0 means no limit)
     //references
     vector<string> references_; ///< array, which contains all prepared reference images (their filepaths, relative to the directory where the app is running)
     //params
@@ -52,6 +55,7 @@ class CFileLoader
     EOutputType outputType_; ///< output type (where would be the results shown)
     bool timingOptimalisation_; ///< determines if timing optimalisations (such that lower the possibility of time changes across multiple tests, it also lowers the output richness)
     bool previewResult_; ///< determines whether images will be created
+    bool pauseAtExit_ = true; ///< determines whether the application waits for the user at the exit (false by default in the streaming mode)
 
 
     //inner values
@@ -171,6 +175,38 @@ public:
      * @throw logic_error when is the function called earliar than load()
     */
     const string& outputRoot() const;
+    /**
+     * @brief Returns the information whether the frames of the stream are processed instead of the single scene
+     * @return true in the streaming mode
+     * @throw logic_error when is the function called earliar than load()
+    */
+    bool streamMode() const;
+    /**
+     * @brief Returns the stream source (video file, image sequence pattern or directory, camera index)
+     * @return the source
+     * @throw logic_error when is the function called earliar than load()
+    */
+    const string& getStreamSource() const;
+    /**
+     * @brief Returns whether the old frames are dropped when the processing falls behind the stream
+     * @return the boolean value
+     * @throw logic_error when is the function called earliar than load()
+    */
+    bool streamDropStaleFrames() const;
+    /**
+     * @brief Returns whether the application waits for the user before it exits
+     * 
+     * It can be called also when the loading failed, the value loaded so far (or the default) is returned.
+     * 
+     * @return the boolean value
+    */
+    bool pauseAtExit() const;
+    /**
+     * @brief Returns the maximal number of the processed frames
+     * @return the number (0 means no limit)
+     * @throw logic_error when is the function called earliar than load()
+    */
+    long long streamMaxFrames() const;
 
     /**
      * @brief Method allowing to set the inner SIFT paramaters, that are than part of the SProcessParams returned by getProcessParams()
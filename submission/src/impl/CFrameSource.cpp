@@ -0,0 +1,111 @@
+#include "CFrameSource.h"
+
+void CFrameSource::open(const string& source)
+{
+	//camera index
+	if (!source.empty() && all_of(source.begin(), source.end(), [](char c) { return isdigit(static_cast<unsigned char>(c)) != 0; })) {
+		liveSource_ = true;
+		capture_.open(stoi(source));
+	}
+	//directory - OpenCV finds the sequence pattern from the name of the first image (e.g. img_0001.jpg -> img_%04d.jpg)
+	else if (boost::filesystem::is_directory(source)) {
+		vector<string> images;
+		for (auto& entry : boost::filesystem::directory_iterator(source)) {
+			string extension = entry.path().extension().string();
+			transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)tolower(c); });
+			if (boost::filesystem::is_regular_file(entry.path()) &&
+				(extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".bmp" || extension == ".tif" || extension == ".tiff")) {
+				images.push_back(entry.path().string());
+			}
+		}
+		if (images.empty()) {
+			throw ios_base::failure("Stream source directory does not contain any images: " + source);
+		}
+		sort(images.begin(), images.end());
+		capture_.open(images.front(), CAP_IMAGES);
+	}
+	//video file or image sequence pattern
+	else {
+		capture_.open(source);
+	}
+
+	if (!capture_.isOpened()) {
+		throw ios_base::failure("Can't open stream source: " + source);
+	}
+	double fps = capture_.get(CAP_PROP_FPS);
+	if (fps > 0.0) {
+		fps_ = fps;
+	}
+}
+
+void CFrameSource::grabLoop()
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	long long index = 0;
+	while (!stop_) {
+		//files are read in the pace of the source, the camera gives the frames in its own pace
+		if (!liveSource_) {
+			this_thread::sleep_until(start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(index / fps_)));
+		}
+		Mat frame;
+		if (!capture_.read(frame) || frame.empty()) {
+			break;
+		}
+		{
+			lock_guard<mutex> lock(mutex_);
+			latestFrame_ = frame;
+			latestFrameIndex_ = index;
+		}
+		frameReady_.notify_one();
+		++index;
+	}
+	{
+		lock_guard<mutex> lock(mutex_);
+		finished_ = true;
+	}
+	frameReady_.notify_one();
+}
+
+CFrameSource::CFrameSource(const string& source, bool dropStaleFrames)
+	:
+	dropStaleFrames_(dropStaleFrames),
+	stop_(false)
+{
+	open(source);
+	if (dropStaleFrames_) {
+		grabber_ = thread(&CFrameSource::grabLoop, this);
+	}
+}
+
+CFrameSource::~CFrameSource()
+{
+	stop_ = true;
+	if (grabber_.joinable()) {
+		grabber_.join();
+	}
+}
+
+bool CFrameSource::next(Mat& frame, long long& frameIndex, long long& droppedFrames)
+{
+	if (!dropStaleFrames_) {
+		if (!capture_.read(frame) || frame.empty()) {
+			return false;
+		}
+		frameIndex = readFramesCount_++;
+		droppedFrames = 0;
+		return true;
+	}
+
+	unique_lock<mutex> lock(mutex_);
+	frameReady_.wait(lock, [this]() { return latestFrameIndex_ >= 0 || finished_; });
+	if (latestFrameIndex_ < 0) {
+		return false;
+	}
+	frame = latestFrame_;
+	frameIndex = latestFrameIndex_;
+	droppedFrames = frameIndex - lastTakenIndex_ - 1;
+	lastTakenIndex_ = frameIndex;
+	latestFrame_ = Mat();
+	latestFrameIndex_ = -1;
+	return true;
+}
@@ -0,0 +1,102 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CFrameSource.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class that provides frames of a video or of an image sequence for the streaming localization
+ *
+ *  The frames are read by OpenCV VideoCapture (video file, image sequence pattern, directory with an image sequence or camera index).
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/filesystem.hpp>
+
+//Matrices
+#include <opencv2/core/mat.hpp>
+//video capture
+#include <opencv2/videoio.hpp>
+
+#include "parameters.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Class that provides frames of a video or of an image sequence for the streaming localization
+ * 
+ * Usage is following: construct -> call next until it returns false
+ * 
+ * If the stale frames are dropped, the frames are grabbed by a background thread in the pace of the source (frame rate of the video,
+ * STREAM_SEQUENCE_FPS for the image sequence, camera pace for the camera) and next always gives the newest frame.
+ * The frames that were replaced by a newer frame before they were taken are dropped (the processing fell behind).
+ * Otherwise next gives all the frames one by one.
+ * 
+*/
+class CFrameSource
+{
+	VideoCapture capture_; ///< the OpenCV frames reader
+	const bool dropStaleFrames_; ///< whether the frames are grabbed in the source pace and the old frames are dropped
+	bool liveSource_ = false; ///< whether the source is a camera (it is not paced by the grabbing thread)
+	double fps_ = STREAM_SEQUENCE_FPS; ///< frame rate of the source
+	long long readFramesCount_ = 0; ///< number of the frames read from the capture
+
+	//shared with the grabbing thread (only if the stale frames are dropped)
+	thread grabber_; ///< thread grabbing the frames
+	mutex mutex_; ///< mutex protecting the latest frame
+	condition_variable frameReady_; ///< notifies about a new frame or the end of the source
+	Mat latestFrame_; ///< the newest grabbed frame that was not taken yet
+	long long latestFrameIndex_ = -1; ///< index of the latestFrame_ (-1 if there is no frame waiting)
+	long long lastTakenIndex_ = -1; ///< index of the last frame taken by next
+	bool finished_ = false; ///< whether the source has no more frames
+	atomic<bool> stop_; ///< request to stop the grabbing thread
+
+	/**
+	 * @brief Opens the capture
+	 * @param source video file, image sequence pattern (e.g. frames/img_%04d.jpg), directory with the image sequence or camera index
+	 * @throw ios_base::failure if the source can't be opened
+	*/
+	void open(const string& source);
+	/**
+	 * @brief Body of the grabbing thread
+	*/
+	void grabLoop();
+public:
+	/**
+	 * @brief Constructor, it opens the source (and starts the grabbing thread if the stale frames are dropped)
+	 * @param source video file, image sequence pattern (e.g. frames/img_%04d.jpg), directory with the image sequence or camera index
+	 * @param dropStaleFrames whether the old frames are dropped when the processing falls behind the source
+	 * @throw ios_base::failure if the source can't be opened
+	*/
+	CFrameSource(const string& source, bool dropStaleFrames);
+	CFrameSource(const CFrameSource&) = delete;
+	CFrameSource& operator=(const CFrameSource&) = delete;
+	/**
+	 * @brief Destructor, it stops the grabbing thread
+	*/
+	~CFrameSource();
+	/**
+	 * @brief Gives the next frame (it blocks until the frame is available)
+	 * @param frame output frame
+	 * @param frameIndex output index of the frame in the source
+	 * @param droppedFrames output number of the frames dropped since the previous call
+	 * @return false if there are no more frames
+	*/
+	bool next(Mat& frame, long long& frameIndex, long long& droppedFrames);
+	/**
+	 * @brief Gives the frame rate of the source
+	 * @return frames per second
+	*/
+	double getFps() const { return fps_; }
+};
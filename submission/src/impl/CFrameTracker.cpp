@@ -0,0 +1,88 @@
+#include "CFrameTracker.h"
+
+void CFrameTracker::keepPoints(const vector<uchar>& mask, vector<Point2f>& framePoints)
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < mask.size(); ++i) {
+		if (mask[i]) {
+			objectPoints_[kept] = objectPoints_[i];
+			framePoints[kept] = framePoints[i];
+			++kept;
+		}
+	}
+	objectPoints_.resize(kept);
+	framePoints.resize(kept);
+}
+
+//=================================================================================================
+
+CFrameTracker::CFrameTracker(const STrackingParams& params)
+	:
+	params_(params),
+	windowSize_(params.windowSize_, params.windowSize_)
+{
+}
+
+bool CFrameTracker::start(const Mat& frame, const vector<Point2f>& objectPoints, const vector<Point2f>& scenePoints, const Mat& homography)
+{
+	tracking_ = false;
+	if (objectPoints.size() != scenePoints.size() || objectPoints.size() < (size_t)params_.minInliers_ || homography.empty()) {
+		return false;
+	}
+	buildOpticalFlowPyramid(frame, previousPyramid_, windowSize_, params_.pyramidLevels_);
+	objectPoints_ = objectPoints;
+	scenePoints_ = scenePoints;
+	homography_ = homography.clone();
+	reprojectionError_ = 0.0;
+	tracking_ = true;
+	return true;
+}
+
+bool CFrameTracker::track(const Mat& frame)
+{
+	if (!tracking_) {
+		return false;
+	}
+	tracking_ = false;
+
+	buildOpticalFlowPyramid(frame, currentPyramid_, windowSize_, params_.pyramidLevels_);
+	calcOpticalFlowPyrLK(previousPyramid_, currentPyramid_, scenePoints_, trackedPoints_, status_, errors_, windowSize_, params_.pyramidLevels_);
+	keepPoints(status_, trackedPoints_);
+	if (trackedPoints_.size() < (size_t)params_.minInliers_) {
+		return false;
+	}
+
+	//the drifted points are rejected as outliers, the threshold is looser than the mean error limit so the limit still detects the growing drift
+	Mat homography = findHomography(objectPoints_, trackedPoints_, RANSAC, 2.0 * params_.maxReprojectionError_, inliersMask_);
+	if (homography.empty()) {
+		return false;
+	}
+	keepPoints(inliersMask_, trackedPoints_);
+	if (trackedPoints_.size() < (size_t)params_.minInliers_) {
+		return false;
+	}
+
+	vector<Point2f>& projected = scenePoints_; //the previous positions are not needed anymore
+	perspectiveTransform(objectPoints_, projected, homography);
+	double errorSum = 0.0;
+	for (size_t i = 0; i < projected.size(); ++i) {
+		errorSum += norm(projected[i] - trackedPoints_[i]);
+	}
+	reprojectionError_ = errorSum / (double)projected.size();
+	if (reprojectionError_ > params_.maxReprojectionError_) {
+		return false;
+	}
+
+	homography_ = homography;
+	swap(scenePoints_, trackedPoints_);
+	swap(previousPyramid_, currentPyramid_);
+	tracking_ = true;
+	return true;
+}
+
+void CFrameTracker::stop()
+{
+	tracking_ = false;
+	objectPoints_.clear();
+	scenePoints_.clear();
+}
@@ -0,0 +1,109 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CFrameTracker.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class that tracks the inlier correspondences of the localized reference between the consecutive frames
+ *
+ *  The tracking (pyramidal Lucas-Kanade optical flow) replaces the detection, description and matching of the frame
+ *  as long as enough inliers are tracked with small reprojection error.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+
+//Matrices
+#include <opencv2/core/mat.hpp>
+//optical flow
+#include <opencv2/video/tracking.hpp>
+//homography
+#include <opencv2/calib3d.hpp>
+
+#include "SProcessParams.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Class that tracks the inlier correspondences of the localized reference between the consecutive frames
+ * 
+ * Usage is following: construct -> start (frame with the successful localization and its inliers) -> track every next frame
+ * -> when track returns false the frame has to be relocalized and the tracking started again
+ * 
+ * The reference points stay the same, only their positions in the frame are moved by the optical flow. The homography of every
+ * tracked frame is computed from the tracked points (RANSAC) and the points that are not inliers are dropped. The tracking is lost
+ * when fewer than the minimal number of inliers are left or when their mean reprojection error exceeds the limit.
+ * The image pyramid of the previous frame is kept, so every frame is pyramided only once.
+ * 
+*/
+class CFrameTracker
+{
+	const STrackingParams params_; ///< parameters of the tracking
+	const Size windowSize_; ///< search window of the optical flow
+	vector<Mat> previousPyramid_; ///< pyramid of the previous frame
+	vector<Mat> currentPyramid_; ///< pyramid of the current frame (swapped with the previous after the successful tracking)
+	vector<Point2f> objectPoints_; ///< tracked points in the reference image
+	vector<Point2f> scenePoints_; ///< positions of the tracked points in the previous frame
+	vector<Point2f> trackedPoints_; ///< scratch buffer - positions of the points in the current frame
+	vector<uchar> status_; ///< scratch buffer - status of the optical flow
+	vector<float> errors_; ///< scratch buffer - errors of the optical flow
+	vector<uchar> inliersMask_; ///< scratch buffer - inliers of the homography
+	Mat homography_; ///< homography from the reference image to the last tracked frame
+	double reprojectionError_ = 0.0; ///< mean reprojection error of the inliers in the last tracked frame (pixels)
+	bool tracking_ = false; ///< whether the points are tracked
+
+	/**
+	 * @brief Keeps only the points with the nonzero mask value (in both the reference points and the frame points)
+	 * @param mask the mask (one value per point)
+	 * @param framePoints positions of the points in the frame that are kept together with the reference points
+	*/
+	void keepPoints(const vector<uchar>& mask, vector<Point2f>& framePoints);
+public:
+	/**
+	 * @brief Constructor
+	 * @param params parameters of the tracking
+	*/
+	CFrameTracker(const STrackingParams& params);
+	/**
+	 * @brief Starts the tracking from the localized frame
+	 * @param frame gray frame in the working resolution (without the contrast enhancement)
+	 * @param objectPoints inlier points in the reference image
+	 * @param scenePoints corresponding inlier points in the frame
+	 * @param homography homography from the reference image to the frame
+	 * @return true if there are enough points to track
+	*/
+	bool start(const Mat& frame, const vector<Point2f>& objectPoints, const vector<Point2f>& scenePoints, const Mat& homography);
+	/**
+	 * @brief Tracks the points into the next frame and updates the homography
+	 * @param frame gray frame in the working resolution (the same resolution as the frame used in start)
+	 * @return true if the tracking succeeded, false if the tracking was lost (the frame has to be relocalized)
+	*/
+	bool track(const Mat& frame);
+	/**
+	 * @brief Stops the tracking
+	*/
+	void stop();
+	/**
+	 * @brief Gives information whether the points are tracked
+	 * @return true if the next frame can be tracked
+	*/
+	bool isTracking() const { return tracking_; }
+	/**
+	 * @brief Gives the homography from the reference image to the last tracked frame
+	 * @return 3x3 matrix
+	*/
+	const Mat& getHomography() const { return homography_; }
+	/**
+	 * @brief Gives the number of the tracked inliers
+	 * @return the number
+	*/
+	size_t getInliersCount() const { return objectPoints_.size(); }
+	/**
+	 * @brief Gives the mean reprojection error of the inliers in the last tracked frame
+	 * @return the error in pixels of the working resolution
+	*/
+	double getReprojectionError() const { return reprojectionError_; }
+};
@@ -0,0 +1,156 @@
+#include "CGemmMatcher.h"
+
+Mat CGemmMatcher::mergedDescriptors()
+{
+	startIndices_.clear();
+	Mat merged;
+	int start = 0;
+	for (auto& it : trainDescCollection) {
+		startIndices_.push_back(start);
+		start += it.rows;
+		if (!it.empty()) {
+			merged.push_back(it);
+		}
+	}
+	for (auto& it : utrainDescCollection) {
+		startIndices_.push_back(start);
+		start += it.rows;
+		if (!it.empty()) {
+			merged.push_back(it.getMat(ACCESS_READ));
+		}
+	}
+	return merged;
+}
+
+void CGemmMatcher::knnMatchImpl(InputArray queryDescriptors, vector<vector<DMatch>>& matches, int k, InputArrayOfArrays, bool compactResult)
+{
+	if (k < 1 || k > 2) {
+		throw invalid_argument("GEMM matcher - only one or two nearest neighbours can be found.");
+	}
+	Mat query = queryDescriptors.getMat();
+	if (query.type() != CV_32F || (!train_.empty() && query.cols != train_.cols)) {
+		throw invalid_argument("GEMM matcher - the query descriptors have to be float descriptors of the same length as the train descriptors.");
+	}
+	matches.assign(query.rows, vector<DMatch>());
+	if (train_.empty()) {
+		return;
+	}
+	dk::STop2Matches top2;
+	dk::top2L2Gemm(query, train_, trainNorms_, top2);
+
+	for (int q = 0; q < query.rows; ++q) {
+		const int found[] = { top2.trainIdx1_[q], top2.trainIdx2_[q] };
+		const float distances[] = { top2.distance1_[q], top2.distance2_[q] };
+		for (int n = 0; n < k && found[n] >= 0; ++n) {
+			int imageIndex = (int)(upper_bound(startIndices_.begin(), startIndices_.end(), found[n]) - startIndices_.begin()) - 1;
+			matches[q].emplace_back(q, found[n] - startIndices_[imageIndex], imageIndex, distances[n]);
+		}
+	}
+
+	if (compactResult) {
+		matches.erase(remove_if(matches.begin(), matches.end(), [](const vector<DMatch>& it) { return it.empty(); }), matches.end());
+	}
+}
+
+void CGemmMatcher::radiusMatchImpl(InputArray queryDescriptors, vector<vector<DMatch>>& matches, float maxDistance, InputArrayOfArrays, bool compactResult)
+{
+	BFMatcher matcher(NORM_L2);
+	matcher.add(train_);
+	matcher.radiusMatch(queryDescriptors, matches, maxDistance, noArray(), compactResult);
+	for (auto& it : matches) {
+		for (auto& match : it) {
+			match.imgIdx = (int)(upper_bound(startIndices_.begin(), startIndices_.end(), match.trainIdx) - startIndices_.begin()) - 1;
+			match.trainIdx -= startIndices_[match.imgIdx];
+		}
+	}
+}
+
+//=================================================================================================
+
+void CGemmMatcher::add(InputArrayOfArrays descriptors)
+{
+	DescriptorMatcher::add(descriptors);
+	trained_ = false;
+}
+
+void CGemmMatcher::clear()
+{
+	DescriptorMatcher::clear();
+	train_ = Mat();
+	trainNorms_.clear();
+	startIndices_.clear();
+	trained_ = false;
+}
+
+void CGemmMatcher::train()
+{
+	if (trained_) {
+		return;
+	}
+	train_ = mergedDescriptors();
+	dk::squaredNorms(train_, trainNorms_);
+	trained_ = true;
+}
+
+Ptr<DescriptorMatcher> CGemmMatcher::clone(bool emptyTrainData) const
+{
+	Ptr<CGemmMatcher> matcher = makePtr<CGemmMatcher>();
+	if (!emptyTrainData) {
+		for (auto& it : trainDescCollection) {
+			matcher->trainDescCollection.push_back(it.clone());
+		}
+		for (auto& it : utrainDescCollection) {
+			matcher->utrainDescCollection.push_back(it.clone());
+		}
+		matcher->train_ = train_;
+		matcher->trainNorms_ = trainNorms_;
+		matcher->startIndices_ = startIndices_;
+		matcher->trained_ = trained_;
+	}
+	return matcher;
+}
+
+vector<SGemmBenchmark> CGemmMatcher::benchmark(const Mat& query, const Mat& train, const vector<int>& descriptorsCounts)
+{
+	vector<SGemmBenchmark> result;
+	if (train.empty() || query.empty()) {
+		return result;
+	}
+	//the descriptors are repeated to get the wanted count
+	auto takeRows = [](const Mat& descriptors, int count) {
+		Mat rows;
+		while (rows.rows < count) {
+			rows.push_back(descriptors.rowRange(0, min(descriptors.rows, count - rows.rows)));
+		}
+		return rows;
+	};
+
+	for (int count : descriptorsCounts) {
+		Mat queryRows = takeRows(query, count);
+		Mat trainRows = takeRows(train, count);
+
+		chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+		vector<vector<DMatch>> exact;
+		BFMatcher(NORM_L2).knnMatch(queryRows, trainRows, exact, 2);
+		chrono::steady_clock::time_point afterBruteForce = chrono::steady_clock::now();
+		vector<float> norms;
+		dk::STop2Matches top2;
+		dk::squaredNorms(trainRows, norms);
+		dk::top2L2Gemm(queryRows, trainRows, norms, top2);
+		chrono::steady_clock::time_point afterGemm = chrono::steady_clock::now();
+
+		size_t same = 0;
+		for (int q = 0; q < queryRows.rows; ++q) {
+			if (exact[q].empty()) {
+				continue;
+			}
+			//the same neighbour or other neighbour in the same distance (the repeated rows have the same distance)
+			if (exact[q][0].trainIdx == top2.trainIdx1_[q] || top2.distance1_[q] <= exact[q][0].distance * (1.0f + 1e-5f)) {
+				++same;
+			}
+		}
+		result.push_back({ count, chrono::duration<double, milli>(afterBruteForce - begin).count(),
+			chrono::duration<double, milli>(afterGemm - afterBruteForce).count(), (double)same / (double)queryRows.rows });
+	}
+	return result;
+}
@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CGemmMatcher.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains descriptor matcher that finds the exact L2 nearest neighbours of the float descriptors by the matrix multiplication
+ *
+ *  It can be used everywhere instead of the OpenCV matchers (see CImagesMatch::createMatcher).
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <chrono>
+
+//matchers
+#include <opencv2/features2d.hpp>
+
+#include "DescriptorKernels.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Time of the GEMM matching and the brute force matching with one number of the descriptors
+*/
+struct SGemmBenchmark {
+	int descriptorsCount_; ///< number of the query descriptors and of the train descriptors
+	double bruteForceMs_; ///< time of BFMatcher (NORM_L2, two nearest neighbours)
+	double gemmMs_; ///< time of the GEMM matcher (including the train norms)
+	double agreement_; ///< ratio of the queries with the same nearest neighbour (or the same distance)
+};
+
+/**
+ * @brief Descriptor matcher that finds the exact L2 nearest neighbours of the float descriptors by the matrix multiplication (see dk::top2L2Gemm)
+ * 
+ * Usage is the same as the OpenCV matchers: add train descriptors -> train (merges them and computes their norms) -> knnMatch
+ * or directly knnMatch with the train descriptors (the OpenCV base class builds a temporary matcher then).
+ * 
+ * Only k <= 2 is supported by the kernel (the ratio test needs two neighbours), the radius matching is done by BFMatcher.
+ * 
+*/
+class CGemmMatcher : public DescriptorMatcher
+{
+	Mat train_; ///< merged train descriptors (empty until train)
+	vector<float> trainNorms_; ///< squared norms of the merged train descriptors
+	vector<int> startIndices_; ///< index of the first descriptor of every added image in the merged descriptors
+	bool trained_ = false; ///< whether the merged descriptors are up to date
+
+	/**
+	 * @brief Merges all the added descriptors into one matrix
+	 * @return the merged descriptors
+	*/
+	Mat mergedDescriptors();
+protected:
+	/**
+	 * @brief Finds k (at most 2) nearest neighbours of every query descriptor
+	 * @param queryDescriptors query float descriptors
+	 * @param matches output, for every query the found neighbours sorted by the distance
+	 * @param k number of the neighbours (1 or 2)
+	 * @param masks not supported
+	 * @param compactResult whether the queries without neighbours are removed
+	 * @throw invalid_argument if k is bigger than 2 or the descriptors are not float descriptors of the same length
+	*/
+	void knnMatchImpl(InputArray queryDescriptors, vector<vector<DMatch>>& matches, int k, InputArrayOfArrays masks = noArray(), bool compactResult = false) override;
+	/**
+	 * @brief Finds the neighbours closer than the distance (by BFMatcher)
+	 * @param queryDescriptors query float descriptors
+	 * @param matches output, for every query the found neighbours sorted by the distance
+	 * @param maxDistance maximal L2 distance
+	 * @param masks not supported
+	 * @param compactResult whether the queries without neighbours are removed
+	*/
+	void radiusMatchImpl(InputArray queryDescriptors, vector<vector<DMatch>>& matches, float maxDistance, InputArrayOfArrays masks = noArray(), bool compactResult = false) override;
+public:
+	/**
+	 * @brief Adds the train descriptors (the matcher has to be trained again)
+	 * @param descriptors float descriptors of one or more images
+	*/
+	void add(InputArrayOfArrays descriptors) override;
+	/**
+	 * @brief Removes the train descriptors
+	*/
+	void clear() override;
+	/**
+	 * @brief Merges the added descriptors and computes their norms, nothing is done if it is already trained
+	*/
+	void train() override;
+	/**
+	 * @brief The masks are not supported
+	 * @return false
+	*/
+	bool isMaskSupported() const override { return false; }
+	/**
+	 * @brief Creates a copy of the matcher
+	 * @param emptyTrainData whether the copy is without the train descriptors
+	 * @return the copy
+	*/
+	Ptr<DescriptorMatcher> clone(bool emptyTrainData = false) const override;
+	/**
+	 * @brief Measures the time of the GEMM matching against BFMatcher (NORM_L2) for several numbers of the descriptors
+	 * 
+	 * The query and train sets are taken from the given descriptors (repeated if there are not enough of them), the same number of both.
+	 * 
+	 * @param query query float descriptors
+	 * @param train train float descriptors
+	 * @param descriptorsCounts measured numbers of the descriptors
+	 * @return the time of both matchers for every number of the descriptors
+	*/
+	static vector<SGemmBenchmark> benchmark(const Mat& query, const Mat& train, const vector<int>& descriptorsCounts);
+};
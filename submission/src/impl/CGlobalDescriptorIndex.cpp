@@ -0,0 +1,77 @@
+#include "CGlobalDescriptorIndex.h"
+
+CGlobalDescriptorIndex::CGlobalDescriptorIndex(const vector<Ptr<CImage>>& objects, const SProcessParams& params)
+{
+	imagesFeaturesCount_.reserve(objects.size());
+	for (uint32_t imageId = 0; imageId < (uint32_t)objects.size(); ++imageId) {
+		//throws logic_error when the image is not processed or it is quantized
+		const Mat& descriptors = objects[imageId]->getDescriptors();
+		imagesFeaturesCount_.push_back((size_t)descriptors.rows);
+		if (descriptors.empty()) {
+			continue;
+		}
+		descriptors_.push_back(descriptors);
+		for (int i = 0; i < descriptors.rows; ++i) {
+			imageIds_.push_back(imageId);
+			localIndices_.push_back(i);
+		}
+	}
+	if (descriptors_.empty()) {
+		return;
+	}
+
+	if (params.storageParams_.packBinaryDescriptors_) {
+		packedDescriptors_ = makePtr<CBinaryDescriptorStore>(descriptors_);
+		return;
+	}
+	matcher_ = CImagesMatch::createMatcher(params);
+	//the HNSW graph of the references can be saved and loaded in the next runs
+	Ptr<CHnswMatcher> hnswMatcher = matcher_.dynamicCast<CHnswMatcher>();
+	if (!hnswMatcher.empty() && !params.hnswParams_.indexFile_.empty()) {
+		hnswMatcher->setIndexFile(params.hnswParams_.indexFile_);
+	}
+	matcher_->add(vector<Mat>{ descriptors_ });
+	matcher_->train();
+}
+
+SGlobalMatches CGlobalDescriptorIndex::match(const CImage& scene, double ratioTestAlpha) const
+{
+	SGlobalMatches result;
+	result.imagesKnnMatches_.resize(imagesFeaturesCount_.size());
+	result.votes_.assign(imagesFeaturesCount_.size(), 0);
+	if (imageIds_.empty() || scene.getKeypoints().empty()) {
+		return result;
+	}
+
+	//scene is the query here
+	vector<vector<DMatch>> sceneKnnMatches;
+	if (!packedDescriptors_.empty()) {
+		dk::STop2Matches top2;
+		scene.getPackedDescriptors().findTop2(*packedDescriptors_, top2);
+		CImagesMatch::top2ToKnnMatches(top2, sceneKnnMatches);
+	}
+	else {
+		matcher_->knnMatch(scene.getDescriptors(), sceneKnnMatches, 2);
+	}
+
+	for (auto& knn : sceneKnnMatches) {
+		if (knn.empty()) {
+			continue;
+		}
+		//the train index is turned into the index of the descriptor in its image
+		uint32_t imageId = imageIds_[knn[0].trainIdx];
+		knn[0].trainIdx = localIndices_[knn[0].trainIdx];
+		if (knn.size() > 1) {
+			//the second neighbour can be in another image, only its distance is used by the ratio test
+			knn[1].trainIdx = -1;
+			if (knn[0].distance < ratioTestAlpha * knn[1].distance) {
+				++result.votes_[imageId];
+			}
+		}
+		else {
+			++result.votes_[imageId];
+		}
+		result.imagesKnnMatches_[imageId].push_back(move(knn));
+	}
+	return result;
+}
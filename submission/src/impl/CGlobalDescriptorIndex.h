@@ -0,0 +1,90 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CGlobalDescriptorIndex.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class of the single index of the descriptors of all the reference images (every descriptor knows its image)
+ *
+ *  The scene is matched against the index only once and the reference images are voted by the matches that pass the Lowe's ratio test.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+//Matrices
+#include <opencv2/core/mat.hpp>
+//wrapper around basic shared pointer
+#include <opencv2/core/cvstd_wrapper.hpp>
+//matchers
+#include <opencv2/features2d.hpp>
+
+#include "CImage.h"
+#include "CImagesMatch.h"
+#include "CBinaryDescriptorStore.h"
+#include "SProcessParams.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Matches of the scene against all the reference images found by the single pass over the index
+*/
+struct SGlobalMatches {
+	vector<vector<vector<DMatch>>> imagesKnnMatches_; ///< knn matches of every reference image (query is the scene, train is the object, the second neighbour has train index -1)
+	vector<size_t> votes_; ///< number of the matches of every reference image that pass the Lowe's ratio test
+};
+
+/**
+ * @brief Class of the single index of the descriptors of all the reference images (every descriptor knows its image)
+ * 
+ * Usage is following: construct from the processed reference images (once) -> match every scene
+ * 
+ * The descriptors of the references are concatenated into one train set, so the matcher (FLANN index, brute force) is trained only once
+ * and every scene descriptor is matched only once instead of once per reference image. The nearest neighbour of the scene descriptor
+ * determines the reference image that gets the match, the second nearest neighbour (from any image) is used in the Lowe's ratio test.
+ * The matches are then split into the knn matches of the individual images, so the statistics of CImagesMatch are computed per image.
+ * 
+ * The index keeps its own copy of the descriptors, so the references can be quantized after the index was built.
+ * 
+*/
+class CGlobalDescriptorIndex
+{
+	Mat descriptors_; ///< concatenated descriptors of all the images
+	vector<uint32_t> imageIds_; ///< image (index in the references vector) of every descriptor
+	vector<int> localIndices_; ///< index of every descriptor in its image
+	vector<size_t> imagesFeaturesCount_; ///< number of the descriptors of every image
+	Ptr<DescriptorMatcher> matcher_; ///< matcher trained with the concatenated descriptors (empty if the packed descriptors are used)
+	Ptr<CBinaryDescriptorStore> packedDescriptors_; ///< packed concatenated descriptors (only if the packed binary descriptors are enabled)
+public:
+	/**
+	 * @brief Constructor, it concatenates the descriptors and trains the matcher
+	 * @param objects the processed reference images (not quantized)
+	 * @param params parameters that determine the matcher and the descriptors representation
+	 * @throw logic_error if the images were not processed or they are quantized
+	*/
+	CGlobalDescriptorIndex(const vector<Ptr<CImage>>& objects, const SProcessParams& params);
+	/**
+	 * @brief Matches the scene against all the reference images in one pass
+	 * @param scene the processed scene
+	 * @param ratioTestAlpha alpha of the Lowe's ratio test used for the voting
+	 * @return the knn matches and the votes of every reference image
+	*/
+	SGlobalMatches match(const CImage& scene, double ratioTestAlpha) const;
+	/**
+	 * @brief Gives the number of the descriptors of the reference image
+	 * @param imageId index of the image
+	 * @return the number of the descriptors
+	*/
+	size_t getImageFeaturesCount(size_t imageId) const { return imagesFeaturesCount_[imageId]; }
+	/**
+	 * @brief Gives the number of all the indexed descriptors
+	 * @return the number
+	*/
+	size_t size() const { return imageIds_.size(); }
+};
@@ -0,0 +1,126 @@
+#include "CGmsFilter.h"
+
+int CGmsFilter::cellIndex(const Point2f& point, const Size2f& cellSize, const Point2f& shift, int gridSize)
+{
+	int x = (int)floor(point.x / cellSize.width + shift.x);
+	int y = (int)floor(point.y / cellSize.height + shift.y);
+	if (x < 0 || y < 0 || x >= gridSize || y >= gridSize) {
+		return -1;
+	}
+	return y * gridSize + x;
+}
+
+int CGmsFilter::pairCount(const vector<uint64_t>& pairKeys, const vector<int>& pairCounts, uint64_t key)
+{
+	auto it = lower_bound(pairKeys.begin(), pairKeys.end(), key);
+	if (it == pairKeys.end() || *it != key) {
+		return 0;
+	}
+	return pairCounts[it - pairKeys.begin()];
+}
+
+size_t CGmsFilter::filter(const vector<DMatch>& matches, const vector<KeyPoint>& objectKeypoints, const Size& objectSize,
+	const vector<KeyPoint>& sceneKeypoints, const Size& sceneSize, vector<uchar>& inliersMask) const
+{
+	const int grid = params_.gridSize_;
+	const int cells = grid * grid;
+	//the object grid has one more row and column, so the points in the last half of the cell are not lost in the shifted grids
+	const int objectGrid = grid + 1;
+	const int objectCellsCount = objectGrid * objectGrid;
+	const Size2f objectCellSize((float)objectSize.width / grid, (float)objectSize.height / grid);
+	const Size2f sceneCellSize((float)sceneSize.width / grid, (float)sceneSize.height / grid);
+	inliersMask.assign(matches.size(), 0);
+
+	//the scene cells do not depend on the shift
+	vector<int> sceneCells(matches.size());
+	for (size_t m = 0; m < matches.size(); ++m) {
+		sceneCells[m] = cellIndex(sceneKeypoints[matches[m].trainIdx].pt, sceneCellSize, Point2f(0, 0), grid);
+	}
+
+	vector<int> objectCells(matches.size());
+	vector<uint64_t> matchKeys; //cell pair of every match inside both grids (object cell * cells + scene cell)
+	vector<uint64_t> pairKeys; //ascending keys of the cell pairs with any match
+	vector<int> pairCounts; //number of the matches of the cell pairs
+	vector<int> objectCellMatches(objectCellsCount);
+	vector<int> bestSceneCell(objectCellsCount);
+	vector<int> bestSceneCellMatches(objectCellsCount);
+	matchKeys.reserve(matches.size());
+	pairKeys.reserve(matches.size());
+	pairCounts.reserve(matches.size());
+	for (int shift = 0; shift < 4; ++shift) {
+		Point2f gridShift((shift & 1) ? 0.5f : 0.0f, (shift & 2) ? 0.5f : 0.0f);
+		matchKeys.clear();
+		fill(objectCellMatches.begin(), objectCellMatches.end(), 0);
+		for (size_t m = 0; m < matches.size(); ++m) {
+			objectCells[m] = cellIndex(objectKeypoints[matches[m].queryIdx].pt, objectCellSize, gridShift, objectGrid);
+			if (objectCells[m] < 0 || sceneCells[m] < 0) {
+				continue;
+			}
+			matchKeys.push_back((uint64_t)objectCells[m] * cells + sceneCells[m]);
+			++objectCellMatches[objectCells[m]];
+		}
+
+		//the same keys are next to each other after the sort, the runs are the counts of the cell pairs
+		sort(matchKeys.begin(), matchKeys.end());
+		pairKeys.clear();
+		pairCounts.clear();
+		for (size_t begin = 0; begin < matchKeys.size();) {
+			size_t end = begin;
+			while (end < matchKeys.size() && matchKeys[end] == matchKeys[begin]) {
+				++end;
+			}
+			pairKeys.push_back(matchKeys[begin]);
+			pairCounts.push_back((int)(end - begin));
+			begin = end;
+		}
+
+		//the scene cell to which most of the matches of the object cell lead (the lowest scene cell on the tie, the keys are ascending)
+		fill(bestSceneCell.begin(), bestSceneCell.end(), -1);
+		for (size_t p = 0; p < pairKeys.size(); ++p) {
+			int objectCell = (int)(pairKeys[p] / cells);
+			if (bestSceneCell[objectCell] < 0 || pairCounts[p] > bestSceneCellMatches[objectCell]) {
+				bestSceneCell[objectCell] = (int)(pairKeys[p] % cells);
+				bestSceneCellMatches[objectCell] = pairCounts[p];
+			}
+		}
+
+		//the motion statistics of the 3x3 neighbourhoods
+		vector<bool> supported(objectCellsCount, false);
+		for (int i = 0; i < objectCellsCount; ++i) {
+			if (bestSceneCell[i] < 0) {
+				continue;
+			}
+			int ox = i % objectGrid, oy = i / objectGrid;
+			int sx = bestSceneCell[i] % grid, sy = bestSceneCell[i] / grid;
+			int score = 0, neighbourMatches = 0, neighbours = 0;
+			for (int dy = -1; dy <= 1; ++dy) {
+				for (int dx = -1; dx <= 1; ++dx) {
+					if (ox + dx < 0 || ox + dx >= objectGrid || oy + dy < 0 || oy + dy >= objectGrid) {
+						continue;
+					}
+					int objectNeighbour = (oy + dy) * objectGrid + ox + dx;
+					++neighbours;
+					neighbourMatches += objectCellMatches[objectNeighbour];
+					if (sx + dx < 0 || sx + dx >= grid || sy + dy < 0 || sy + dy >= grid) {
+						continue;
+					}
+					score += pairCount(pairKeys, pairCounts, (uint64_t)objectNeighbour * cells + (sy + dy) * grid + sx + dx);
+				}
+			}
+			double threshold = params_.thresholdFactor_ * sqrt((double)neighbourMatches / neighbours);
+			supported[i] = score > threshold;
+		}
+
+		for (size_t m = 0; m < matches.size(); ++m) {
+			if (objectCells[m] >= 0 && supported[objectCells[m]] && sceneCells[m] == bestSceneCell[objectCells[m]]) {
+				inliersMask[m] = 1;
+			}
+		}
+	}
+
+	size_t kept = 0;
+	for (auto it : inliersMask) {
+		kept += it ? 1 : 0;
+	}
+	return kept;
+}
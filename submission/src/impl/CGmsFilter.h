@@ -0,0 +1,82 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CGmsFilter.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class that filters the matches by the grid-based motion statistics (GMS)
+ *
+ *  The true matches are supported by other matches in their neighbourhood that move to the neighbourhood of their counterpart,
+ *  the false ones are not. The matches without the support are removed before the homography estimation.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+//Matrices, KeyPoint, DMatch
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+
+#include "SProcessParams.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Class that filters the matches by the grid-based motion statistics (GMS)
+ * 
+ * Both images are divided into the grid. For every cell of the object the cell of the scene to which most of its matches lead is found
+ * (the cell pairs are counted sparsely from the sorted matches, so the cost does not depend on the number of the cells).
+ * The score of the cell pair is the number of the matches between the 3x3 neighbourhoods of both cells (the neighbour cells at the same offset).
+ * The matches of the cell pair are kept if the score exceeds threshold factor * sqrt(average number of the matches in the neighbour cells).
+ * The object grid is also shifted by a half of the cell in both axes and the matches kept in any of the four grids are the result
+ * (the object grid has one more row and column, so the shifted grids cover the whole image).
+ * 
+ * The scale and rotation variants of the original method are not used, the references and the scenes are upright photos of the buildings.
+ * 
+*/
+class CGmsFilter
+{
+	const SGmsParams params_; ///< parameters of the filter
+
+	/**
+	 * @brief Gives the cell of the point
+	 * @param point the point
+	 * @param cellSize size of the cell
+	 * @param shift shift of the grid in the cells
+	 * @param gridSize number of the cells of the grid in both axes
+	 * @return index of the cell (-1 if the point is out of the grid)
+	*/
+	static int cellIndex(const Point2f& point, const Size2f& cellSize, const Point2f& shift, int gridSize);
+	/**
+	 * @brief Gives the number of the matches of the cell pair
+	 * @param pairKeys ascending keys of the cell pairs with any match (object cell * cells + scene cell)
+	 * @param pairCounts number of the matches of every cell pair (the same order as pairKeys)
+	 * @param key key of the cell pair
+	 * @return the number of the matches (0 if the pair has no match)
+	*/
+	static int pairCount(const vector<uint64_t>& pairKeys, const vector<int>& pairCounts, uint64_t key);
+public:
+	/**
+	 * @brief Constructor
+	 * @param params parameters of the filter
+	*/
+	CGmsFilter(const SGmsParams& params) : params_(params) {}
+	/**
+	 * @brief Filters the matches
+	 * @param matches the matches (query is the object, train is the scene)
+	 * @param objectKeypoints keypoints of the object
+	 * @param objectSize size of the object image
+	 * @param sceneKeypoints keypoints of the scene
+	 * @param sceneSize size of the scene image
+	 * @param inliersMask output mask (one value per match, nonzero for the kept match)
+	 * @return number of the kept matches
+	*/
+	size_t filter(const vector<DMatch>& matches, const vector<KeyPoint>& objectKeypoints, const Size& objectSize,
+		const vector<KeyPoint>& sceneKeypoints, const Size& sceneSize, vector<uchar>& inliersMask) const;
+};
@@ -0,0 +1,55 @@
+#include "CGpsPriorIndex.h"
+
+double CGpsPriorIndex::facadeDistance(const sm::SGcsCoords& position, const pair<sm::SGcsCoords, sm::SGcsCoords>& facade)
+{
+	//meters relative to the position
+	double metersInLong = sm::metersInLongDeg(position.latitude_);
+	double metersInLat = sm::metersInLatDeg(position.latitude_);
+	Vec2d left((facade.first.longitude - position.longitude) * metersInLong, (facade.first.latitude_ - position.latitude_) * metersInLat);
+	Vec2d right((facade.second.longitude - position.longitude) * metersInLong, (facade.second.latitude_ - position.latitude_) * metersInLat);
+	//the closest point of the segment to the origin
+	Vec2d direction = right - left;
+	double lengthSquared = direction.dot(direction);
+	double t = lengthSquared > 0.0 ? min(max(-left.dot(direction) / lengthSquared, 0.0), 1.0) : 0.0;
+	return norm(left + t * direction);
+}
+
+//=================================================================================================
+
+CGpsPriorIndex::CGpsPriorIndex(const vector<Ptr<CImage>>& objectImages)
+{
+	vector<TFacadeEntry> entries;
+	entries.reserve(objectImages.size());
+	facades_.reserve(objectImages.size());
+	for (size_t i = 0; i < objectImages.size(); ++i) {
+		sm::SGcsCoords left = objectImages[i]->getLeftBaseGc();
+		sm::SGcsCoords right = objectImages[i]->getRightBaseGc();
+		facades_.emplace_back(left, right);
+		TGcsBox box(TGcsPoint(min(left.longitude, right.longitude), min(left.latitude_, right.latitude_)),
+			TGcsPoint(max(left.longitude, right.longitude), max(left.latitude_, right.latitude_)));
+		entries.emplace_back(box, i);
+	}
+	//the range constructor uses the packing algorithm (better tree than the insertions one by one)
+	tree_ = bgi::rtree<TFacadeEntry, bgi::quadratic<RTREE_NODE_CAPACITY>>(entries);
+}
+
+vector<size_t> CGpsPriorIndex::query(const SGpsPriorParams& prior) const
+{
+	sm::SGcsCoords position(prior.longitude_, prior.latitude_);
+	double longitudeRadius = prior.radius_ / sm::metersInLongDeg(prior.latitude_);
+	double latitudeRadius = prior.radius_ / sm::metersInLatDeg(prior.latitude_);
+	TGcsBox queryBox(TGcsPoint(prior.longitude_ - longitudeRadius, prior.latitude_ - latitudeRadius),
+		TGcsPoint(prior.longitude_ + longitudeRadius, prior.latitude_ + latitudeRadius));
+
+	vector<TFacadeEntry> intersecting;
+	tree_.query(bgi::intersects(queryBox), back_inserter(intersecting));
+	vector<size_t> indices;
+	indices.reserve(intersecting.size());
+	for (auto& it : intersecting) {
+		if (facadeDistance(position, facades_[it.second]) <= prior.radius_) {
+			indices.push_back(it.second);
+		}
+	}
+	sort(indices.begin(), indices.end());
+	return indices;
+}
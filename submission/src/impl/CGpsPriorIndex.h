@@ -0,0 +1,78 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CGpsPriorIndex.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class of the spatial index (R-tree) of the reference facades used to prefilter the references by the coarse GPS of the device
+ *
+ *  Every reference is a facade - segment between its leftBase and rightBase global coordinates.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+//R-tree of the bounding boxes of the facades
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+//wrapper around basic shared pointer
+#include <opencv2/core/cvstd_wrapper.hpp>
+
+#include "CImage.h"
+#include "SGcsCoords.h"
+#include "SpaceModule.h"
+#include "SProcessParams.h"
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Spatial index of the reference facades, it gives the references within the radius of the approximate position of the device
+ *
+ * The R-tree is built once (bulk loading) from the bounding boxes of the facades in degrees. The query takes the box of the radius around
+ * the position and the facades of the intersecting boxes are then checked by their exact distance in meters (local flat approximation).
+ * The longitude is not wrapped around the antimeridian.
+ *
+*/
+class CGpsPriorIndex
+{
+	typedef bg::model::point<double, 2, bg::cs::cartesian> TGcsPoint; ///< point in degrees (longitude, latitude)
+	typedef bg::model::box<TGcsPoint> TGcsBox; ///< bounding box in degrees
+	typedef pair<TGcsBox, size_t> TFacadeEntry; ///< bounding box of the facade and the index of its reference image
+	static const size_t RTREE_NODE_CAPACITY = 16; ///< maximal number of the entries in the node of the R-tree
+
+	bgi::rtree<TFacadeEntry, bgi::quadratic<RTREE_NODE_CAPACITY>> tree_; ///< R-tree of the facades
+	vector<pair<sm::SGcsCoords, sm::SGcsCoords>> facades_; ///< left and right base of every reference image (index of the image)
+
+	/**
+	 * @brief Computes the distance in meters from the position to the facade (local flat approximation around the position)
+	 * @param position the position
+	 * @param facade left and right base of the facade
+	 * @return the distance in meters
+	*/
+	static double facadeDistance(const sm::SGcsCoords& position, const pair<sm::SGcsCoords, sm::SGcsCoords>& facade);
+public:
+	/**
+	 * @brief Constructor, builds the index of the facades of all the reference images
+	 * @param objectImages the reference images (their order gives the indices of the query)
+	*/
+	CGpsPriorIndex(const vector<Ptr<CImage>>& objectImages);
+	/**
+	 * @brief Gives the references whose facades are within the radius of the position
+	 * @param prior the approximate position of the device and the radius
+	 * @return ascending indices of the reference images
+	*/
+	vector<size_t> query(const SGpsPriorParams& prior) const;
+	/**
+	 * @brief Gives the number of the indexed facades
+	 * @return the number of the facades
+	*/
+	size_t size() const { return facades_.size(); }
+};
@@ -0,0 +1,341 @@
+#include "CHnswIndex.h"
+
+void CHnswIndex::SVisited::reset(size_t nodesCount)
+{
+	if (tags_.size() != nodesCount) {
+		tags_.assign(nodesCount, 0);
+		epoch_ = 0;
+	}
+	++epoch_;
+	//overflow of the epoch - the old tags could be equal to the new epoch
+	if (epoch_ == 0) {
+		fill(tags_.begin(), tags_.end(), 0);
+		epoch_ = 1;
+	}
+}
+
+//=================================================================================================
+
+void CHnswIndex::greedySearch(const float* descriptor, int& node, float& nodeDistance, int level, bool locking) const
+{
+	vector<int> neighbours;
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		{
+			unique_lock<mutex> lock;
+			if (locking) {
+				lock = unique_lock<mutex>(nodeLocks_[node]);
+			}
+			const int* list = links(node, level);
+			neighbours.assign(list + 1, list + 1 + list[0]);
+		}
+		for (int neighbour : neighbours) {
+			float d = distance(descriptor, neighbour);
+			if (d < nodeDistance) {
+				nodeDistance = d;
+				node = neighbour;
+				changed = true;
+			}
+		}
+	}
+}
+
+vector<pair<float, int>> CHnswIndex::searchLevel(const float* descriptor, int entry, float entryDistance, int ef, int level, SVisited& visited, bool locking) const
+{
+	//closest found nodes (the farthest on the top) and the candidates to expand (the closest on the top)
+	priority_queue<pair<float, int>> found;
+	priority_queue<pair<float, int>, vector<pair<float, int>>, greater<pair<float, int>>> candidates;
+	visited.reset((size_t)data_.rows);
+	visited.visit(entry);
+	found.emplace(entryDistance, entry);
+	candidates.emplace(entryDistance, entry);
+
+	vector<int> neighbours;
+	while (!candidates.empty()) {
+		pair<float, int> current = candidates.top();
+		if (current.first > found.top().first && (int)found.size() >= ef) {
+			break;
+		}
+		candidates.pop();
+		{
+			unique_lock<mutex> lock;
+			if (locking) {
+				lock = unique_lock<mutex>(nodeLocks_[current.second]);
+			}
+			const int* list = links(current.second, level);
+			neighbours.assign(list + 1, list + 1 + list[0]);
+		}
+		for (int neighbour : neighbours) {
+			if (!visited.visit(neighbour)) {
+				continue;
+			}
+			float d = distance(descriptor, neighbour);
+			if ((int)found.size() < ef || d < found.top().first) {
+				candidates.emplace(d, neighbour);
+				found.emplace(d, neighbour);
+				if ((int)found.size() > ef) {
+					found.pop();
+				}
+			}
+		}
+	}
+
+	vector<pair<float, int>> result(found.size());
+	for (size_t i = result.size(); i > 0; --i) {
+		result[i - 1] = found.top();
+		found.pop();
+	}
+	return result;
+}
+
+vector<int> CHnswIndex::selectNeighbours(const vector<pair<float, int>>& candidates, int maxCount) const
+{
+	vector<int> selected;
+	selected.reserve(maxCount);
+	for (auto& candidate : candidates) {
+		if ((int)selected.size() >= maxCount) {
+			break;
+		}
+		bool closerToSelected = false;
+		for (int neighbour : selected) {
+			if (hal::normL2Sqr_(data_.ptr<float>(candidate.second), data_.ptr<float>(neighbour), data_.cols) < candidate.first) {
+				closerToSelected = true;
+				break;
+			}
+		}
+		if (!closerToSelected) {
+			selected.push_back(candidate.second);
+		}
+	}
+	return selected;
+}
+
+void CHnswIndex::connect(int neighbour, int node, int level)
+{
+	lock_guard<mutex> lock(nodeLocks_[neighbour]);
+	int* list = links(neighbour, level);
+	int maxCount = level == 0 ? maxM0_ : M_;
+	if (list[0] < maxCount) {
+		list[1 + list[0]] = node;
+		++list[0];
+		return;
+	}
+
+	//the list is full -> the heuristic chooses from the old neighbours and the new node
+	vector<pair<float, int>> candidates;
+	candidates.reserve(list[0] + 1);
+	const float* base = data_.ptr<float>(neighbour);
+	candidates.emplace_back(distance(base, node), node);
+	for (int i = 1; i <= list[0]; ++i) {
+		candidates.emplace_back(distance(base, list[i]), list[i]);
+	}
+	sort(candidates.begin(), candidates.end());
+	vector<int> selected = selectNeighbours(candidates, maxCount);
+	list[0] = (int)selected.size();
+	copy(selected.begin(), selected.end(), list + 1);
+}
+
+void CHnswIndex::insert(int node, SVisited& visited)
+{
+	const float* descriptor = data_.ptr<float>(node);
+	const int level = levels_[node];
+
+	//the node that becomes the new entry point keeps the entry lock for the whole insertion (the top levels are not consistent until then)
+	unique_lock<mutex> entryLock(entryLock_);
+	int current = entryPoint_;
+	const int maxLevel = maxLevel_;
+	if (current < 0) {
+		entryPoint_ = node;
+		maxLevel_ = level;
+		return;
+	}
+	if (level <= maxLevel) {
+		entryLock.unlock();
+	}
+
+	float currentDistance = distance(descriptor, current);
+	for (int l = maxLevel; l > level; --l) {
+		greedySearch(descriptor, current, currentDistance, l, true);
+	}
+	for (int l = min(level, maxLevel); l >= 0; --l) {
+		vector<pair<float, int>> candidates = searchLevel(descriptor, current, currentDistance, efConstruction_, l, visited, true);
+		vector<int> neighbours = selectNeighbours(candidates, M_);
+		{
+			lock_guard<mutex> lock(nodeLocks_[node]);
+			int* list = links(node, l);
+			list[0] = (int)neighbours.size();
+			copy(neighbours.begin(), neighbours.end(), list + 1);
+		}
+		for (int neighbour : neighbours) {
+			connect(neighbour, node, l);
+		}
+		current = candidates.front().second;
+		currentDistance = candidates.front().first;
+	}
+
+	if (level > maxLevel) {
+		entryPoint_ = node;
+		maxLevel_ = level;
+	}
+}
+
+uint64_t CHnswIndex::dataHash() const
+{
+	//FNV-1a over 64 bit words (the rows are continuous)
+	uint64_t hash = 14695981039346656037ULL;
+	const size_t bytes = data_.total() * data_.elemSize();
+	const uchar* data = data_.ptr<uchar>();
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(uint64_t));
+		hash = (hash ^ word) * 1099511628211ULL;
+	}
+	for (; i < bytes; ++i) {
+		hash = (hash ^ data[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+void CHnswIndex::prepare(const Mat& descriptors)
+{
+	if (!descriptors.empty() && descriptors.type() != CV_32F) {
+		throw invalid_argument("HNSW index supports only the float descriptors (CV_32F).");
+	}
+	data_ = descriptors.clone();
+	entryPoint_ = -1;
+	maxLevel_ = -1;
+	links0_.assign((size_t)data_.rows * (maxM0_ + 1), 0);
+	levels_.assign(data_.rows, 0);
+	upperLinks_.assign(data_.rows, vector<int>());
+	nodeLocks_.reset(new mutex[max(1, data_.rows)]);
+}
+
+//=================================================================================================
+
+CHnswIndex::CHnswIndex(const SHnswParams& params)
+	:
+	M_(params.M_),
+	maxM0_(2 * params.M_),
+	efConstruction_(params.efConstruction_),
+	levelMultiplier_(1.0 / log((double)params.M_))
+{
+}
+
+void CHnswIndex::build(const Mat& descriptors)
+{
+	prepare(descriptors);
+	if (data_.empty()) {
+		return;
+	}
+
+	//the levels are generated before the parallel insertion, so they do not depend on the order of the insertion
+	RNG rng(HNSW_RNG_SEED);
+	for (int i = 0; i < data_.rows; ++i) {
+		double uniform = max(rng.uniform(0.0, 1.0), numeric_limits<double>::min());
+		levels_[i] = min(HNSW_MAX_LEVEL, (int)floor(-log(uniform) * levelMultiplier_));
+		upperLinks_[i].assign((size_t)levels_[i] * (M_ + 1), 0);
+	}
+
+	SVisited visited;
+	insert(0, visited);
+	const int stripes = max(1, data_.rows / HNSW_BUILD_STRIPE_SIZE);
+	parallel_for_(Range(1, data_.rows), [this](const Range& range) {
+		SVisited stripeVisited;
+		for (int i = range.start; i < range.end; ++i) {
+			insert(i, stripeVisited);
+		}
+	}, stripes);
+}
+
+bool CHnswIndex::load(const string& filePath, const Mat& descriptors)
+{
+	ifstream in(filePath, ios::binary);
+	if (!in.good()) {
+		return false;
+	}
+	prepare(descriptors);
+
+	uint32_t magic = 0, version = 0;
+	int rows = 0, cols = 0, M = 0, entryPoint = -1, maxLevel = -1;
+	uint64_t hash = 0;
+	in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	in.read(reinterpret_cast<char*>(&version), sizeof(version));
+	in.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+	in.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+	in.read(reinterpret_cast<char*>(&M), sizeof(M));
+	in.read(reinterpret_cast<char*>(&entryPoint), sizeof(entryPoint));
+	in.read(reinterpret_cast<char*>(&maxLevel), sizeof(maxLevel));
+	in.read(reinterpret_cast<char*>(&hash), sizeof(hash));
+	if (!in.good() || magic != FILE_MAGIC || version != FILE_VERSION || rows != data_.rows || cols != data_.cols || M != M_ || hash != dataHash()) {
+		prepare(Mat());
+		return false;
+	}
+
+	in.read(reinterpret_cast<char*>(levels_.data()), levels_.size() * sizeof(int));
+	in.read(reinterpret_cast<char*>(links0_.data()), links0_.size() * sizeof(int));
+	for (int i = 0; in.good() && i < rows; ++i) {
+		if (levels_[i] < 0 || levels_[i] > HNSW_MAX_LEVEL) {
+			in.setstate(ios::failbit);
+			break;
+		}
+		upperLinks_[i].resize((size_t)levels_[i] * (M_ + 1));
+		in.read(reinterpret_cast<char*>(upperLinks_[i].data()), upperLinks_[i].size() * sizeof(int));
+	}
+	if (!in.good()) {
+		prepare(Mat());
+		return false;
+	}
+	entryPoint_ = entryPoint;
+	maxLevel_ = maxLevel;
+	return true;
+}
+
+void CHnswIndex::save(const string& filePath) const
+{
+	ofstream out(filePath, ios::binary | ios::trunc);
+	if (!out.good()) {
+		throw ios_base::failure("HNSW index file can't be written: " + filePath);
+	}
+	uint32_t magic = FILE_MAGIC, version = FILE_VERSION;
+	int rows = data_.rows, cols = data_.cols, M = M_;
+	uint64_t hash = dataHash();
+	out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+	out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	out.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+	out.write(reinterpret_cast<const char*>(&cols), sizeof(cols));
+	out.write(reinterpret_cast<const char*>(&M), sizeof(M));
+	out.write(reinterpret_cast<const char*>(&entryPoint_), sizeof(entryPoint_));
+	out.write(reinterpret_cast<const char*>(&maxLevel_), sizeof(maxLevel_));
+	out.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+	out.write(reinterpret_cast<const char*>(levels_.data()), levels_.size() * sizeof(int));
+	out.write(reinterpret_cast<const char*>(links0_.data()), links0_.size() * sizeof(int));
+	for (auto& it : upperLinks_) {
+		out.write(reinterpret_cast<const char*>(it.data()), it.size() * sizeof(int));
+	}
+	if (!out.good()) {
+		throw ios_base::failure("HNSW index file can't be written: " + filePath);
+	}
+}
+
+void CHnswIndex::search(const float* descriptor, int k, int efSearch, SVisited& visited, vector<pair<float, int>>& result) const
+{
+	result.clear();
+	if (entryPoint_ < 0) {
+		return;
+	}
+	int current = entryPoint_;
+	float currentDistance = distance(descriptor, current);
+	for (int l = maxLevel_; l > 0; --l) {
+		greedySearch(descriptor, current, currentDistance, l, false);
+	}
+	result = searchLevel(descriptor, current, currentDistance, max(efSearch, k), 0, visited, false);
+	if ((int)result.size() > k) {
+		result.resize(k);
+	}
+	//the same distance as the brute force L2 matcher
+	for (auto& it : result) {
+		it.first = sqrt(it.first);
+	}
+}
@@ -0,0 +1,209 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CHnswIndex.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class of the HNSW graph (Hierarchical Navigable Small World) for the approximate nearest neighbour search of the float descriptors
+ *
+ *  Malkov, Yashunin: Efficient and robust approximate nearest neighbor search using Hierarchical Navigable Small World graphs
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+//Matrices
+#include <opencv2/core/mat.hpp>
+//parallel_for_, random numbers
+#include <opencv2/core/utility.hpp>
+//vectorised L2 distance
+#include <opencv2/core/hal/hal.hpp>
+
+#include "SProcessParams.h"
+#include "parameters.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Class of the HNSW graph (Hierarchical Navigable Small World) for the approximate nearest neighbour search of the float descriptors (L2 distance)
+ * 
+ * Usage is following: construct -> build (or load) -> search (concurrently, every thread with its own SVisited)
+ * 
+ * Every descriptor is a node of the graph and it is inserted into the levels 0 ... its level (the levels are random with the exponential distribution).
+ * The search descends greedily from the top level and on the level 0 it keeps efSearch closest candidates.
+ * The build inserts the nodes in parallel (the neighbour lists are guarded by the per node locks), the levels of the nodes are generated
+ * by the seeded random generator before the build. The parallel insertion order makes the graph slightly different between the builds,
+ * the sequential build (1 thread) is reproducible.
+ * 
+*/
+class CHnswIndex
+{
+public:
+	/**
+	 * @brief Visited nodes of one search (the epoch tags avoid clearing the array for every search)
+	*/
+	struct SVisited {
+		vector<uint32_t> tags_; ///< epoch in which the node was visited
+		uint32_t epoch_ = 0; ///< epoch of the current search
+		/**
+		 * @brief Starts a new search
+		 * @param nodesCount number of the nodes of the graph
+		*/
+		void reset(size_t nodesCount);
+		/**
+		 * @brief Marks the node as visited
+		 * @param node the node
+		 * @return true if the node was not visited before in this search
+		*/
+		bool visit(int node) { if (tags_[node] == epoch_) return false; tags_[node] = epoch_; return true; }
+	};
+private:
+	static constexpr uint32_t FILE_MAGIC = 0x57534E48; ///< "HNSW" - identification of the index file
+	static constexpr uint32_t FILE_VERSION = 1; ///< version of the index file format
+
+	const int M_; ///< maximal number of the neighbours of the node on the upper levels
+	const int maxM0_; ///< maximal number of the neighbours of the node on the level 0 (2 * M_)
+	const int efConstruction_; ///< size of the candidates list during the build
+	const double levelMultiplier_; ///< normalisation of the level distribution (1 / ln(M))
+	Mat data_; ///< descriptors (CV_32F, continuous, one per row)
+	vector<int> levels_; ///< level of every node
+	vector<int> links0_; ///< neighbours on the level 0, every node has maxM0_ + 1 items (count, neighbours)
+	vector<vector<int>> upperLinks_; ///< neighbours on the upper levels, every level of the node has M_ + 1 items (count, neighbours)
+	int entryPoint_ = -1; ///< node on the top level where every search starts
+	int maxLevel_ = -1; ///< the top level
+	unique_ptr<mutex[]> nodeLocks_; ///< locks of the neighbour lists (used only during the build)
+	mutex entryLock_; ///< lock of the entry point (used only during the build)
+
+	/**
+	 * @brief Gives the neighbour list of the node (first item is the count)
+	 * @param node the node
+	 * @param level the level (it has to be at most the level of the node)
+	 * @return pointer to the list
+	*/
+	int* links(int node, int level) { return level == 0 ? &links0_[(size_t)node * (maxM0_ + 1)] : &upperLinks_[node][(size_t)(level - 1) * (M_ + 1)]; }
+	/**
+	 * @brief Gives the neighbour list of the node (first item is the count)
+	 * @param node the node
+	 * @param level the level (it has to be at most the level of the node)
+	 * @return pointer to the list
+	*/
+	const int* links(int node, int level) const { return level == 0 ? &links0_[(size_t)node * (maxM0_ + 1)] : &upperLinks_[node][(size_t)(level - 1) * (M_ + 1)]; }
+	/**
+	 * @brief Squared L2 distance of the descriptor to the node
+	 * @param descriptor the descriptor
+	 * @param node the node
+	 * @return the squared distance
+	*/
+	float distance(const float* descriptor, int node) const { return hal::normL2Sqr_(descriptor, data_.ptr<float>(node), data_.cols); }
+	/**
+	 * @brief Greedy search of the closest node on the level (used on the upper levels)
+	 * @param descriptor the searched descriptor
+	 * @param node input start node, output the closest found node
+	 * @param nodeDistance input distance of the start node, output distance of the closest found node
+	 * @param level the level
+	 * @param locking whether the neighbour lists are locked (during the build)
+	*/
+	void greedySearch(const float* descriptor, int& node, float& nodeDistance, int level, bool locking) const;
+	/**
+	 * @brief Search of the ef closest nodes on the level
+	 * @param descriptor the searched descriptor
+	 * @param entry start node
+	 * @param entryDistance distance of the start node
+	 * @param ef size of the candidates list
+	 * @param level the level
+	 * @param visited visited nodes
+	 * @param locking whether the neighbour lists are locked (during the build)
+	 * @return (squared distance, node) pairs sorted by the distance
+	*/
+	vector<pair<float, int>> searchLevel(const float* descriptor, int entry, float entryDistance, int ef, int level, SVisited& visited, bool locking) const;
+	/**
+	 * @brief Chooses the neighbours by the heuristic of the paper (the candidate closer to an already chosen neighbour than to the base is skipped)
+	 * @param candidates (squared distance to the base, node) pairs sorted by the distance
+	 * @param maxCount maximal number of the neighbours
+	 * @return the neighbours
+	*/
+	vector<int> selectNeighbours(const vector<pair<float, int>>& candidates, int maxCount) const;
+	/**
+	 * @brief Connects the neighbour with the new node (the neighbour list is shrinked by the heuristic when it is full)
+	 * @param neighbour the neighbour
+	 * @param node the new node
+	 * @param level the level
+	*/
+	void connect(int neighbour, int node, int level);
+	/**
+	 * @brief Inserts the node into the graph
+	 * @param node the node
+	 * @param visited visited nodes of the thread
+	*/
+	void insert(int node, SVisited& visited);
+	/**
+	 * @brief Hash of the descriptors (the index file is valid only for the same descriptors)
+	 * @return the hash
+	*/
+	uint64_t dataHash() const;
+	/**
+	 * @brief Sets the descriptors and prepares the levels and the empty neighbour lists
+	 * @param descriptors the descriptors
+	 * @throw invalid_argument if the descriptors are not float descriptors
+	*/
+	void prepare(const Mat& descriptors);
+public:
+	/**
+	 * @brief Constructor
+	 * @param params parameters of the graph (M, efConstruction)
+	*/
+	CHnswIndex(const SHnswParams& params);
+	/**
+	 * @brief Builds the graph (the nodes are inserted in parallel)
+	 * @param descriptors float descriptors (CV_32F, one per row), they are copied into the index
+	 * @throw invalid_argument if the descriptors are not float descriptors
+	*/
+	void build(const Mat& descriptors);
+	/**
+	 * @brief Loads the graph of the descriptors from the file
+	 * @param filePath filepath of the index file
+	 * @param descriptors the descriptors the graph was built from (they are copied into the index)
+	 * @return false if the file does not exist or it does not belong to the descriptors or to the parameters (the index is then empty)
+	*/
+	bool load(const string& filePath, const Mat& descriptors);
+	/**
+	 * @brief Saves the graph into the file (the descriptors are not saved, only their hash)
+	 * @param filePath filepath of the index file
+	 * @throw ios_base::failure if the file can't be written
+	*/
+	void save(const string& filePath) const;
+	/**
+	 * @brief Finds the k approximate nearest neighbours of the descriptor
+	 * @param descriptor the descriptor (the same length as the indexed descriptors)
+	 * @param k number of the neighbours
+	 * @param efSearch size of the candidates list (the bigger the more precise and slower, at least k is used)
+	 * @param visited visited nodes of the calling thread
+	 * @param result output (L2 distance, node) pairs sorted by the distance
+	*/
+	void search(const float* descriptor, int k, int efSearch, SVisited& visited, vector<pair<float, int>>& result) const;
+	/**
+	 * @brief Gives the number of the indexed descriptors
+	 * @return the number
+	*/
+	int size() const { return data_.rows; }
+	/**
+	 * @brief Gives the length of the indexed descriptors
+	 * @return the number of the values
+	*/
+	int dimension() const { return data_.cols; }
+};
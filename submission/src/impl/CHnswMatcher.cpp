@@ -0,0 +1,171 @@
+#include "CHnswMatcher.h"
+
+Mat CHnswMatcher::mergedDescriptors()
+{
+	startIndices_.clear();
+	Mat merged;
+	int start = 0;
+	for (auto& it : trainDescCollection) {
+		startIndices_.push_back(start);
+		start += it.rows;
+		if (!it.empty()) {
+			merged.push_back(it);
+		}
+	}
+	for (auto& it : utrainDescCollection) {
+		startIndices_.push_back(start);
+		start += it.rows;
+		if (!it.empty()) {
+			merged.push_back(it.getMat(ACCESS_READ));
+		}
+	}
+	return merged;
+}
+
+void CHnswMatcher::knnMatchImpl(InputArray queryDescriptors, vector<vector<DMatch>>& matches, int k, InputArrayOfArrays, bool compactResult)
+{
+	Mat query = queryDescriptors.getMat();
+	if (query.type() != CV_32F || query.cols != index_->dimension()) {
+		throw invalid_argument("HNSW matcher - the query descriptors have to be float descriptors of the same length as the train descriptors.");
+	}
+	matches.assign(query.rows, vector<DMatch>());
+	const int stripes = max(1, query.rows / HNSW_QUERY_STRIPE_SIZE);
+	parallel_for_(Range(0, query.rows), [&](const Range& range) {
+		CHnswIndex::SVisited visited;
+		vector<pair<float, int>> found;
+		for (int q = range.start; q < range.end; ++q) {
+			index_->search(query.ptr<float>(q), k, params_.efSearch_, visited, found);
+			for (auto& it : found) {
+				int imageIndex = (int)(upper_bound(startIndices_.begin(), startIndices_.end(), it.second) - startIndices_.begin()) - 1;
+				matches[q].emplace_back(q, it.second - startIndices_[imageIndex], imageIndex, it.first);
+			}
+		}
+	}, stripes);
+
+	if (compactResult) {
+		matches.erase(remove_if(matches.begin(), matches.end(), [](const vector<DMatch>& it) { return it.empty(); }), matches.end());
+	}
+}
+
+void CHnswMatcher::radiusMatchImpl(InputArray queryDescriptors, vector<vector<DMatch>>& matches, float maxDistance, InputArrayOfArrays masks, bool compactResult)
+{
+	knnMatchImpl(queryDescriptors, matches, params_.efSearch_, masks, false);
+	for (auto& it : matches) {
+		it.erase(remove_if(it.begin(), it.end(), [maxDistance](const DMatch& match) { return match.distance > maxDistance; }), it.end());
+	}
+	if (compactResult) {
+		matches.erase(remove_if(matches.begin(), matches.end(), [](const vector<DMatch>& it) { return it.empty(); }), matches.end());
+	}
+}
+
+//=================================================================================================
+
+CHnswMatcher::CHnswMatcher(const SHnswParams& params)
+	:
+	params_(params)
+{
+}
+
+void CHnswMatcher::add(InputArrayOfArrays descriptors)
+{
+	DescriptorMatcher::add(descriptors);
+	index_.reset();
+	loadedFromFile_ = false;
+}
+
+void CHnswMatcher::clear()
+{
+	DescriptorMatcher::clear();
+	index_.reset();
+	startIndices_.clear();
+	loadedFromFile_ = false;
+}
+
+void CHnswMatcher::train()
+{
+	if (!index_.empty()) {
+		return;
+	}
+	Mat descriptors = mergedDescriptors();
+	index_ = makePtr<CHnswIndex>(params_);
+	if (!indexFile_.empty() && index_->load(indexFile_, descriptors)) {
+		loadedFromFile_ = true;
+		return;
+	}
+	index_->build(descriptors);
+	if (!indexFile_.empty()) {
+		boost::filesystem::path indexPath(indexFile_);
+		if (indexPath.has_parent_path()) {
+			boost::filesystem::create_directories(indexPath.parent_path());
+		}
+		index_->save(indexFile_);
+	}
+}
+
+Ptr<DescriptorMatcher> CHnswMatcher::clone(bool emptyTrainData) const
+{
+	Ptr<CHnswMatcher> matcher = makePtr<CHnswMatcher>(params_);
+	matcher->indexFile_ = indexFile_;
+	if (!emptyTrainData) {
+		for (auto& it : trainDescCollection) {
+			matcher->trainDescCollection.push_back(it.clone());
+		}
+		for (auto& it : utrainDescCollection) {
+			matcher->utrainDescCollection.push_back(it.clone());
+		}
+		matcher->index_ = index_;
+		matcher->startIndices_ = startIndices_;
+		matcher->loadedFromFile_ = loadedFromFile_;
+	}
+	return matcher;
+}
+
+vector<SHnswRecall> CHnswMatcher::measureRecall(const Mat& train, const Mat& query, const SHnswParams& params, const vector<int>& efSearchValues, double& bruteForceMs, double& buildMs)
+{
+	vector<SHnswRecall> result;
+	bruteForceMs = 0.0;
+	buildMs = 0.0;
+	if (train.empty() || query.empty()) {
+		return result;
+	}
+
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	vector<vector<DMatch>> exact;
+	BFMatcher(NORM_L2).knnMatch(query, train, exact, 1);
+	chrono::steady_clock::time_point afterBruteForce = chrono::steady_clock::now();
+	bruteForceMs = chrono::duration<double, milli>(afterBruteForce - begin).count();
+
+	//the graph is built once, only the search is measured for every efSearch
+	CHnswIndex index(params);
+	index.build(train);
+	chrono::steady_clock::time_point afterBuild = chrono::steady_clock::now();
+	buildMs = chrono::duration<double, milli>(afterBuild - afterBruteForce).count();
+
+	const int stripes = max(1, query.rows / HNSW_QUERY_STRIPE_SIZE);
+	vector<pair<float, int>> nearest(query.rows);
+	for (int efSearch : efSearchValues) {
+		chrono::steady_clock::time_point beforeSearch = chrono::steady_clock::now();
+		parallel_for_(Range(0, query.rows), [&](const Range& range) {
+			CHnswIndex::SVisited visited;
+			vector<pair<float, int>> found;
+			for (int q = range.start; q < range.end; ++q) {
+				index.search(query.ptr<float>(q), 1, efSearch, visited, found);
+				nearest[q] = found.empty() ? make_pair(numeric_limits<float>::max(), -1) : found[0];
+			}
+		}, stripes);
+		chrono::steady_clock::time_point afterSearch = chrono::steady_clock::now();
+
+		size_t hits = 0;
+		for (int q = 0; q < query.rows; ++q) {
+			if (exact[q].empty()) {
+				continue;
+			}
+			//the same neighbour or other neighbour in the same distance
+			if (exact[q][0].trainIdx == nearest[q].second || nearest[q].first <= exact[q][0].distance * (1.0f + 1e-5f)) {
+				++hits;
+			}
+		}
+		result.push_back({ efSearch, (double)hits / (double)query.rows, chrono::duration<double, milli>(afterSearch - beforeSearch).count() });
+	}
+	return result;
+}
@@ -0,0 +1,132 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CHnswMatcher.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains descriptor matcher that uses the HNSW graph (approximate nearest neighbours of the float descriptors)
+ *
+ *  It can be used everywhere instead of the OpenCV matchers (see CImagesMatch::createMatcher).
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <boost/filesystem.hpp>
+
+//matchers
+#include <opencv2/features2d.hpp>
+
+#include "CHnswIndex.h"
+#include "SProcessParams.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Recall and latency of the HNSW search with one efSearch value (compared with the brute force search)
+*/
+struct SHnswRecall {
+	int efSearch_; ///< size of the candidates list of the search
+	double recall_; ///< ratio of the queries whose nearest neighbour is the same as the brute force one
+	double latencyMs_; ///< time of the search of all the queries in milliseconds
+};
+
+/**
+ * @brief Descriptor matcher that uses the HNSW graph (approximate nearest neighbours of the float descriptors, L2 distance)
+ * 
+ * Usage is the same as the OpenCV matchers: add train descriptors -> train (builds or loads the graph) -> knnMatch (queries are searched in parallel)
+ * or directly knnMatch with the train descriptors (the OpenCV base class builds a temporary matcher then).
+ * 
+ * All the added descriptors are merged into one graph, the results are mapped back to the image and descriptor index.
+ * When the index file is set, train loads the graph from it (if it belongs to the same descriptors) or it saves the built graph into it.
+ * 
+*/
+class CHnswMatcher : public DescriptorMatcher
+{
+	const SHnswParams params_; ///< parameters of the graph and the search
+	Ptr<CHnswIndex> index_; ///< the graph (empty until train)
+	vector<int> startIndices_; ///< index of the first descriptor of every added image in the merged descriptors
+	string indexFile_; ///< filepath of the index file (empty if the graph is not persisted)
+	bool loadedFromFile_ = false; ///< whether the graph was loaded from the index file
+
+	/**
+	 * @brief Merges all the added descriptors into one matrix
+	 * @return the merged descriptors
+	*/
+	Mat mergedDescriptors();
+protected:
+	/**
+	 * @brief Finds k nearest neighbours of every query descriptor in the graph
+	 * @param queryDescriptors query float descriptors
+	 * @param matches output, for every query the found neighbours sorted by the distance
+	 * @param k number of the neighbours
+	 * @param masks not supported
+	 * @param compactResult whether the queries without neighbours are removed
+	*/
+	void knnMatchImpl(InputArray queryDescriptors, vector<vector<DMatch>>& matches, int k, InputArrayOfArrays masks = noArray(), bool compactResult = false) override;
+	/**
+	 * @brief Finds the neighbours closer than the distance (from the efSearch closest candidates)
+	 * @param queryDescriptors query float descriptors
+	 * @param matches output, for every query the found neighbours sorted by the distance
+	 * @param maxDistance maximal L2 distance
+	 * @param masks not supported
+	 * @param compactResult whether the queries without neighbours are removed
+	*/
+	void radiusMatchImpl(InputArray queryDescriptors, vector<vector<DMatch>>& matches, float maxDistance, InputArrayOfArrays masks = noArray(), bool compactResult = false) override;
+public:
+	/**
+	 * @brief Constructor
+	 * @param params parameters of the graph and the search
+	*/
+	CHnswMatcher(const SHnswParams& params);
+	/**
+	 * @brief Sets the index file, the graph is loaded from it or saved into it by train
+	 * @param filePath filepath of the index file
+	*/
+	void setIndexFile(const string& filePath) { indexFile_ = filePath; }
+	/**
+	 * @brief Gives information whether the graph was loaded from the index file
+	 * @return true if it was loaded, false if it was built
+	*/
+	bool wasLoadedFromFile() const { return loadedFromFile_; }
+	/**
+	 * @brief Adds the train descriptors (the graph has to be trained again)
+	 * @param descriptors float descriptors of one or more images
+	*/
+	void add(InputArrayOfArrays descriptors) override;
+	/**
+	 * @brief Removes the train descriptors and the graph
+	*/
+	void clear() override;
+	/**
+	 * @brief Builds the graph of the added descriptors (or loads it from the index file), nothing is done if the graph is already built
+	 * @throw ios_base::failure if the graph can't be saved into the index file
+	*/
+	void train() override;
+	/**
+	 * @brief The masks are not supported
+	 * @return false
+	*/
+	bool isMaskSupported() const override { return false; }
+	/**
+	 * @brief Creates a copy of the matcher (the built graph is shared, it is not changed after the build)
+	 * @param emptyTrainData whether the copy is without the train descriptors
+	 * @return the copy
+	*/
+	Ptr<DescriptorMatcher> clone(bool emptyTrainData = false) const override;
+	/**
+	 * @brief Measures the recall and the latency of the HNSW search for several efSearch values against the brute force L2 search
+	 * @param train train float descriptors
+	 * @param query query float descriptors
+	 * @param params parameters of the graph
+	 * @param efSearchValues measured efSearch values
+	 * @param bruteForceMs output time of the brute force search in milliseconds
+	 * @param buildMs output time of the build of the graph in milliseconds
+	 * @return recall and latency of every efSearch value
+	*/
+	static vector<SHnswRecall> measureRecall(const Mat& train, const Mat& query, const SHnswParams& params, const vector<int>& efSearchValues, double& bruteForceMs, double& buildMs);
+};
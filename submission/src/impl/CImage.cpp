@@ -11,6 +11,34 @@ CImage::CDetectorExtractor::CDetectorExtractor(const SProcessParams& params) {
 		detector_ = getDetector(params);
 		extractor_ = getExtractor(params);
 	}
+	claheStage_ = makePtr<CClaheStage>(params.claheParams_);
+
+	if (params.gridParams_.enabled()) {
+		cellFeaturesLimit_ = getCellFeaturesLimit(params);
+		//the cell detectors have the cell limit (ORB needs a positive limit)
+		SProcessParams cellParams = params;
+		cellParams.siftParams_.nfeatures_ = cellFeaturesLimit_;
+		if (cellFeaturesLimit_ > 0) {
+			cellParams.orbParams_.nfeatures_ = cellFeaturesLimit_;
+		}
+		int workers = min(getNumThreads(), params.gridParams_.cols_ * params.gridParams_.rows_);
+		for (int i = 0; i < max(workers, 1); ++i) {
+			cellDetectors_.push_back(getDetector(cellParams));
+		}
+	}
+}
+
+int CImage::CDetectorExtractor::getCellFeaturesLimit(const SProcessParams& params)
+{
+	if (params.gridParams_.cellFeaturesLimit_ > 0) {
+		return params.gridParams_.cellFeaturesLimit_;
+	}
+	int featuresLimit = (params.detectMethod_ == EAlgorithm::ALG_ORB) ? params.orbParams_.nfeatures_ : params.siftParams_.nfeatures_;
+	if (featuresLimit <= 0) {
+		return 0;
+	}
+	int cells = params.gridParams_.cols_ * params.gridParams_.rows_;
+	return max(1, (featuresLimit + cells - 1) / cells);
 }
 
 Ptr<Feature2D> CImage::CDetectorExtractor::getDetector(const SProcessParams& params)
@@ -117,7 +145,13 @@ Ptr<Feature2D> CImage::CDetectorExtractor::getDetectorExtractor(const SProcessPa
 
 void CImage::detectDescribeFeatures(const SProcessParams & params, Ptr<CLogger>& logger, const Ptr<CDetectorExtractor>& detectorExtractor)
 {
-	if (params.detectMethod_ == params.describeMethod_ ||
+	if (params.gridParams_.enabled()) {
+		if (detectorExtractor.empty()) {
+			throw invalid_argument("Method detectDescribeFeatures was called with empty pointer to CDetectorExtractor");
+		}
+		detectGridFeatures(params, logger, *detectorExtractor);
+	}
+	else if (params.detectMethod_ == params.describeMethod_ ||
 		(params.detectMethod_ == EAlgorithm::ALG_SIFT && params.describeMethod_ == EAlgorithm::ALG_ROOTSIFT)) {
 		if (detectorExtractor.empty()) {
 			throw invalid_argument("Method detectDescribeFeatures was called with empty pointer to CDetectorExtractor");
@@ -135,103 +169,251 @@ void CImage::detectDescribeFeatures(const SProcessParams & params, Ptr<CLogger>&
 	}
 }
 
-//=================================================================================================
-
-void CImage::processCLAHE(Ptr<CLogger>& logger)
+void CImage::detectGridFeatures(const SProcessParams& params, Ptr<CLogger>& logger, CDetectorExtractor& detectorExtractor)
 {
-	//TODO think about the parameters for clahe
-	Ptr<CLAHE> clahePtr = createCLAHE();
-	//wikipedia:  Common values limit the resulting amplification to between 3 and 4. 
-	//from a test I got a better result with 3
-	clahePtr->setClipLimit(3);
-	clahePtr->apply(image_, image_);
-
-	logger->log("  CLAHE was done on the image.");
+	const int cols = params.gridParams_.cols_;
+	const int rows = params.gridParams_.rows_;
+	const int cellsCount = cols * rows;
+	const int cellLimit = detectorExtractor.cellFeaturesLimit_;
+	vector<vector<KeyPoint>> cellKeypoints(cellsCount);
+
+	//every worker has its own detector and it takes every workers-th cell
+	const int workers = (int)detectorExtractor.cellDetectors_.size();
+	parallel_for_(Range(0, workers), [&](const Range& range) {
+		for (int worker = range.start; worker < range.end; ++worker) {
+			Ptr<Feature2D>& detector = detectorExtractor.cellDetectors_[worker];
+			for (int cell = worker; cell < cellsCount; cell += workers) {
+				int cx = cell % cols;
+				int cy = cell / cols;
+				Rect cellRect(cx * image_.cols / cols, cy * image_.rows / rows, 0, 0);
+				cellRect.width = (cx + 1) * image_.cols / cols - cellRect.x;
+				cellRect.height = (cy + 1) * image_.rows / rows - cellRect.y;
+				Rect detectedRect = Rect(cellRect.x - GRID_DETECTION_CELL_MARGIN, cellRect.y - GRID_DETECTION_CELL_MARGIN,
+					cellRect.width + 2 * GRID_DETECTION_CELL_MARGIN, cellRect.height + 2 * GRID_DETECTION_CELL_MARGIN) & Rect(0, 0, image_.cols, image_.rows);
+
+				vector<KeyPoint> detected;
+				detector->detect(image_(detectedRect), detected);
+				vector<KeyPoint>& keypoints = cellKeypoints[cell];
+				keypoints.reserve(detected.size());
+				for (auto& keypoint : detected) {
+					keypoint.pt.x += (float)detectedRect.x;
+					keypoint.pt.y += (float)detectedRect.y;
+					if (cellRect.contains(keypoint.pt)) {
+						keypoints.push_back(keypoint);
+					}
+				}
+				if (cellLimit > 0) {
+					KeyPointsFilter::retainBest(keypoints, cellLimit);
+				}
+			}
+		}
+	});
+
+	//merged in the order of the cells so the result does not depend on the threads
+	imageKeypoints_.clear();
+	for (const auto& keypoints : cellKeypoints) {
+		imageKeypoints_.insert(imageKeypoints_.end(), keypoints.begin(), keypoints.end());
+	}
+	detectorExtractor.extractor_->compute(image_, imageKeypoints_, keypointsDescriptors_);
+	logger->endl().log("  Grid detection (").log(to_string(cols)).log("x").log(to_string(rows)).log(" cells) and description done, keypoints count: ")
+		.log(to_string(imageKeypoints_.size())).endl();
+	wasProcessed_ = true;
 }
 
 //=================================================================================================
 
-void CImage::fastRootSiftDescriptorsAdjust(Ptr<CLogger>& logger)
+void CImage::processCLAHE(Ptr<CLogger>& logger, CClaheStage& claheStage)
 {
-	double eps = 1e-7;
-	//for every descriptor do some processing
-	for (size_t i = 0; i < keypointsDescriptors_.rows; ++i) {
-
-		//L1 normalization
-		double norm1Sum = 0;
-		for (size_t j = 0; j < keypointsDescriptors_.cols; ++j) {
-			//the values in the descriptor vector should be in range [0,1]
-			norm1Sum += keypointsDescriptors_.at<float>(i, j);
-		}
+	claheStage.apply(image_);
 
-		double norm2Sum = 0;
-
-		//converting the descriptor to the Hellinger kernel
-		for (size_t j = 0; j < keypointsDescriptors_.cols; ++j) {
-			//no problem here with the sqrt since the descriptopr will be always positive
-			(keypointsDescriptors_.at<float>(i, j) = sqrt((keypointsDescriptors_.at<float>(i, j) + eps) / norm1Sum));
-			norm2Sum += (keypointsDescriptors_.at<float>(i, j) * keypointsDescriptors_.at<float>(i, j));
-		}
+	if (claheStage.lastWasGlobal()) {
+		logger->log("  Global histogram equalisation was done on the image (CLAHE was not needed)");
+	}
+	else {
+		logger->log("  CLAHE was done on the image");
+	}
+	logger->log(", it took: ").log(to_string(claheStage.getLastDurationMs())).log(" ms.");
+}
 
-		norm2Sum += eps;
+//=================================================================================================
 
-		//L2 normalisation
-		for(size_t j = 0; j < keypointsDescriptors_.cols; ++j) {
-			keypointsDescriptors_.at<float>(i, j) = keypointsDescriptors_.at<float>(i, j) / norm2Sum;
-		}
-	}
+void CImage::fastRootSiftDescriptorsAdjust(Ptr<CLogger>& logger)
+{
+	//vectorised in place computation, rows in parallel
+	dk::rootSiftNormalize(keypointsDescriptors_, false);
 
 	logger->log("the descriptors have been adjusted with the rootSIFT processing").endl();
 }
 
 void CImage::preciseRootSiftDescriptorsAdjust(Ptr<CLogger>& logger)
 {
-	double eps = 1e-7;
+	//double precision accumulation, in place (without the double copy of the descriptors), rows in parallel
+	dk::rootSiftNormalize(keypointsDescriptors_, true);
 
-	Mat floatDescriptors;
-	keypointsDescriptors_.convertTo(floatDescriptors, CV_64F);
+	logger->log("the descriptors have been adjusted with the rootSIFT processing").endl();
+}
 
-	//for every descriptor do some processing
-	for (size_t i = 0; i < floatDescriptors.rows; ++i) {
+//=================================================================================================
 
-		double norm1Sum = 0;
-		for (size_t j = 0; j < floatDescriptors.cols; ++j) {
-			//the values in the descriptor vector should be in range [0,1]
-			norm1Sum += floatDescriptors.at<double>(i, j);
+bool CImage::readHeaderSize(const string& filePath, Size& size, bool& isJpeg)
+{
+	isJpeg = false;
+	ifstream in(filePath, ios::binary);
+	unsigned char signature[8];
+	if (!in.read(reinterpret_cast<char*>(signature), 8)) {
+		return false;
+	}
+	auto readBigEndian = [&in](int bytes) -> int {
+		int value = 0;
+		for (int i = 0; i < bytes; ++i) {
+			value = (value << 8) | (in.get() & 0xFF);
 		}
-
-		double norm2Sum = 0;
-		//converting the descriptor to the Hellinger kernel
-		for (size_t j = 0; j < floatDescriptors.cols; ++j) {
-			//no problem here with the sqrt since the descriptopr will be always positive
-			(floatDescriptors.at<double>(i, j) = sqrt((floatDescriptors.at<double>(i, j) + eps) / norm1Sum));
-			norm2Sum += (floatDescriptors.at<double>(i, j) * floatDescriptors.at<double>(i, j));
+		return value;
+	};
+
+	//PNG - the IHDR chunk is always the first one
+	const unsigned char pngSignature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+	if (equal(signature, signature + 8, pngSignature)) {
+		in.seekg(16);
+		int width = readBigEndian(4);
+		int height = readBigEndian(4);
+		if (!in.good()) {
+			return false;
 		}
+		size = Size(width, height);
+		return true;
+	}
 
-		norm2Sum += eps;
+	//JPEG - walk the markers to the start of frame marker
+	if (signature[0] != 0xFF || signature[1] != 0xD8) {
+		return false;
+	}
+	isJpeg = true;
+	in.seekg(2);
+	while (in.good()) {
+		int byte = in.get();
+		if (byte != 0xFF) {
+			return false;
+		}
+		int marker = in.get();
+		while (marker == 0xFF) {
+			marker = in.get();
+		}
+		//markers without length
+		if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+			continue;
+		}
+		int length = readBigEndian(2);
+		//SOF0 - SOF15 without DHT (C4), JPG (C8) and DAC (CC)
+		if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+			in.get(); //precision
+			int height = readBigEndian(2);
+			int width = readBigEndian(2);
+			if (!in.good()) {
+				return false;
+			}
+			size = Size(width, height);
+			return true;
+		}
+		if (length < 2 || marker == 0xD9 || marker == 0xDA) {
+			return false;
+		}
+		in.seekg(length - 2, ios::cur);
+	}
+	return false;
+}
 
-		//L2 normalisation
-		for (size_t j = 0; j < floatDescriptors.cols; ++j) {
-			//the values in the descriptor vector should be in range [0,1]
-			keypointsDescriptors_.at<float>(i, j) = (float)floatDescriptors.at<double>(i, j) / norm2Sum;
+void CImage::loadImage(int maxResolution)
+{
+	Size headerSize;
+	bool isJpeg = false;
+	bool headerRead = readHeaderSize(filePath_, headerSize, isJpeg);
+
+	//the biggest JPEG reduction that does not go under the maximal resolution
+	int reduction = 1;
+	int flags = IMREAD_GRAYSCALE;
+	if (maxResolution > 0 && headerRead && isJpeg) {
+		int longerSide = max(headerSize.width, headerSize.height);
+		const int reductions[] = { 8, 4, 2 };
+		const int reductionFlags[] = { IMREAD_REDUCED_GRAYSCALE_8, IMREAD_REDUCED_GRAYSCALE_4, IMREAD_REDUCED_GRAYSCALE_2 };
+		for (int i = 0; i < 3; ++i) {
+			if ((longerSide + reductions[i] - 1) / reductions[i] >= maxResolution) {
+				reduction = reductions[i];
+				flags = reductionFlags[i];
+				break;
+			}
 		}
 	}
 
-	logger->log("the descriptors have been adjusted with the rootSIFT processing").endl();
-}
+	image_ = imread(filePath_, flags);
+	if (image_.empty())
+	{
+		throw ios_base::failure("Can't load image with file path: " + filePath_);
+	}
 
-//=================================================================================================
+	//the reduced decoding has exact scale 1/reduction (the size is rounded up)
+	if (reduction == 1) {
+		originalSize_ = image_.size();
+	}
+	else {
+		originalSize_ = headerSize;
+		//the orientation from EXIF may have been applied by the decoder
+		if ((image_.cols > image_.rows) != (headerSize.width > headerSize.height)) {
+			originalSize_ = Size(headerSize.height, headerSize.width);
+		}
+	}
+	resolutionScale_ = Point2d(1.0 / reduction, 1.0 / reduction);
+
+	int longerSide = max(image_.cols, image_.rows);
+	if (maxResolution > 0 && longerSide > maxResolution) {
+		double scale = (double)maxResolution / (double)longerSide;
+		Size workingSize(max(1, cvRound(image_.cols * scale)), max(1, cvRound(image_.rows * scale)));
+		resolutionScale_.x *= (double)workingSize.width / (double)image_.cols;
+		resolutionScale_.y *= (double)workingSize.height / (double)image_.rows;
+		resize(image_, image_, workingSize, 0, 0, INTER_AREA);
+	}
+}
 
-CImage::CImage(const string& filePath, const sm::SGcsCoords& rightBaseGc, const sm::SGcsCoords& leftBaseGc)
+CImage::CImage(const string& filePath, const sm::SGcsCoords& rightBaseGc, const sm::SGcsCoords& leftBaseGc, int maxResolution)
 	:
 	filePath_(filePath),
 	rightBaseGc_(rightBaseGc),
 	leftBaseGc_(leftBaseGc)
 {
-	image_ = imread(filePath, CV_8U);
-	if (image_.empty())
-	{
-		throw ios_base::failure("Can't load image with file path: " + filePath);
+	loadImage(maxResolution);
+}
+
+CImage::CImage(const Mat& frame, const string& name, int maxResolution)
+	:
+	filePath_(name),
+	rightBaseGc_(0.0, 0.0),
+	leftBaseGc_(0.0, 0.0)
+{
+	if (frame.empty()) {
+		throw ios_base::failure("Can't use empty frame: " + name);
+	}
+	originalSize_ = frame.size();
+	int longerSide = max(frame.cols, frame.rows);
+	Size workingSize = frame.size();
+	if (maxResolution > 0 && longerSide > maxResolution) {
+		double scale = (double)maxResolution / (double)longerSide;
+		workingSize = Size(max(1, cvRound(frame.cols * scale)), max(1, cvRound(frame.rows * scale)));
+	}
+	resolutionScale_ = Point2d((double)workingSize.width / (double)frame.cols, (double)workingSize.height / (double)frame.rows);
+
+	//the conversion and the downscaling create a new matrix, so the frame buffer of the source is never changed by the processing
+	Mat gray;
+	if (frame.channels() == 1) {
+		gray = frame;
+	}
+	else {
+		cvtColor(frame, gray, frame.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+	}
+	if (workingSize != frame.size()) {
+		resize(gray, image_, workingSize, 0, 0, INTER_AREA);
+	}
+	else {
+		image_ = gray.data == frame.data ? gray.clone() : gray;
 	}
 }
 
@@ -243,7 +425,14 @@ Ptr<CImage::CDetectorExtractor> CImage::createDetectorExtractor(const SProcessPa
 void CImage::process(const SProcessParams& params, Ptr<CLogger>& logger, const Ptr<CDetectorExtractor>& detectorExtractor)
 {
 	logger->log("Image with filepath: " + filePath_ + " is being processed.").endl();
-	processCLAHE(logger);
+	if (image_.size() != originalSize_) {
+		logger->log("  Working resolution: ").log(to_string(image_.cols)).log("x").log(to_string(image_.rows))
+			.log(" (original: ").log(to_string(originalSize_.width)).log("x").log(to_string(originalSize_.height)).log(")").endl();
+	}
+	if (detectorExtractor.empty()) {
+		throw invalid_argument("Method process was called with empty pointer to CDetectorExtractor");
+	}
+	processCLAHE(logger, *detectorExtractor->claheStage_);
 	detectDescribeFeatures(params, logger, detectorExtractor);
 	if (params.describeMethod_ == EAlgorithm::ALG_ROOTSIFT) {
 		fastRootSiftDescriptorsAdjust(logger);
@@ -253,6 +442,15 @@ void CImage::process(const SProcessParams& params, Ptr<CLogger>& logger, const P
 	}
 }
 
+void CImage::setFeatures(const vector<KeyPoint>& keypoints, const Mat& descriptors)
+{
+	imageKeypoints_ = keypoints;
+	keypointsDescriptors_ = descriptors;
+	quantizedDescriptors_.release();
+	packedDescriptors_.release();
+	wasProcessed_ = true;
+}
+
 const vector<KeyPoint>& CImage::getKeypoints() const
 {
 	if (!wasProcessed_) {
@@ -266,9 +464,51 @@ const Mat& CImage::getDescriptors() const
 	if (!wasProcessed_) {
 		throw logic_error("CImage - to get descriptors of the keypoints first the process function has to be called.");
 	}
+	if (hasQuantizedDescriptors()) {
+		throw logic_error("CImage - the descriptors are quantized, use the quantized descriptors instead.");
+	}
 	return keypointsDescriptors_;
 }
 
+void CImage::quantizeDescriptors()
+{
+	if (!wasProcessed_) {
+		throw logic_error("CImage - to quantize descriptors of the keypoints first the process function has to be called.");
+	}
+	if (hasQuantizedDescriptors()) {
+		return;
+	}
+	dk::quantizeDescriptors(keypointsDescriptors_, quantizedDescriptors_, descriptorsScale_);
+	keypointsDescriptors_.release();
+}
+
+void CImage::packBinaryDescriptors()
+{
+	if (!wasProcessed_) {
+		throw logic_error("CImage - to pack descriptors of the keypoints first the process function has to be called.");
+	}
+	if (hasPackedDescriptors()) {
+		return;
+	}
+	packedDescriptors_ = makePtr<CBinaryDescriptorStore>(keypointsDescriptors_);
+}
+
+const CBinaryDescriptorStore& CImage::getPackedDescriptors() const
+{
+	if (!hasPackedDescriptors()) {
+		throw logic_error("CImage - the descriptors are not packed.");
+	}
+	return *packedDescriptors_;
+}
+
+const Mat& CImage::getQuantizedDescriptors() const
+{
+	if (!hasQuantizedDescriptors()) {
+		throw logic_error("CImage - the descriptors are not quantized.");
+	}
+	return quantizedDescriptors_;
+}
+
 sm::SGcsCoords CImage::getRightBaseGc() const
 {
 	return rightBaseGc_;
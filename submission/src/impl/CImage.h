@@ -36,8 +36,13 @@
 #include "CLogger.h"
 #include "SProcessParams.h"
 #include "SGcsCoords.h"
+#include "DescriptorKernels.h"
+#include "CClaheStage.h"
+#include "CBinaryDescriptorStore.h"
 
 #include <iostream>	
+#include <fstream>
+#include <algorithm>
 
 using namespace std;
 using namespace cv;
@@ -63,6 +68,9 @@ public:
 
 		Ptr<Feature2D> detector_; ///< pointer to the detector object
 		Ptr<Feature2D> extractor_; ///< pointer to the extractor object
+		Ptr<CClaheStage> claheStage_; ///< contrast enhancement stage (it keeps its buffers between the images)
+		vector<Ptr<Feature2D>> cellDetectors_; ///< detectors of the grid cells (one for every parallel worker, empty if the grid detection is disabled)
+		int cellFeaturesLimit_ = 0; ///< features limit of the grid cell (0 means no limit)
 		/**
 		 * @brief constructor that constructs the class according to the passed parameters
 		 * @param params parameters on which base the class is being constructed
@@ -86,14 +94,25 @@ public:
 		 * @return returns the smart pointer to the detector or/and descriptor creator
 		*/
 		static Ptr<Feature2D> getDetectorExtractor(const SProcessParams& params);
+		/**
+		 * @brief computes the features limit of one grid cell
+		 * @param params params with the grid parameters and the features limit
+		 * @return the limit (0 means no limit)
+		*/
+		static int getCellFeaturesLimit(const SProcessParams& params);
 	};
 
 protected:
 	const string filePath_; ///< filepath of the image (with the image itself, relative to the place where the app is running)
-	Mat image_; ///< image data in the OpenCV matrix
+	Mat image_; ///< image data in the OpenCV matrix (in the working resolution, see the constructor)
+	Size originalSize_; ///< size of the image in the file (full resolution)
+	Point2d resolutionScale_ = Point2d(1.0, 1.0); ///< scale of the working resolution to the full resolution in both axes (working coordinate = scale * original coordinate)
 	bool wasProcessed_ = false; ///< information whether the keypoints have been detected and described
 	vector<KeyPoint> imageKeypoints_; ///< vector with the detected keypoints (it is valid when wasProcessed is set to true)
-	Mat keypointsDescriptors_; ///< descriptors of the keypoints (it is valid when wasProcessed is set to true)
+	Mat keypointsDescriptors_; ///< descriptors of the keypoints (it is valid when wasProcessed is set to true and the descriptors are not quantized)
+	Mat quantizedDescriptors_; ///< quantized descriptors of the keypoints (CV_8U, it is valid when the descriptors are quantized)
+	float descriptorsScale_ = 1.0f; ///< scale of the quantization (quantized value = round(value * scale))
+	Ptr<CBinaryDescriptorStore> packedDescriptors_; ///< binary descriptors packed for the fast Hamming matching (empty if they are not packed)
 	sm::SGcsCoords rightBaseGc_; ///< global coordinates at the right base/corner of the image (coordinates of the place at the corner)
 	sm::SGcsCoords leftBaseGc_; ///< global coordinates at the left base/corner of the image (coordinates of the place at the corner)
 
@@ -104,14 +123,26 @@ protected:
 	 * @throw invalid_argument if there the detectorExtractor is empty
 	*/
 	void detectDescribeFeatures(const SProcessParams& params, Ptr<CLogger>& logger, const Ptr<CDetectorExtractor>& detectorExtractor);
+	/**
+	 * @brief detects keypoints in the grid cells (in parallel) with the limit for every cell and then describes all of them at once
+	 *
+	 * Every cell is detected in the region extended by a margin, only the keypoints inside the cell are kept (the best ones up to the cell limit).
+	 * The keypoints are evenly spread over the image and their count is predictable.
+	 *
+	 * @param params parameters with the grid parameters
+	 * @param logger logger in which it will print information about the process
+	 * @param detectorExtractor the detector extractor object with the cell detectors
+	*/
+	void detectGridFeatures(const SProcessParams& params, Ptr<CLogger>& logger, CDetectorExtractor& detectorExtractor);
 	/**
 	 * @brief it proceses a CLAHE (Contrast Limited Adaptive Histogram Equalisation) algorithm over the image 
 	 * @param logger the logging output is printed in the logger
+	 * @param claheStage the reused contrast enhancement stage (it also may choose the global histogram equalisation, see CClaheStage)
 	*/
-	void processCLAHE(Ptr<CLogger>& logger);
+	void processCLAHE(Ptr<CLogger>& logger, CClaheStage& claheStage);
 	/**
 	 * @brief does change the inner descriptor matrix into descriptors based on Helloinger kernel
-	 * this method is precise enough
+	 * this method is precise enough (vectorised float computation, see dk::rootSiftNormalize)
 	 * @param logger the logging output is printed in the logger
 	*/
 	void fastRootSiftDescriptorsAdjust(Ptr<CLogger>& logger);
@@ -121,15 +152,46 @@ protected:
 	 * @param logger the logging output is printed in the logger
 	*/
 	void preciseRootSiftDescriptorsAdjust(Ptr<CLogger>& logger);
+	/**
+	 * @brief Reads the image size from the file header without decoding the image (JPEG and PNG are supported)
+	 * @param filePath filepath of the image
+	 * @param size the read size (not changed if the header was not recognised)
+	 * @param isJpeg set to true if the file is a JPEG image
+	 * @return true if the size was read
+	*/
+	static bool readHeaderSize(const string& filePath, Size& size, bool& isJpeg);
+	/**
+	 * @brief Loads the image in the working resolution (the longer side is at most maxResolution)
+	 *
+	 * JPEG images are decoded directly in the reduced size (IMREAD_REDUCED_GRAYSCALE_2/4/8) where possible,
+	 * the rest of the downscaling is done by the area interpolation.
+	 *
+	 * @param maxResolution maximal size of the longer side of the image in pixels (0 means the full resolution)
+	 * @throw ios_base::failure if the image can't be loaded
+	*/
+	void loadImage(int maxResolution);
 public:
 	/**
 	 * @brief Constructor (the image is loaded during the constructor run)
+	 *
+	 * The image is processed in the working resolution, all the pixel coordinates (image data, keypoints, homography) are in the working resolution.
+	 * Use getResolutionScale to convert them to the full resolution.
+	 *
 	 * @param filePath filepath of the image (with the image itself, relative to the place where the app is running)
 	 * @param rightBaseGc global coordinates at the right base/corner of the image (coordinates of the place at the corner)
 	 * @param leftBaseGc global coordinates at the left base/corner of the image (coordinates of the place at the corner)
+	 * @param maxResolution maximal size of the longer side of the working image in pixels (0 means the full resolution)
 	 * @throw ios_base::failure in case of any io failure
 	*/
-	CImage(const string& filePath, const sm::SGcsCoords& rightBaseGc, const sm::SGcsCoords& leftBaseGc);
+	CImage(const string& filePath, const sm::SGcsCoords& rightBaseGc, const sm::SGcsCoords& leftBaseGc, int maxResolution = 0);
+	/**
+	 * @brief Constructor from an already decoded frame (e.g. a video frame), the frame is converted to grayscale and downscaled to the working resolution
+	 * @param frame the frame (grayscale or BGR)
+	 * @param name name of the frame used instead of the filepath in the logs
+	 * @param maxResolution maximal size of the longer side of the working image in pixels (0 means the full resolution)
+	 * @throw ios_base::failure if the frame is empty
+	*/
+	CImage(const Mat& frame, const string& name, int maxResolution = 0);
 	/**
 	 * @brief method that creates nested class object that is neede for the image to be processed (the object can be used for infinite amount of CImage classes)
 	 * @param params parameters that determine which algorithms would be used to detect features and which one used to describe them
@@ -144,6 +206,17 @@ public:
 	 * @throw invalid_argument if there the detectorExtractor is empty
 	*/
 	void process(const SProcessParams& params, Ptr<CLogger>& logger, const Ptr<CDetectorExtractor>& detectorExtractor);
+	/**
+	 * @brief sets already computed keypoints and descriptors (e.g. loaded from the descriptor cache), the image is then considered processed
+	 * @param keypoints the keypoints
+	 * @param descriptors descriptors of the keypoints (one row for every keypoint)
+	*/
+	void setFeatures(const vector<KeyPoint>& keypoints, const Mat& descriptors);
+	/**
+	 * @brief Gives information whether the keypoints have been detected and described (or set)
+	 * @return true if the keypoints and descriptors are valid
+	*/
+	bool wasProcessed() const { return wasProcessed_; }
 	/**
 	 * @brief Gives relative filepath of the image (with the image name itself)
 	 * @return the filepath
@@ -154,6 +227,16 @@ public:
 	 * @return the image data in OpenCV format (matrix)
 	*/
 	const Mat& getImage() const { return image_; }
+	/**
+	 * @brief Gives the size of the image in the file (full resolution)
+	 * @return the size
+	*/
+	const Size& getOriginalSize() const { return originalSize_; }
+	/**
+	 * @brief Gives the scale of the working resolution to the full resolution (working coordinate = scale * original coordinate)
+	 * @return the scale in both axes (it is 1.0 if the image is processed in the full resolution)
+	*/
+	const Point2d& getResolutionScale() const { return resolutionScale_; }
 	/**
 	 * @brief Gives keypoints
 	 * @return vector of keypoints
@@ -166,6 +249,45 @@ public:
 	 * @throw logic_error message: "CImage - to get descriptors of the keypoints first the process function has to be called."
 	*/
 	const Mat& getDescriptors() const;
+	/**
+	 * @brief Replaces the float descriptors (SIFT, RootSIFT) by the quantized ones (CV_8U, 4x less memory), the float descriptors are released
+	 * @throw logic_error if the image was not processed yet
+	 * @throw invalid_argument if the descriptors are not float descriptors
+	*/
+	void quantizeDescriptors();
+	/**
+	 * @brief Gives information whether the descriptors are quantized
+	 * @return true if only the quantized descriptors are available
+	*/
+	bool hasQuantizedDescriptors() const { return !quantizedDescriptors_.empty(); }
+	/**
+	 * @brief Gives the quantized descriptors of the image keypoints
+	 * @return quantized descriptors (CV_8U matrix)
+	 * @throw logic_error if the descriptors are not quantized
+	*/
+	const Mat& getQuantizedDescriptors() const;
+	/**
+	 * @brief Gives the scale of the quantized descriptors (quantized value = round(value * scale))
+	 * @return the scale
+	*/
+	float getDescriptorsScale() const { return descriptorsScale_; }
+	/**
+	 * @brief Packs the binary descriptors (ORB, BEBLID) into the aligned 64 bit words store for the fast Hamming matching (the descriptors matrix is kept)
+	 * @throw logic_error if the image was not processed yet
+	 * @throw invalid_argument if the descriptors are not binary descriptors
+	*/
+	void packBinaryDescriptors();
+	/**
+	 * @brief Gives information whether the binary descriptors are packed
+	 * @return true if the packed descriptors are available
+	*/
+	bool hasPackedDescriptors() const { return !packedDescriptors_.empty(); }
+	/**
+	 * @brief Gives the packed binary descriptors
+	 * @return the packed descriptors store
+	 * @throw logic_error if the descriptors are not packed
+	*/
+	const CBinaryDescriptorStore& getPackedDescriptors() const;
 	/**
 	 * @brief get global coordinates at the right base/corner of the image (coordinates of the place at the corner)
 	 * @return the coordinates
@@ -25,7 +25,13 @@ Ptr<CImage> CImageBuilder::build(const string& imageFilePath, const SProcessPara
     }
 
     Ptr<CImage> ret = new CImage(imageFilePath,
-        sm::SGcsCoords(rightLongtitude, rightLatitude), sm::SGcsCoords(leftLongtitude, leftlatitude));
+        sm::SGcsCoords(rightLongtitude, rightLatitude), sm::SGcsCoords(leftLongtitude, leftlatitude),
+        sceneImage ? params.resolutionParams_.maxSceneResolution_ : params.resolutionParams_.maxReferenceResolution_);
+
+    //references never change so their features can be reused from the previous runs
+    if (!sceneImage && !descriptorCache_.empty()) {
+        descriptorCache_->load(*ret, logger);
+    }
 
     return ret;
 }
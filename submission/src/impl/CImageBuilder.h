@@ -22,6 +22,7 @@ namespace pt = boost::property_tree;
 #include <opencv2/imgcodecs.hpp>
 
 #include "CImage.h"
+#include "CDescriptorCache.h"
 #include "SGcsCoords.h"
 #include "SProcessParams.h"
 #include "SpecializedInputOutput.h"
@@ -31,11 +32,18 @@ namespace pt = boost::property_tree;
  * @brief Class that correctly builds the CImage objects
  * 
  *  It loads geolocation informations (image data are specificaly loaded by the CImage class)
+ *  If the descriptor cache is given, the keypoints and descriptors of the reference images are loaded from it.
  * 
 */
 class CImageBuilder
 {
+    Ptr<CDescriptorCache> descriptorCache_; ///< cache of the reference images features (can be empty, then nothing is loaded)
 public:
+    /**
+     * @brief Constructor
+     * @param descriptorCache cache of the reference images features (empty pointer disables the cache)
+    */
+    CImageBuilder(const Ptr<CDescriptorCache>& descriptorCache = Ptr<CDescriptorCache>()) : descriptorCache_(descriptorCache) {}
     /**
      * @brief Method that builds the CImage
      * @param imageFilePath filepath to the image relative to the place where it runs 
@@ -45,7 +53,7 @@ public:
      * @param params parameters that determine which algorithms would be passed to the CImage. See the notes of the CImage constructor on that topic!
      * @param sceneImage information whether the image to be constructed is going to be a scene image or not
      * @param logger logger in which it will print information about the process
-     * @return smart OpenCV pointer to the newly constructed CImage
+     * @return smart OpenCV pointer to the newly constructed CImage (reference image can be already processed if it was loaded from the cache)
      * @throw ios_base::failure in case of any io failure
     */
     Ptr<CImage> build(const string& imageFilePath, const SProcessParams& params, bool sceneImage, Ptr<CLogger>& logger);
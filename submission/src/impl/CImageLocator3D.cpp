@@ -2,8 +2,9 @@
 
 void CImageLocator3D::createCameraIntrinsicsMatrix(const SCameraInfo& cameraInfo)
 {
-	double width = sceneImage_->getImage().cols;		// image size
-	double height = sceneImage_->getImage().rows;        // image size
+	//image size in the working resolution (the exact scaled size of the full resolution image, the reduced decoding rounds the size)
+	double width = sceneImage_->getOriginalSize().width * sceneImage_->getResolutionScale().x;
+	double height = sceneImage_->getOriginalSize().height * sceneImage_->getResolutionScale().y;
 	double sx, sy; //sizes of chip in both axes  = 3.79, sy = 4.96;             // sensor size  - 4.96 x 3.72 mm) 	
 	//check if the rotation isnt broken and assign the right side size of chip to right dimension of image
 	if (width < height) {
@@ -21,78 +22,81 @@ void CImageLocator3D::createCameraIntrinsicsMatrix(const SCameraInfo& cameraInfo
 	double cy = height / 2; // cy
 
 
-	cameraIntrinsicsMatrixA_ = Mat::zeros(3, 3, CV_64FC1); // intrinsic camera parameters
-
-	cameraIntrinsicsMatrixA_.at<double>(0, 0) = fx;       //      [ fx   0  cx ]
-	cameraIntrinsicsMatrixA_.at<double>(1, 1) = fy;       //      [  0  fy  cy ]
-	cameraIntrinsicsMatrixA_.at<double>(0, 2) = cx;       //      [  0   0   1 ]
-	cameraIntrinsicsMatrixA_.at<double>(1, 2) = cy;
-	cameraIntrinsicsMatrixA_.at<double>(2, 2) = 1;
+	// intrinsic camera parameters
+	cameraIntrinsicsMatrixA_ = Matx33d(
+		fx, 0.0, cx,
+		0.0, fy, cy,
+		0.0, 0.0, 1.0);
 }
 
 void CImageLocator3D::createTransformationMatrices()
 {
-
-	//rotation matrix, RMatrix_
-	//converting rotation vector to the rotation matrix
-	Rodrigues(RVec_, RMatrix_);
-
-	//Filling the RTMatrix_
-	//copy rotation from RMatrix_ to RTMatrix_
-	RTMatrix_.at<double>(0, 0) = RMatrix_.at<double>(0, 0);
-	RTMatrix_.at<double>(0, 1) = RMatrix_.at<double>(0, 1);
-	RTMatrix_.at<double>(0, 2) = RMatrix_.at<double>(0, 2);
-	RTMatrix_.at<double>(1, 0) = RMatrix_.at<double>(1, 0);
-	RTMatrix_.at<double>(1, 1) = RMatrix_.at<double>(1, 1);
-	RTMatrix_.at<double>(1, 2) = RMatrix_.at<double>(1, 2);
-	RTMatrix_.at<double>(2, 0) = RMatrix_.at<double>(2, 0);
-	RTMatrix_.at<double>(2, 1) = RMatrix_.at<double>(2, 1);
-	RTMatrix_.at<double>(2, 2) = RMatrix_.at<double>(2, 2);
-
-	//copy translation
-	RTMatrix_.at<double>(0, 3) = TVec_.at<double>(0);
-	RTMatrix_.at<double>(1, 3) = TVec_.at<double>(1);
-	RTMatrix_.at<double>(2, 3) = TVec_.at<double>(2);
-
-	//fill bottom row of RTMatrix_
-	RTMatrix_.at<double>(3, 3) = 1.0;
+	//Filling the RTMatrix_ - rotation from RMatrix_, translation from TVec_ and the bottom row (0, 0, 0, 1)
+	RTMatrix_ = Matx44d(
+		RMatrix_(0, 0), RMatrix_(0, 1), RMatrix_(0, 2), TVec_[0],
+		RMatrix_(1, 0), RMatrix_(1, 1), RMatrix_(1, 2), TVec_[1],
+		RMatrix_(2, 0), RMatrix_(2, 1), RMatrix_(2, 2), TVec_[2],
+		0.0, 0.0, 0.0, 1.0);
 
 	//worldToImageProjectionMat_
-	Mat A = cameraIntrinsicsMatrixA_;
-	Mat superiorAMatrix = (Mat_<double>(3, 4) << A.at<double>(0, 0), A.at<double>(0, 1), A.at<double>(0, 2), 0.0,
-		A.at<double>(1, 0), A.at<double>(1, 1), A.at<double>(1, 2), 0.0,
-		A.at<double>(2, 0), A.at<double>(2, 1), A.at<double>(2, 2), 0.0);
+	const Matx33d& A = cameraIntrinsicsMatrixA_;
+	Matx34d superiorAMatrix(
+		A(0, 0), A(0, 1), A(0, 2), 0.0,
+		A(1, 0), A(1, 1), A(1, 2), 0.0,
+		A(2, 0), A(2, 1), A(2, 2), 0.0);
 	worldToImageProjectionMat_ = superiorAMatrix * RTMatrix_;
 }
 
-Mat CImageLocator3D::projectCameraSpacetoImage(const Mat& toProject) const
+void CImageLocator3D::solvePoseIterative(const vector<Point3d>& objCorners3D, const vector<Point2d>& sceneCorners, Vec3d& rVec, Vec3d& tVec) const
+{
+	//the distortion is not considered (empty distortion coefficients)
+	//the second run uses the provided rVec and tVec values as initial approximations of the rotation and translation vectors
+	solvePnP(objCorners3D, sceneCorners, cameraIntrinsicsMatrixA_, noArray(), rVec, tVec, false, SOLVEPNP_ITERATIVE);
+	solvePnP(objCorners3D, sceneCorners, cameraIntrinsicsMatrixA_, noArray(), rVec, tVec, true, SOLVEPNP_ITERATIVE);
+}
+
+bool CImageLocator3D::solvePoseIppe(const vector<Point3d>& objCorners3D, const vector<Point2d>& sceneCorners, bool refine, pp::SPlanarPose& pose) const
 {
-	Mat takeFirstThree = Mat::zeros(3, 4, CV_64FC1);
-	takeFirstThree.at<double>(0, 0) = 1.0;
-	takeFirstThree.at<double>(1, 1) = 1.0;
-	takeFirstThree.at<double>(2, 2) = 1.0;
+	array<Point2d, pp::PLANAR_POSE_POINTS> objectPoints, imagePoints;
+	for (int i = 0; i < pp::PLANAR_POSE_POINTS; ++i) {
+		objectPoints[i] = Point2d(objCorners3D[i].x, objCorners3D[i].y);
+		imagePoints[i] = sceneCorners[i];
+	}
+	//all the corners are on the plane z = 1 (see calcLocation)
+	return pp::solvePlanarPose(objectPoints, objCorners3D[0].z, imagePoints, cameraIntrinsicsMatrixA_, refine, pose);
+}
+
+void CImageLocator3D::solvePose(const vector<Point3d>& objCorners3D, const vector<Point2d>& sceneCorners, Ptr<CLogger>& logger)
+{
+	if (params_.poseParams_.solver_ == EPoseSolver::IPPE) {
+		pp::SPlanarPose pose;
+		if (solvePoseIppe(objCorners3D, sceneCorners, params_.poseParams_.refine_, pose)) {
+			RMatrix_ = pose.R_;
+			RVec_ = pp::rotationMatrixToVector(pose.R_);
+			TVec_ = pose.t_;
+			return;
+		}
+		logger->log("IPPE pose solver failed (degenerated corners), the iterative solver is used.").endl();
+	}
+	solvePoseIterative(objCorners3D, sceneCorners, RVec_, TVec_);
+	RMatrix_ = pp::rotationVectorToMatrix(RVec_);
+}
 
-	Mat point2Dtmp = cameraIntrinsicsMatrixA_ * takeFirstThree * toProject;
+Point2d CImageLocator3D::projectCameraSpacetoImage(const Vec4d& toProject) const
+{
+	Vec3d point2Dtmp = cameraIntrinsicsMatrixA_ * Vec3d(toProject[0], toProject[1], toProject[2]);
 	
 	//normalize
-	Mat point2DNorm = Mat::zeros(2, 1, CV_64FC1);
-	point2DNorm.at<double>(0) = point2Dtmp.at<double>(0) / point2Dtmp.at<double>(2);
-	point2DNorm.at<double>(1) = point2Dtmp.at<double>(1) / point2Dtmp.at<double>(2);
-	
-	return point2DNorm;
+	return Point2d(point2Dtmp[0] / point2Dtmp[2], point2Dtmp[1] / point2Dtmp[2]);
 }
 
-Mat CImageLocator3D::projectWorldSpacetoImage(const Mat& toProject) const
+Point2d CImageLocator3D::projectWorldSpacetoImage(const Vec4d& toProject) const
 {
 	//project the point
-	Mat point2Dtmp = worldToImageProjectionMat_ * toProject;
+	Vec3d point2Dtmp = worldToImageProjectionMat_ * toProject;
 
 	//normalize
-	Mat point2DNorm = Mat::zeros(2, 1, CV_64FC1);
-	point2DNorm.at<double>(0) = point2Dtmp.at<double>(0) / point2Dtmp.at<double>(2);
-	point2DNorm.at<double>(1) = point2Dtmp.at<double>(1) / point2Dtmp.at<double>(2);
-	
-	return point2DNorm;
+	return Point2d(point2Dtmp[0] / point2Dtmp[2], point2Dtmp[1] / point2Dtmp[2]);
 }
 
 void CImageLocator3D::projectBuildingDraftIntoScene(const vector<Point3d>& objCorners3D, Ptr<CLogger>& logger) const
@@ -100,21 +104,20 @@ void CImageLocator3D::projectBuildingDraftIntoScene(const vector<Point3d>& objCo
 	//just creating some depth in same scale as the object image
 	double depthGuess = sm::distance(objCorners3D[0].x, objCorners3D[0].y, objCorners3D[1].x, objCorners3D[1].y);
 
-	vector<Mat> objectPrismDummy3D(8);
-	objectPrismDummy3D[0] = (Mat_<double>(4, 1) << objCorners3D[0].x, objCorners3D[0].y, objCorners3D[0].z, 1.0);
-	objectPrismDummy3D[1] = (Mat_<double>(4, 1) << objCorners3D[1].x, objCorners3D[1].y, objCorners3D[1].z, 1.0);
-	objectPrismDummy3D[2] = (Mat_<double>(4, 1) << objCorners3D[2].x, objCorners3D[2].y, objCorners3D[2].z, 1.0);
-	objectPrismDummy3D[3] = (Mat_<double>(4, 1) << objCorners3D[3].x, objCorners3D[3].y, objCorners3D[3].z, 1.0);
+	array<Vec4d, 8> objectPrismDummy3D;
+	objectPrismDummy3D[0] = Vec4d(objCorners3D[0].x, objCorners3D[0].y, objCorners3D[0].z, 1.0);
+	objectPrismDummy3D[1] = Vec4d(objCorners3D[1].x, objCorners3D[1].y, objCorners3D[1].z, 1.0);
+	objectPrismDummy3D[2] = Vec4d(objCorners3D[2].x, objCorners3D[2].y, objCorners3D[2].z, 1.0);
+	objectPrismDummy3D[3] = Vec4d(objCorners3D[3].x, objCorners3D[3].y, objCorners3D[3].z, 1.0);
 
-	objectPrismDummy3D[4] = (Mat_<double>(4, 1) << objCorners3D[0].x, objCorners3D[0].y, objCorners3D[0].z + depthGuess, 1.0);
-	objectPrismDummy3D[5] = (Mat_<double>(4, 1) << objCorners3D[1].x, objCorners3D[1].y, objCorners3D[1].z + depthGuess, 1.0);
-	objectPrismDummy3D[6] = (Mat_<double>(4, 1) << objCorners3D[2].x, objCorners3D[2].y, objCorners3D[2].z + depthGuess, 1.0);
-	objectPrismDummy3D[7] = (Mat_<double>(4, 1) << objCorners3D[3].x, objCorners3D[3].y, objCorners3D[3].z + depthGuess, 1.0);
+	objectPrismDummy3D[4] = Vec4d(objCorners3D[0].x, objCorners3D[0].y, objCorners3D[0].z + depthGuess, 1.0);
+	objectPrismDummy3D[5] = Vec4d(objCorners3D[1].x, objCorners3D[1].y, objCorners3D[1].z + depthGuess, 1.0);
+	objectPrismDummy3D[6] = Vec4d(objCorners3D[2].x, objCorners3D[2].y, objCorners3D[2].z + depthGuess, 1.0);
+	objectPrismDummy3D[7] = Vec4d(objCorners3D[3].x, objCorners3D[3].y, objCorners3D[3].z + depthGuess, 1.0);
 
 	vector<Point2d> objectDummyProjected(8);
-	for (int i = 0; i < objectPrismDummy3D.size(); ++i) {
-		Mat projected = projectWorldSpacetoImage(objectPrismDummy3D[i]);
-		objectDummyProjected[i] = Point2d(projected.at<double>(0), projected.at<double>(1));
+	for (size_t i = 0; i < objectPrismDummy3D.size(); ++i) {
+		objectDummyProjected[i] = projectWorldSpacetoImage(objectPrismDummy3D[i]);
 	}
 
 	//-- Draw the prism dummy wireframe
@@ -153,15 +156,15 @@ void CImageLocator3D::projectBuildingDraftIntoScene(const vector<Point3d>& objCo
 
 }
 
-Mat CImageLocator3D::getCorrectionMatrixForTheCameraLocalSpace(const Mat& p1HomVec, const Mat& p2HomVec, const Mat& p3HomVec,
+Matx44d CImageLocator3D::getCorrectionMatrixForTheCameraLocalSpace(const Vec4d& p1HomVec, const Vec4d& p2HomVec, const Vec4d& p3HomVec,
  const sm::SGcsCoords& gcsP2, const sm::SGcsCoords& gcsP3, Ptr<CLogger>& logger)
 {
 	//converting points from (x,y,z,1) to (x,y,z)
-	Mat p1Vec = p1HomVec(Range(0, 3), Range(0, 1));
-	Mat p2Vec = p2HomVec(Range(0, 3), Range(0, 1));
-	Mat p3Vec = p3HomVec(Range(0, 3), Range(0, 1));
+	Vec3d p1Vec(p1HomVec[0], p1HomVec[1], p1HomVec[2]);
+	Vec3d p2Vec(p2HomVec[0], p2HomVec[1], p2HomVec[2]);
+	Vec3d p3Vec(p3HomVec[0], p3HomVec[1], p3HomVec[2]);
 
-	Mat standingPoint = Mat::zeros(3, 1, CV_64FC1);
+	Vec3d standingPoint(0.0, 0.0, 0.0);
 
 	//scene geometry straithening to be perpendicular with the ground (good on flat grounds and buidlings where the geomtry is clear)
 	//following description is a description of params_.considerPhoneHoldHeight_ in process params that comes from CONSIDER_PHONE_HOLD_HEIGHT from parameters.h
@@ -175,8 +178,7 @@ Mat CImageLocator3D::getCorrectionMatrixForTheCameraLocalSpace(const Mat& p1HomV
 
 		double gcsDistance = sm::gcsDistance(gcsP2, gcsP3);
 		//calculate distance in our space
-		double distance = sm::distance(p2Vec.at<double>(0), p2Vec.at<double>(1), p2Vec.at<double>(2),
-			p3Vec.at<double>(0), p3Vec.at<double>(1), p3Vec.at<double>(2));
+		double distance = sm::distance(p2Vec, p3Vec);
 		double distScaleFactor = distance / gcsDistance; //how much units is one meter in our 
 		//logger->log("gcsDistance").log(to_string(gcsDistance)).endl();
 		//logger->log("our distance").log(to_string(distance)).endl();
@@ -185,41 +187,18 @@ Mat CImageLocator3D::getCorrectionMatrixForTheCameraLocalSpace(const Mat& p1HomV
 
 		//get down vector from the building information
 		//the down vector is then scaled according to the length
-		Mat downVector = p2Vec - p1Vec;
-		normalize(downVector, downVector);
-		standingPoint.at<double>(0) = /*origin + */ downVector.at<double>(0) * lenghtInCameraSpaceUnits;
-		standingPoint.at<double>(1) = /*origin + */ downVector.at<double>(1) * lenghtInCameraSpaceUnits;
-		standingPoint.at<double>(2) = /*origin + */ downVector.at<double>(2) * lenghtInCameraSpaceUnits;
+		Vec3d downVector = normalize(p2Vec - p1Vec);
+		standingPoint = /*origin + */ downVector * lenghtInCameraSpaceUnits;
 	}
 
 	//find real place where the guy has his legs
-	Mat vecStandingPointTo3 = p3Vec - standingPoint;//vecStandingPointTo3 is updated z coordinate
-	normalize(vecStandingPointTo3, vecStandingPointTo3);
-	Mat vecStandingPointTo2 = p2Vec - standingPoint;
-	normalize(vecStandingPointTo2, vecStandingPointTo2);
-	Mat vecUp = vecStandingPointTo3.cross(vecStandingPointTo2); //vecUp is updated y coordinate
-	normalize(vecUp, vecUp);
-	Mat right = vecUp.cross(vecStandingPointTo3); //right is updated x coordinate
-	normalize(right, right);
-
-	//create change basis matrix
-	Mat changeBasis = Mat::zeros(4, 4, CV_64FC1);
-	//x basis vector
-	changeBasis.at<double>(0, 0) = right.at<double>(0);
-	changeBasis.at<double>(1, 0) = right.at<double>(1);
-	changeBasis.at<double>(2, 0) = right.at<double>(2);
-	//y basis vector
-	changeBasis.at<double>(0, 1) = vecUp.at<double>(0);
-	changeBasis.at<double>(1, 1) = vecUp.at<double>(1);
-	changeBasis.at<double>(2, 1) = vecUp.at<double>(2);
-	//z basis vector
-	changeBasis.at<double>(0, 2) = vecStandingPointTo3.at<double>(0);
-	changeBasis.at<double>(1, 2) = vecStandingPointTo3.at<double>(1);
-	changeBasis.at<double>(2, 2) = vecStandingPointTo3.at<double>(2);
-	//right bottom one
-	changeBasis.at<double>(3, 3) = 1;
-
-	return changeBasis.inv();
+	Vec3d vecStandingPointTo3 = normalize(p3Vec - standingPoint);//vecStandingPointTo3 is updated z coordinate
+	Vec3d vecStandingPointTo2 = normalize(p2Vec - standingPoint);
+	Vec3d vecUp = normalize(vecStandingPointTo3.cross(vecStandingPointTo2)); //vecUp is updated y coordinate
+	Vec3d right = normalize(vecUp.cross(vecStandingPointTo3)); //right is updated x coordinate
+
+	//inverse of the change basis matrix (x basis vector, y basis vector, z basis vector), the basis is orthonormal
+	return sm::toOrthonormalBasis(right, vecUp, vecStandingPointTo3);
 }
 
 double CImageLocator3D::computeFlatRotation(const sm::SGcsCoords& gcsCamera, const sm::SGcsCoords& gcsP2, const sm::SGcsCoords& gcsP3)
@@ -236,16 +215,10 @@ double CImageLocator3D::computeFlatRotation(const sm::SGcsCoords& gcsCamera, con
 void CImageLocator3D::gcsLocatingProblemFrom3Dto2D(vector<Point3d> objCorners3D, vector<Point2d>& sceneCorners, 
 	const sm::SGcsCoords& gcsPoint2, const sm::SGcsCoords& gcsPoint3, Point2d& p2Out, Point2d& p3Out, Ptr<CLogger>& logger)
 {
-	//converting points to homogenous coordinates so they can be transformed
-	vector<Mat> objCornersHomVec3D(4);
+	//converting points to homogenous coordinates so they can be transformed and getting the corners in camera space
+	array<Vec4d, 4> objCornersCameraSpaceHomVec;
 	for (size_t i = 0; i < 4; ++i) {
-		objCornersHomVec3D[i] = sm::getHomogenousVector3D(objCorners3D[i].x, objCorners3D[i].y, objCorners3D[i].z);
-	}
-
-	//get the corners in camera space
-	std::vector<Mat> objCornersCameraSpaceHomVec(4);
-	for (size_t i = 0; i < 4; ++i) {
-		objCornersCameraSpaceHomVec[i] = RTMatrix_ * objCornersHomVec3D[i];
+		objCornersCameraSpaceHomVec[i] = RTMatrix_ * Vec4d(objCorners3D[i].x, objCorners3D[i].y, objCorners3D[i].z, 1.0);
 	}
 
 	////PRINT THE RESULT I GOT
@@ -266,23 +239,23 @@ void CImageLocator3D::gcsLocatingProblemFrom3Dto2D(vector<Point3d> objCorners3D,
 	//}
 
 	//correcting the points with calculating the right rotation (rotating the world to match the flat ground in one axis - the ground is flat then) 
-	Mat correctionMatrix = getCorrectionMatrixForTheCameraLocalSpace(
+	Matx44d correctionMatrix = getCorrectionMatrixForTheCameraLocalSpace(
 		objCornersCameraSpaceHomVec[1], objCornersCameraSpaceHomVec[2], objCornersCameraSpaceHomVec[3], gcsPoint2, gcsPoint3, logger);
 
 	//ignoring the y axis to gain only the 2d coordinates
-	Mat objCornerOnPlaneVec2 = correctionMatrix * objCornersCameraSpaceHomVec[2];
-	Mat objCornerOnPlaneVec3 = correctionMatrix * objCornersCameraSpaceHomVec[3];
+	Vec4d objCornerOnPlaneVec2 = correctionMatrix * objCornersCameraSpaceHomVec[2];
+	Vec4d objCornerOnPlaneVec3 = correctionMatrix * objCornersCameraSpaceHomVec[3];
 
 	// (x,y,z, w) -> (x, z) and renaming to (x, y)
-	p2Out = Point2d(objCornerOnPlaneVec2.at<double>(0), objCornerOnPlaneVec2.at<double>(2));
-	p3Out = Point2d(objCornerOnPlaneVec3.at<double>(0), objCornerOnPlaneVec3.at<double>(2));
+	p2Out = Point2d(objCornerOnPlaneVec2[0], objCornerOnPlaneVec2[2]);
+	p3Out = Point2d(objCornerOnPlaneVec3[0], objCornerOnPlaneVec3[2]);
 
 	//logger->log("changeBasis").endl().log(correctionMatrix).endl();
 	//logger->log("New basis point two").endl().log(objCornerOnPlaneVec2).endl();
 	//logger->log("New basis point three").endl().log(objCornerOnPlaneVec3).endl();
 }
 
-void CImageLocator3D::calcLocation(vector<Point2d>& obj_corners, vector<Point2d>& sceneCorners, Ptr<CLogger>& logger)
+void CImageLocator3D::calcLocation(vector<Point2d>& obj_corners, vector<Point2d>& sceneCorners, Ptr<CLogger>& logger, bool drawProjection)
 {
 	//inspiration for this code was taken from this OpenCV tutorial https://docs.opencv.org/master/dc/d2c/tutorial_real_time_pose.html
 
@@ -292,16 +265,6 @@ void CImageLocator3D::calcLocation(vector<Point2d>& obj_corners, vector<Point2d>
 	sm::SGcsCoords gcsPoint2 =  objectImage_->getRightBaseGc();
 	sm::SGcsCoords gcsPoint3 =  objectImage_->getLeftBaseGc();
 
-	//initiating the matrices by zero values and correct size
-	RMatrix_ = Mat::zeros(3, 3, CV_64FC1); // rotation matrix
-	RTMatrix_ = Mat::zeros(4, 4, CV_64FC1); // rotation-translation matrix
-	TVec_ = cv::Mat::zeros(3, 1, CV_64FC1);          // output translation vector
-	RVec_ = cv::Mat::zeros(3, 1, CV_64FC1);          // output rotation vector
-	distCoeffs_ = cv::Mat::zeros(4, 1, CV_64FC1);    // vector of distortion coefficients - setting to zero distortion
-
-	bool useExtrinsicGuess = false;   // if true the function uses the provided RVec_ and TVec_ values as
-								  // initial approximations of the rotation and translation vectors
-
 	//creating a plane in the 3D space - image visualising a facade of a building (probably building)
 	//the plane is then placed in the positive Z direction -> (x, y, 1.0) <- not a homogenous coordinate
 	//do the 3d corners - 3d points to PnP have to have 3x1 format
@@ -316,22 +279,20 @@ void CImageLocator3D::calcLocation(vector<Point2d>& obj_corners, vector<Point2d>
 		logger->log(objCorners3D[i]).endl();
 	}
 
-	//solve our PnP problem
-	//3d points to PnP have to have 3x1 format
-	solvePnP(objCorners3D, sceneCorners, cameraIntrinsicsMatrixA_, distCoeffs_, RVec_, TVec_, useExtrinsicGuess, SOLVEPNP_ITERATIVE);
-	solvePnP(objCorners3D, sceneCorners, cameraIntrinsicsMatrixA_, distCoeffs_, RVec_, TVec_, true, SOLVEPNP_ITERATIVE);
+	//solve our PnP problem (the solver is chosen by the parameters)
+	solvePose(objCorners3D, sceneCorners, logger);
 
-	//processing the output from solvePnP to inner matries
+	//processing the output from the solver to inner matries
 	createTransformationMatrices();
 
 	//display the dummy prism into the scene to visualise the understood perspective and volume
-	if (params_.calcProjectionFrom3D_) {
+	if (params_.calcProjectionFrom3D_ && drawProjection) {
 		projectBuildingDraftIntoScene(objCorners3D, logger);
 	}
 
 	//logger->log("RVec_: ").log(RVec_).endl();
 	//logger->log("TVec_: ").log(TVec_).endl();
-	logger->log("RTMatrix_: ").endl().log(RTMatrix_).endl();
+	logger->log("RTMatrix_: ").endl().log(Mat(RTMatrix_, false)).endl();
 
 	projectionProcessed_ = true;
 	if (!params_.calcGCSLocation_) {
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <iostream>
 //max/min function
 #include <algorithm>
@@ -31,6 +32,7 @@
 #include "CLogger.h"
 #include "CImage.h"
 #include "SpaceModule.h"
+#include "PlanarPose.h"
 #include "SProcessParams.h"
 #include "parameters.h"
 
@@ -47,13 +49,12 @@ class CImageLocator3D
 {
     Ptr<CImage> sceneImage_; ///< scene image (image data)
     Ptr<CImage> objectImage_; ///< reference image (image data)
-    Mat RTMatrix_; ///< rotation-translation matrix - from world space to local camera space
-    Mat RMatrix_; ///< rotation part of the RTMatrix_
-    Mat TVec_; ///< translation part of the RTMatrix_
-    Mat RVec_; ///< rotation (RMatrix_) in a vector form (can be transformed from matrix by using OpenCV function Rodrigues and vice versa)
-    Mat distCoeffs_; ///< distortion coefficients of the scene image
-    Mat cameraIntrinsicsMatrixA_; ///< camera intrinsinc parameters matrix created by createCameraIntrinsicsMatrix
-    Mat worldToImageProjectionMat_; ///< matrix that projects given point in world space to the image 
+    Matx44d RTMatrix_; ///< rotation-translation matrix - from world space to local camera space
+    Matx33d RMatrix_; ///< rotation part of the RTMatrix_
+    Vec3d TVec_; ///< translation part of the RTMatrix_
+    Vec3d RVec_; ///< rotation (RMatrix_) in a vector form (can be transformed from matrix by using OpenCV function Rodrigues and vice versa)
+    Matx33d cameraIntrinsicsMatrixA_; ///< camera intrinsinc parameters matrix created by createCameraIntrinsicsMatrix
+    Matx34d worldToImageProjectionMat_; ///< matrix that projects given point in world space to the image 
     const SProcessParams params_; ///< used processing parameters
     sm::SGcsCoords cameraGcsLoc_; ///< "GPS" location of the camera
     Quatd flatGroundObjRotationFromEast_; ///< rotation around y axis (quaternion)
@@ -71,28 +72,55 @@ class CImageLocator3D
     /**
      * @brief Creates all needed matrices from the rotation, translation
      *
-     * creates (fills in) RTMatrix_ and worldToImageProjectionMat_
+     * creates (fills in) RTMatrix_ and worldToImageProjectionMat_ from RMatrix_ and TVec_
      * 
     */
     void createTransformationMatrices();
+    /**
+     * @brief Solves the pose by solvePnP with SOLVEPNP_ITERATIVE (the second run starts from the result of the first one)
+     * @param objCorners3D 3D reference image corners (0, 0, 1), (w, 0, 1), (w, h, 1), (0, h, 1)
+     * @param sceneCorners 2D projections of the corners in the scene image
+     * @param rVec output rotation vector
+     * @param tVec output translation vector
+    */
+    void solvePoseIterative(const vector<Point3d>& objCorners3D, const vector<Point2d>& sceneCorners, Vec3d& rVec, Vec3d& tVec) const;
+    /**
+     * @brief Solves the pose by the closed-form planar solver IPPE (see PlanarPose.h)
+     * @param objCorners3D 3D reference image corners (0, 0, 1), (w, 0, 1), (w, h, 1), (0, h, 1)
+     * @param sceneCorners 2D projections of the corners in the scene image
+     * @param refine whether one Gauss-Newton step refines the pose
+     * @param pose output pose
+     * @return false if the corners are degenerated
+    */
+    bool solvePoseIppe(const vector<Point3d>& objCorners3D, const vector<Point2d>& sceneCorners, bool refine, pp::SPlanarPose& pose) const;
+    /**
+     * @brief Solves the pose by the solver chosen in the parameters, it fills RVec_, TVec_ and RMatrix_
+     * 
+     * The iterative solver is used when the IPPE solver fails.
+     * 
+     * @param objCorners3D 3D reference image corners (0, 0, 1), (w, 0, 1), (w, h, 1), (0, h, 1)
+     * @param sceneCorners 2D projections of the corners in the scene image
+     * @param logger into which is the optional processing info logged
+    */
+    void solvePose(const vector<Point3d>& objCorners3D, const vector<Point2d>& sceneCorners, Ptr<CLogger>& logger);
     /**
      * @brief Method that projects given point in camera local space to the image
      *
      * the needed matrix cameraIntrinsicsMatrixA_ is calculated in the class constructing process in method createCameraIntrinsicsMatrix
      *
-     * @param toProject point to be projected in homogenous coordinates (size 4x1 - column vector)
-     * @return the projected point (2x1 row matrix)
+     * @param toProject point to be projected in homogenous coordinates
+     * @return the projected point
     */
-    Mat projectCameraSpacetoImage(const Mat& toProject) const;
+    Point2d projectCameraSpacetoImage(const Vec4d& toProject) const;
     /**
      * @brief Method that projects given point in world space to the image 
      * 
      * worldToImageProjectionMat_ has to be computed by the time it is called (createTransformationMatrices method creates it)
      * 
-     * @param toProject point to be projected in homogenous coordinates (size 4x1 - column vector)
-     * @return the projected point (2x1 row matrix)
+     * @param toProject point to be projected in homogenous coordinates
+     * @return the projected point
     */
-    Mat projectWorldSpacetoImage(const Mat& toProject) const;
+    Point2d projectWorldSpacetoImage(const Vec4d& toProject) const;
     /**
      * @brief It projects the building volume (guessed, because we dont know the depth) into the screan
      * 
@@ -107,7 +135,7 @@ class CImageLocator3D
      * 
      * it is the inner parameter in params_ set so the standing person optimalisation solution is included in the correction matrix
      * 
-     * 3d points have to be in 4x1 format (homogenous coordinates)
+     * 3d points have to be in homogenous coordinates
      * 
      * @param p1Vec 3D reference image corner (w, 0, 1, 1) transforemed in the camera local space 
      * @param p2Vec 3D reference image corner (w, h, 1, 1) transforemed in the camera local space
@@ -117,7 +145,7 @@ class CImageLocator3D
      * @param logger into which is the optional processing info logged
      * @return the correction matrix
     */
-    Mat getCorrectionMatrixForTheCameraLocalSpace(const Mat& p1HomVec, const Mat& p2HomVec, const Mat& p3HomVec,
+    Matx44d getCorrectionMatrixForTheCameraLocalSpace(const Vec4d& p1HomVec, const Vec4d& p2HomVec, const Vec4d& p3HomVec,
         const sm::SGcsCoords& gcsP2, const sm::SGcsCoords& gcsP3, Ptr<CLogger>& logger);
     /**
      * @brief Computes flat rotation from the east vector (1, 0) to the direction vector pointing to the midpoint between gcsP2 and gcsP3
@@ -163,7 +191,33 @@ public:
      * @param obj_corners corners of the reference image (w,h = reference image width and height) - (0, 0)^T, (w, 0)^T, (w, h)^T, (0, h)^T
      * @param sceneCorners 2D projections of the obj_corners in the scene image
      * @param logger logger to which the processing and results are outputed
+     * @param drawProjection whether the projected building volume is drawn (only if calcProjectionFrom3D_ is set, the pose is computed anyway)
+    */
+    void calcLocation(vector<Point2d>& obj_corners, vector<Point2d>& sceneCorners, Ptr<CLogger>& logger, bool drawProjection = true);
+    /**
+     * @brief Gives information whether the relative 3D transformation was calculated
+     * @return true if the rotation and translation are valid
+    */
+    bool projectionProcessed() const { return projectionProcessed_; }
+    /**
+     * @brief Gives information whether the GCS/GPS location was calculated
+     * @return true if the camera GCS location is valid
+    */
+    bool gcsProcessed() const { return gcsProcessed_; }
+    /**
+     * @brief Gives the rotation of the camera (from the reference image space to the camera space) in the vector form
+     * @return rotation vector (see Rodrigues)
+    */
+    const Vec3d& getRVec() const { return RVec_; }
+    /**
+     * @brief Gives the translation of the camera (from the reference image space to the camera space)
+     * @return translation vector
+    */
+    const Vec3d& getTVec() const { return TVec_; }
+    /**
+     * @brief Gives the calculated GCS/GPS location of the camera
+     * @return the location (valid only if gcsProcessed is true)
     */
-    void calcLocation(vector<Point2d>& obj_corners, vector<Point2d>& sceneCorners, Ptr<CLogger>& logger);
+    const sm::SGcsCoords& getCameraGcsLocation() const { return cameraGcsLoc_; }
 };
 
@@ -0,0 +1,56 @@
+#include "CImageProcessingPool.h"
+
+CImageProcessingPool::CImageProcessingPool(const SProcessParams& params, unsigned int threadsCount)
+	:
+	params_(params)
+{
+	if (threadsCount == 0) {
+		threadsCount = max(thread::hardware_concurrency(), 1u);
+	}
+	for (unsigned int i = 0; i < threadsCount; ++i) {
+		detectorExtractors_.push_back(CImage::createDetectorExtractor(params));
+	}
+}
+
+vector<Ptr<CBufferLogger>> CImageProcessingPool::process(const vector<Ptr<CImage>>& images, unsigned int sectionLevel)
+{
+	vector<Ptr<CBufferLogger>> logs(images.size());
+	vector<exception_ptr> errors(images.size());
+	for (size_t i = 0; i < images.size(); ++i) {
+		//images are not saved by the buffers
+		logs[i] = makePtr<CBufferLogger>(true, sectionLevel);
+	}
+
+	atomic<size_t> nextImage(0);
+	auto worker = [&](size_t workerIndex) {
+		for (size_t i = nextImage++; i < images.size(); i = nextImage++) {
+			try {
+				Ptr<CLogger> logger = logs[i];
+				images[i]->process(params_, logger, detectorExtractors_[workerIndex]);
+			}
+			catch (...) {
+				errors[i] = current_exception();
+			}
+		}
+	};
+
+	size_t workersCount = min(detectorExtractors_.size(), images.size());
+	vector<thread> workers;
+	//the calling thread is one of the workers
+	for (size_t w = 1; w < workersCount; ++w) {
+		workers.emplace_back(worker, w);
+	}
+	if (workersCount > 0) {
+		worker(0);
+	}
+	for (auto& it : workers) {
+		it.join();
+	}
+
+	for (auto& it : errors) {
+		if (it) {
+			rethrow_exception(it);
+		}
+	}
+	return logs;
+}
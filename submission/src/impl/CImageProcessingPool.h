@@ -0,0 +1,66 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CImageProcessingPool.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class that processes more images concurrently (detection and description of the keypoints)
+ *
+ *  Every worker thread has its own detector extractor object, because the OpenCV detectors are not safe to be used from more threads.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <exception>
+
+#include "CImage.h"
+#include "CLogger.h"
+#include "CBufferLogger.h"
+#include "SProcessParams.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Class that processes more images concurrently (detection and description of the keypoints)
+ * 
+ * Usage is following: construct (once, the detector extractors are reused) -> call process with all images that should be processed
+ * 
+ * Every worker thread has its own detector extractor object (the OpenCV detectors are not safe to be used from more threads).
+ * Images are taken by the workers one by one from the shared queue, so the work is balanced even for images of a different size.
+ * The results of every image are the same as if the image was processed sequentially.
+ * 
+*/
+class CImageProcessingPool
+{
+	const SProcessParams params_; ///< parameters used for the processing
+	vector<Ptr<CImage::CDetectorExtractor>> detectorExtractors_; ///< one detector extractor for every worker thread
+public:
+	/**
+	 * @brief Constructor, it creates the detector extractor for every worker
+	 * @param params parameters that determine which algorithms would be used to detect features and which one used to describe them
+	 * @param threadsCount number of the worker threads (0 means number of the hardware threads)
+	*/
+	CImageProcessingPool(const SProcessParams& params, unsigned int threadsCount);
+	/**
+	 * @brief Gives number of the worker threads
+	 * @return the number of threads
+	*/
+	size_t getThreadsCount() const { return detectorExtractors_.size(); }
+	/**
+	 * @brief Processes all the given images concurrently (see CImage::process)
+	 * 
+	 * The log of every image is buffered and it is returned, so it can be logged in the same order as the images are
+	 * 
+	 * @param images images to be processed
+	 * @param sectionLevel section level of the logger into which the logs will be replayed
+	 * @return buffered logs, one for every image (in the order of the images)
+	 * @throw the first exception (in the order of the images) that occured during the processing
+	*/
+	vector<Ptr<CBufferLogger>> process(const vector<Ptr<CImage>>& images, unsigned int sectionLevel);
+};
@@ -49,6 +49,14 @@ Ptr<DescriptorMatcher> CImagesMatch::createMatcher(const SProcessParams & params
 			matcher = new FlannBasedMatcher(makePtr<flann::LshIndexParams>(12, 20, 2));
 		}
 		break;
+	case EAlgorithm::ALG_HNSW_MATCHING:
+		//only the float descriptors (checked when the parameters are loaded)
+		matcher = makePtr<CHnswMatcher>(params.hnswParams_);
+		break;
+	case EAlgorithm::ALG_GEMM_MATCHING:
+		//only the float descriptors (checked when the parameters are loaded)
+		matcher = makePtr<CGemmMatcher>();
+		break;
 	default:
 		throw invalid_argument("Error feature detecting method was used! (non recognized method)");
 		break;
@@ -57,6 +65,68 @@ Ptr<DescriptorMatcher> CImagesMatch::createMatcher(const SProcessParams & params
 	return matcher;
 }
 
+bool CImagesMatch::sceneIsQuery(const SProcessParams& params, size_t objectFeaturesCount, size_t sceneFeaturesCount)
+{
+	switch (params.matchingParams_.direction_)
+	{
+	case EMatchingDirection::SCENE_TO_OBJECT:
+		return true;
+	case EMatchingDirection::AUTO:
+		return sceneFeaturesCount < objectFeaturesCount;
+	default:
+		return false;
+	}
+}
+
+void CImagesMatch::top2ToKnnMatches(const dk::STop2Matches& top2, vector<vector<DMatch>>& knnMatches)
+{
+	knnMatches.assign(top2.size(), vector<DMatch>());
+	for (size_t i = 0; i < top2.size(); ++i) {
+		if (top2.trainIdx1_[i] >= 0) {
+			knnMatches[i].emplace_back((int)i, top2.trainIdx1_[i], top2.distance1_[i]);
+		}
+		if (top2.trainIdx2_[i] >= 0) {
+			knnMatches[i].emplace_back((int)i, top2.trainIdx2_[i], top2.distance2_[i]);
+		}
+	}
+}
+
+bool CImagesMatch::findKnnMatches(const SProcessParams& params, const STrainedMatchers& matchers, vector<vector<DMatch>>& knnMatches) const
+{
+	//quantized references are matched directly on the quantized data (brute force)
+	if (objectImage_->hasQuantizedDescriptors()) {
+		dk::STop2Matches top2;
+		dk::top2L2Quantized(objectImage_->getQuantizedDescriptors(), objectImage_->getDescriptorsScale(), sceneImage_->getDescriptors(), top2);
+		top2ToKnnMatches(top2, knnMatches);
+		return false;
+	}
+	//packed binary descriptors are matched by the popcount kernel (brute force)
+	if (objectImage_->hasPackedDescriptors() && sceneImage_->hasPackedDescriptors()) {
+		dk::STop2Matches top2;
+		objectImage_->getPackedDescriptors().findTop2(sceneImage_->getPackedDescriptors(), top2);
+		top2ToKnnMatches(top2, knnMatches);
+		return false;
+	}
+
+	if (!sceneIsQuery(params, objectImage_->getKeypoints().size(), sceneImage_->getKeypoints().size())) {
+		if (!matchers.sceneMatcher_.empty()) {
+			matchers.sceneMatcher_->knnMatch(objectImage_->getDescriptors(), knnMatches, 2);
+		}
+		else {
+			createMatcher(params)->knnMatch(objectImage_->getDescriptors(), sceneImage_->getDescriptors(), knnMatches, 2);
+		}
+		return false;
+	}
+
+	if (!matchers.objectMatcher_.empty()) {
+		matchers.objectMatcher_->knnMatch(sceneImage_->getDescriptors(), knnMatches, 2);
+	}
+	else {
+		createMatcher(params)->knnMatch(sceneImage_->getDescriptors(), objectImage_->getDescriptors(), knnMatches, 2);
+	}
+	return true;
+}
+
 void CImagesMatch::printTransformationMatrix(Ptr<CLogger>& logger) const
 {
 	//transformation matrix returned from findHomography contains doubles
@@ -76,7 +146,7 @@ void CImagesMatch::printTransformationMatrix(Ptr<CLogger>& logger) const
 
 //=================================================================================================
 
-CImagesMatch::CImagesMatch(const Ptr<CImage>& object, const Ptr<CImage>& scene, CLogger* logger, const SProcessParams & params)
+CImagesMatch::CImagesMatch(const Ptr<CImage>& object, const Ptr<CImage>& scene, CLogger* logger, const SProcessParams & params, const STrainedMatchers& matchers)
 	: objectImage_(object), sceneImage_(scene)
 {
 	//checking for valid input
@@ -87,73 +157,46 @@ CImagesMatch::CImagesMatch(const Ptr<CImage>& object, const Ptr<CImage>& scene,
 		throw invalid_argument("Error in matching. Scene image pointer is empty!");
 	}
 
-	
-	FlannBasedMatcher matcher2(new flann::LshIndexParams(20, 10, 2));
-
-	Ptr<DescriptorMatcher> matcher = createMatcher(params);
-
+	gmsParams_ = params.gmsParams_;
 	//knn matches
 	vector<vector<DMatch>> knnMatches;
-	matcher->knnMatch(object->getDescriptors(), scene->getDescriptors(), knnMatches, 2);
-
-	//Looping over all the matches and doing some usefull stuff (filtering and others)
-	double maxDistance = 0; double minDistance = numeric_limits<double>::max();
-	double avarageDistance = 0;
-	double avarageWeight = 0;
-	double avarageFirstToSecondRatio = 0;
-	double dynamicRatio = params.loweRatioTestAlpha_;
-	bool firstRun = true;
-	size_t firstFilteredSize = 0;
-	for (double dynamicRatio = params.loweRatioTestAlpha_;
-		dynamicRatio < 1 && matches_.size() < 4;
-		dynamicRatio += 0.05) {
-
-		//reset matches
-		matches_.clear();
-
-		for (int i = 0; i < knnMatches.size(); i++)
-		{
-			//the matcher might not find anything
-			if (knnMatches[i].size() == 0) {
-				continue;
-			}
-
-			//-- Quick calculation of max, min, avg distances between keypoints
-			++avarageWeight;
-			double dist = knnMatches[i][0].distance;
-			if (dist < minDistance) minDistance = dist;
-			if (dist > maxDistance) maxDistance = dist;
-			avarageDistance = ((avarageDistance * avarageWeight) + (dist)) / (1 + avarageWeight);
-
-			//check if there is at least two of found pairs and if not do something (push the match for example)
-			//less than two matches might happen for flann based matchers (maybe for others, but I havent experienced it)
-			if (knnMatches[i].size() < 2) {
-				matches_.push_back(knnMatches[i][0]);
-				continue;
-			}
+	bool sceneIsQuery = findKnnMatches(params, matchers, knnMatches);
+	filterMatches(knnMatches, sceneIsQuery, objectImage_->getKeypoints().size(), logger, params);
+}
 
-			// Lowe's ratio test
-			// just filtering some "badly" matched matches, getting only good matches
-			//TODO might be a slow solution
-			double currentFirstToSecondRatio = knnMatches[i][0].distance / knnMatches[i][1].distance;
-			avarageFirstToSecondRatio = ((avarageFirstToSecondRatio * avarageWeight) + (currentFirstToSecondRatio)) / (1 + avarageWeight);
-			if (knnMatches[i][0].distance < dynamicRatio * knnMatches[i][1].distance) {
-				matches_.push_back(knnMatches[i][0]);
-			}
-		}
-		//this is needed to do because the size will grow but with less strict test, so to keep the accuracy we have to keep the result from the first run
-		if (firstRun) {
-			firstRun = false;
-			firstFilteredSize = matches_.size();
-		}
+CImagesMatch::CImagesMatch(const Ptr<CImage>& object, const Ptr<CImage>& scene, const vector<vector<DMatch>>& knnMatches, bool sceneIsQuery,
+	size_t objectFeaturesCount, CLogger* logger, const SProcessParams& params)
+	: objectImage_(object), sceneImage_(scene)
+{
+	//checking for valid input
+	if (object.empty()) {
+		throw invalid_argument("Error in matching. Object image pointer is empty!");
 	}
+	else if (scene.empty()) {
+		throw invalid_argument("Error in matching. Scene image pointer is empty!");
+	}
+	gmsParams_ = params.gmsParams_;
+	filterMatches(knnMatches, sceneIsQuery, objectFeaturesCount, logger, params);
+}
 
-	avarageMatchesDistance_ = avarageDistance;
-	avarageFirstToSecondRatio_ = avarageFirstToSecondRatio;
-	matchedObjectFeaturesRatio_ = (double) firstFilteredSize / (double) knnMatches.size();
-
-	logger->log("Min distance: ").log(to_string(minDistance)).log(" | Max distance:").log(to_string(maxDistance)).endl();
-	logger->log("Average distance:").log(to_string(avarageDistance)).endl();
+void CImagesMatch::filterMatches(const vector<vector<DMatch>>& knnMatches, bool sceneIsQuery, size_t objectFeaturesCount, CLogger* logger, const SProcessParams& params)
+{
+	//Lowe's ratio test (relaxed until there are enough matches for the homography) and the cross check
+	SFilteredMatches filtered;
+	CMatchesFilter(params).filter(knnMatches, sceneIsQuery, filtered);
+	matches_ = move(filtered.matches_);
+
+	avarageMatchesDistance_ = filtered.avarageDistance_;
+	avarageFirstToSecondRatio_ = filtered.avarageFirstToSecondRatio_;
+	//the ratio of the configured alpha is kept, the relaxed test would make the less strict matches look better
+	//the distinct object features are counted, so the ratio has the same meaning in both matching directions (the references are ranked by it)
+	matchedObjectFeaturesRatio_ = objectFeaturesCount == 0 ? 0.0 : (double) filtered.firstFilteredObjectFeatures_ / (double) objectFeaturesCount;
+
+	logger->log("Min distance: ").log(to_string(filtered.minDistance_)).log(" | Max distance:").log(to_string(filtered.maxDistance_)).endl();
+	logger->log("Average distance:").log(to_string(filtered.avarageDistance_)).endl();
+	if (params.matchingParams_.crossCheck_) {
+		logger->log("Matches rejected by the cross check: ").log(to_string(filtered.crossCheckRejected_)).endl();
+	}
 	logger->log("Average first to second ratio is: ").log(to_string(avarageFirstToSecondRatio_)).endl();
 	logger->log("Ratio of filtered matches to number of keypoints of object is: ").log(to_string(matchedObjectFeaturesRatio_)).endl();
 
@@ -161,34 +204,59 @@ CImagesMatch::CImagesMatch(const Ptr<CImage>& object, const Ptr<CImage>& scene,
 
 //=================================================================================================
 
-CImagesMatch::CImagesMatch(CImagesMatch&& right) noexcept
-	:
-	objectImage_(right.objectImage_),
-	sceneImage_(right.sceneImage_)
+void CImagesMatch::filterByMotionStatistics()
 {
-	this->matches_ = move(right.matches_);
-	avarageMatchesDistance_ = right.avarageMatchesDistance_;
-	matchedObjectFeaturesRatio_ = right.matchedObjectFeaturesRatio_;
-	avarageFirstToSecondRatio_ = right.avarageFirstToSecondRatio_;
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	vector<uchar> mask;
+	size_t kept = CGmsFilter(gmsParams_).filter(matches_, objectImage_->getKeypoints(), objectImage_->getImage().size(),
+		sceneImage_->getKeypoints(), sceneImage_->getImage().size(), mask);
+	if (kept >= 4) {
+		size_t last = 0;
+		for (size_t i = 0; i < matches_.size(); ++i) {
+			if (mask[i]) {
+				matches_[last++] = matches_[i];
+			}
+		}
+		matches_.resize(last);
+	}
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	geometryStats_.gmsMatchesCount_ = kept;
+	geometryStats_.gmsMs_ = chrono::duration_cast<chrono::microseconds>(end - begin).count() / 1000.0;
 }
 
-//=================================================================================================
+bool CImagesMatch::computeHomography()
+{
+	//the OpenCV default iterations and confidence
+	return estimateHomography(RANSAC, 3, 2000, 0.995, true);
+}
 
-void CImagesMatch::drawPreviewAndResult(const string& runName, Ptr<CLogger>& logger, const SProcessParams& params)
+size_t CImagesMatch::verifyHomography(const SVerificationParams& params)
 {
-	// drawing the results
-	Mat imageMatches;
-	drawMatches(
-		objectImage_->getImage(), objectImage_->getKeypoints(),
-		sceneImage_->getImage(), sceneImage_->getKeypoints(),
-		matches_, imageMatches, Scalar::all(-1), Scalar::all(-1),
-		vector<char>(), DrawMatchesFlags::NOT_DRAW_SINGLE_POINTS);
+	if (!estimateHomography(USAC_MAGSAC, params.threshold_, params.maxIterations_, params.confidence_, false)) {
+		return 0;
+	}
+	return geometryStats_.inliersCount_;
+}
+
+bool CImagesMatch::estimateHomography(int method, double threshold, int maxIterations, double confidence, bool fallback)
+{
+	transformMatrixComputed_ = true;
+	objectSceneHomography_ = Mat();
+	homographyInliersMask_.clear();
+	geometryStats_ = SGeometryStats();
+	geometryStats_.matchesCount_ = matches_.size();
+	if (matches_.size() < 4) {
+		return false;
+	}
+	if (gmsParams_.enabled_) {
+		filterByMotionStatistics();
+	}
 
 	//TODO some speed optimalization can be done here by pushing back these points already in the lowe's ratio test
-	//-- Localize the object
 	std::vector<Point2d> objectKeypointsCoordinates;
 	std::vector<Point2d> sceneKeypointsCoordinates;
-
+	objectKeypointsCoordinates.reserve(matches_.size());
+	sceneKeypointsCoordinates.reserve(matches_.size());
 	for (int i = 0; i < matches_.size(); i++)
 	{
 		//-- Get the keypoints from the good matches
@@ -196,24 +264,135 @@ void CImagesMatch::drawPreviewAndResult(const string& runName, Ptr<CLogger>& log
 		sceneKeypointsCoordinates.push_back(sceneImage_->getKeypoints()[matches_[i].trainIdx].pt);
 	}
 
-	objectSceneHomography_ = findHomography(objectKeypointsCoordinates, sceneKeypointsCoordinates, RANSAC);
-	if (objectSceneHomography_.empty()) {
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	objectSceneHomography_ = findHomography(objectKeypointsCoordinates, sceneKeypointsCoordinates, method, threshold, homographyInliersMask_, maxIterations, confidence);
+	if (objectSceneHomography_.empty() && fallback) {
 		//sometimes the findHomography with RANSAC may return empty matrix (known bug og OpenCV) -> use RHO or LMeds (less robust then RHO)
+		homographyInliersMask_.clear();
 		objectSceneHomography_ = findHomography(objectKeypointsCoordinates, sceneKeypointsCoordinates, RHO);
 	}
-	transformMatrixComputed_ = true;
+	else if (objectSceneHomography_.empty()) {
+		homographyInliersMask_.clear();
+	}
+	else {
+		geometryStats_.inliersCount_ = (size_t)countNonZero(homographyInliersMask_);
+	}
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	geometryStats_.homographyMs_ = chrono::duration_cast<chrono::microseconds>(end - begin).count() / 1000.0;
+	return !objectSceneHomography_.empty();
+}
 
+void CImagesMatch::logGeometryStats(Ptr<CLogger>& logger) const
+{
+	logger->logSection("Homography estimation", 2);
+	if (gmsParams_.enabled_) {
+		logger->log("GMS filter kept ").log(to_string(geometryStats_.gmsMatchesCount_)).log(" of ").log(to_string(geometryStats_.matchesCount_))
+			.log(" matches, took: ").log(to_string(geometryStats_.gmsMs_)).log("[ms]").endl();
+	}
+	logger->log("Homography estimation took: ").log(to_string(geometryStats_.homographyMs_)).log("[ms]");
+	if (!homographyInliersMask_.empty()) {
+		logger->log(", RANSAC inlier rate: ").log(to_string((double)geometryStats_.inliersCount_ / homographyInliersMask_.size()))
+			.log(" (").log(to_string(geometryStats_.inliersCount_)).log(" of ").log(to_string(homographyInliersMask_.size())).log(")");
+	}
+	logger->endl();
+}
+
+void CImagesMatch::getCorners(vector<Point2d>& objectCorners, vector<Point2d>& sceneCorners) const
+{
+	if (!transformMatrixComputed_ || objectSceneHomography_.empty()) {
+		throw logic_error("CImagesMatch - to get the corners first the homography has to be computed.");
+	}
+	getCorners(objectSceneHomography_, objectImage_->getImage().size(), objectCorners, sceneCorners);
+}
+
+void CImagesMatch::getCorners(const Mat& homography, const Size& objectSize, vector<Point2d>& objectCorners, vector<Point2d>& sceneCorners)
+{
 	// Get the corners from the image_1 ( the object to be "detected" )
-	std::vector<Point2d> obj_corners(4);
-	obj_corners[0] = Point2d(0, 0); // left upper
-	obj_corners[1] = Point2d(objectImage_->getImage().cols, 0); // right uppper
-	obj_corners[2] = Point2d(objectImage_->getImage().cols, objectImage_->getImage().rows); // right bottom 
-	obj_corners[3] = Point2d(0, objectImage_->getImage().rows); // left bottom
-
-		//future cornes coordinates
-	std::vector<Point2d> scene_corners(4);
+	objectCorners.resize(4);
+	objectCorners[0] = Point2d(0, 0); // left upper
+	objectCorners[1] = Point2d(objectSize.width, 0); // right uppper
+	objectCorners[2] = Point2d(objectSize.width, objectSize.height); // right bottom 
+	objectCorners[3] = Point2d(0, objectSize.height); // left bottom
+
+	//future cornes coordinates
+	sceneCorners.resize(4);
 	//transformating the cornes
-	perspectiveTransform(obj_corners, scene_corners, objectSceneHomography_);
+	perspectiveTransform(objectCorners, sceneCorners, homography);
+}
+
+void CImagesMatch::getInlierCorrespondences(vector<Point2f>& objectPoints, vector<Point2f>& scenePoints) const
+{
+	if (!transformMatrixComputed_ || objectSceneHomography_.empty()) {
+		throw logic_error("CImagesMatch - to get the inliers first the homography has to be computed.");
+	}
+	objectPoints.clear();
+	scenePoints.clear();
+	objectPoints.reserve(matches_.size());
+	scenePoints.reserve(matches_.size());
+	for (size_t i = 0; i < matches_.size(); ++i) {
+		if (!homographyInliersMask_.empty() && !homographyInliersMask_[i]) {
+			continue;
+		}
+		objectPoints.push_back(objectImage_->getKeypoints()[matches_[i].queryIdx].pt);
+		scenePoints.push_back(sceneImage_->getKeypoints()[matches_[i].trainIdx].pt);
+	}
+}
+
+//=================================================================================================
+
+SLocalizationResult CImagesMatch::localize(Ptr<CLogger>& logger, const SProcessParams& params, bool drawProjection)
+{
+	//the GMS filter may remove some matches, so the homography is computed before anything else uses the matches
+	if (!transformMatrixComputed_) {
+		computeHomography();
+	}
+	logGeometryStats(logger);
+	return localize(objectImage_, sceneImage_, objectSceneHomography_, params, logger, drawProjection);
+}
+
+SLocalizationResult CImagesMatch::localize(const Ptr<CImage>& object, const Ptr<CImage>& scene, const Mat& homography,
+	const SProcessParams& params, Ptr<CLogger>& logger, bool drawProjection)
+{
+	SLocalizationResult result;
+	if (homography.empty()) {
+		return result;
+	}
+	result.homographyFound_ = true;
+	result.homography_ = homography;
+	getCorners(homography, object->getImage().size(), result.objectCorners_, result.sceneCorners_);
+
+	//the pose and the GCS location are computed only when some of their outputs is wanted
+	if (!params.calcProjectionFrom3D_ && !params.calcGCSLocation_) {
+		return result;
+	}
+	CImageLocator3D imageLocator3D(scene, object, params);
+	imageLocator3D.calcLocation(result.objectCorners_, result.sceneCorners_, logger, drawProjection);
+	result.poseFound_ = imageLocator3D.projectionProcessed();
+	if (result.poseFound_) {
+		result.rVec_ = imageLocator3D.getRVec();
+		result.tVec_ = imageLocator3D.getTVec();
+	}
+	result.gcsFound_ = imageLocator3D.gcsProcessed();
+	if (result.gcsFound_) {
+		result.cameraGcs_ = imageLocator3D.getCameraGcsLocation();
+	}
+	return result;
+}
+
+void CImagesMatch::drawPreview(const SLocalizationResult& result, Ptr<CLogger>& logger) const
+{
+	if (!result.homographyFound_) {
+		throw logic_error("CImagesMatch - the preview can't be drawn without the homography.");
+	}
+	const vector<Point2d>& scene_corners = result.sceneCorners_;
+
+	// drawing the results
+	Mat imageMatches;
+	drawMatches(
+		objectImage_->getImage(), objectImage_->getKeypoints(),
+		sceneImage_->getImage(), sceneImage_->getKeypoints(),
+		matches_, imageMatches, Scalar::all(-1), Scalar::all(-1),
+		vector<char>(), DrawMatchesFlags::NOT_DRAW_SINGLE_POINTS);
 
 	//-- Draw lines between the corners (the mapped object in the scene - image_2 )
 	line(imageMatches, scene_corners[0] + Point2d(objectImage_->getImage().cols, 0),
@@ -239,11 +418,11 @@ void CImagesMatch::drawPreviewAndResult(const string& runName, Ptr<CLogger>& log
 	//create mask
 	Mat mask(objectImage_->getImage().rows, objectImage_->getImage().cols, CV_8U, Scalar(255));
 	Mat transformedMask(sceneImage_->getImage().rows, sceneImage_->getImage().cols, CV_8U, Scalar(0));
-	warpPerspective(mask, transformedMask, objectSceneHomography_, Size(transformedMask.cols, transformedMask.rows));
+	warpPerspective(mask, transformedMask, result.homography_, Size(transformedMask.cols, transformedMask.rows));
 
 	//transform object into scene size image plane
 	Mat transformedObject(Size(sceneImage_->getImage().cols, sceneImage_->getImage().rows), CV_8U);
-	warpPerspective(objectImage_->getImage(), transformedObject, objectSceneHomography_, Size(transformedObject.cols, transformedObject.rows));
+	warpPerspective(objectImage_->getImage(), transformedObject, result.homography_, Size(transformedObject.cols, transformedObject.rows));
 
 	//redraw the object in the red color and according to mask
 	for (int i = 0; i < transformedObject.rows; ++i) {
@@ -258,11 +437,14 @@ void CImagesMatch::drawPreviewAndResult(const string& runName, Ptr<CLogger>& log
 	printTransformationMatrix(logger);
 	// draw the object to the scene in the right place
 	logger->putImage(sceneImageRenderBuffer, VISUALISATION_2D_WINDOW_TITLE);
+}
 
-	
-	//calculate the real location
-	if (params.calcProjectionFrom3D_ || params.calcGCSLocation_) {
-		CImageLocator3D imageLocator3D(sceneImage_, objectImage_, params);
-		imageLocator3D.calcLocation(obj_corners, scene_corners, logger);
+SLocalizationResult CImagesMatch::drawPreviewAndResult(const string& runName, Ptr<CLogger>& logger, const SProcessParams& params)
+{
+	SLocalizationResult result = localize(logger, params, true);
+	if (!result.homographyFound_) {
+		throw logic_error("The homography of the match can't be found (too few matches)");
 	}
+	drawPreview(result, logger);
+	return result;
 }
\ No newline at end of file
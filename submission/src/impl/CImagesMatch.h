@@ -19,6 +19,7 @@
 //for the constants
 #define _USE_MATH_DEFINES
 #include<cmath>
+#include <chrono>
 //quaternion
 #include <opencv2/core/quaternion.hpp>
 //wrapper around basic shared pointer
@@ -33,9 +34,48 @@
 
 #include "CImage.h"
 #include "SProcessParams.h"
+#include "CMatchesFilter.h"
+#include "CGmsFilter.h"
 #include "CImageLocator3D.h"
+#include "SGcsCoords.h"
+#include "CHnswMatcher.h"
+#include "CGemmMatcher.h"
 #include "parameters.h"
 
+/**
+ * @brief Matchers trained once and shared by more matches (the matcher is created for every match when they are empty)
+*/
+struct STrainedMatchers {
+	Ptr<DescriptorMatcher> sceneMatcher_; ///< matcher trained with the scene descriptors (the object descriptors are the queries)
+	Ptr<DescriptorMatcher> objectMatcher_; ///< matcher trained with the object descriptors (the scene descriptors are the queries)
+};
+
+/**
+ * @brief Statistics of the homography estimation
+*/
+struct SGeometryStats {
+	size_t matchesCount_ = 0; ///< number of the matches after the ratio test
+	size_t gmsMatchesCount_ = 0; ///< number of the matches kept by the GMS filter (0 if it was not used)
+	size_t inliersCount_ = 0; ///< number of the RANSAC inliers (0 if the homography was found by RHO)
+	double gmsMs_ = 0.0; ///< time of the GMS filter
+	double homographyMs_ = 0.0; ///< time of the homography estimation
+};
+
+/**
+ * @brief Result of the localization of the scene camera by the match (no image is needed to compute it)
+*/
+struct SLocalizationResult {
+	bool homographyFound_ = false; ///< whether the homography was found (nothing else is valid otherwise)
+	Mat homography_; ///< 3x3 homography from the reference image to the scene image
+	vector<Point2d> objectCorners_; ///< corners of the reference image - (0, 0), (w, 0), (w, h), (0, h)
+	vector<Point2d> sceneCorners_; ///< projections of the objectCorners_ in the scene image
+	bool poseFound_ = false; ///< whether the rotation and translation are valid (they are computed only if the projection or the GCS location is enabled)
+	Vec3d rVec_; ///< rotation of the camera (from the reference image space to the camera space, Rodrigues vector)
+	Vec3d tVec_; ///< translation of the camera (from the reference image space to the camera space)
+	bool gcsFound_ = false; ///< whether the GCS location is valid
+	sm::SGcsCoords cameraGcs_ = sm::SGcsCoords(0.0, 0.0); ///< GCS (GPS) location of the camera
+};
+
 /**
  * @brief Class that handles matches between two object, mainly it represent the match itself
  * 
@@ -55,12 +95,49 @@ class CImagesMatch {
 	double avarageFirstToSecondRatio_ = -1; ///< average ratio from the Lowe's ratio test (called here as first to second ratio)(the smaller the better)
 	Mat objectSceneHomography_; ///< transformation matrix of the match
 	bool transformMatrixComputed_ = false; ///< information whether the transformation matrix was computed
+	vector<uchar> homographyInliersMask_; ///< inliers of the homography (one value per filtered match, empty if the homography was not found by RANSAC)
+	SGmsParams gmsParams_; ///< parameters of the GMS filter used before the homography estimation
+	SGeometryStats geometryStats_; ///< statistics of the last homography estimation
 	/**
-	 * @brief Creates the right matcher object
+	 * @brief Removes the matches that are not supported by the motion statistics (GMS), nothing is removed if fewer than 4 matches would be left
+	*/
+	void filterByMotionStatistics();
+	/**
+	 * @brief Estimates the homography from the filtered matches (GMS filter if it is enabled -> robust estimation)
+	 * @param method robust method of the estimation (RANSAC, USAC_MAGSAC, ...)
+	 * @param threshold maximal reprojection error of the inlier
+	 * @param maxIterations iterations budget
+	 * @param confidence confidence of the estimation (early termination)
+	 * @param fallback whether RHO is used when the robust method does not find the homography
+	 * @return true if the homography was found
+	*/
+	bool estimateHomography(int method, double threshold, int maxIterations, double confidence, bool fallback);
+	/**
+	 * @brief Logs the statistics of the homography estimation (GMS filter, RANSAC inlier rate, timing)
+	 * @param logger logger in which it will print the statistics
+	*/
+	void logGeometryStats(Ptr<CLogger>& logger) const;
+	/**
+	 * @brief Finds two nearest neighbours of the query descriptors (it chooses the matcher according to the descriptors representation and the direction)
+	 * 
+	 * When the scene descriptors are the queries, the knn matches are kept as they are (query is the scene, train is the object),
+	 * the filter turns the matches around (see CMatchesFilter::filter).
+	 * 
 	 * @param params the parameters that determine which matcher would be used
-	 * @return smart pointer to the matcher (returns interface/virtual class)
+	 * @param matchers already trained matchers (the matcher is created when the needed one is empty)
+	 * @param knnMatches output knn matches
+	 * @return true if the query of the knn matches is the scene, false if it is the object
 	*/
-	static Ptr<DescriptorMatcher> createMatcher(const SProcessParams & params);
+	bool findKnnMatches(const SProcessParams& params, const STrainedMatchers& matchers, vector<vector<DMatch>>& knnMatches) const;
+	/**
+	 * @brief Filters the knn matches by the Lowe's ratio test (the ratio is loosened until there are at least 4 matches) and computes the statistics of the match
+	 * @param knnMatches knn matches
+	 * @param sceneIsQuery whether the query of the knn matches is the scene (see findKnnMatches)
+	 * @param objectFeaturesCount number of the object features (the matched object features ratio is relative to it)
+	 * @param logger logger in which it will print information about the process
+	 * @param params params the parameters with the ratio test alpha
+	*/
+	void filterMatches(const vector<vector<DMatch>>& knnMatches, bool sceneIsQuery, size_t objectFeaturesCount, CLogger* logger, const SProcessParams& params);
 	/**
 	 * @brief prints the inner transformation matrix of the match
 	 * @param clogger logger in which the matrix will be printed in
@@ -68,31 +145,146 @@ class CImagesMatch {
 	*/
 	void printTransformationMatrix(Ptr<CLogger>& logger) const;
 public:
+	/**
+	 * @brief Creates the right matcher object
+	 * @param params the parameters that determine which matcher would be used
+	 * @return smart pointer to the matcher (returns interface/virtual class)
+	*/
+	static Ptr<DescriptorMatcher> createMatcher(const SProcessParams & params);
+	/**
+	 * @brief Converts the flat result of the descriptor kernels into the OpenCV knn matches (the found neighbours only)
+	 * @param top2 the flat result
+	 * @param knnMatches output knn matches
+	*/
+	static void top2ToKnnMatches(const dk::STop2Matches& top2, vector<vector<DMatch>>& knnMatches);
+	/**
+	 * @brief Decides the direction of the matching of the pair
+	 * @param params the parameters with the matching direction
+	 * @param objectFeaturesCount number of the object descriptors
+	 * @param sceneFeaturesCount number of the scene descriptors
+	 * @return true if the scene descriptors are the queries (the object is indexed)
+	*/
+	static bool sceneIsQuery(const SProcessParams& params, size_t objectFeaturesCount, size_t sceneFeaturesCount);
 	/**
 	 * @brief Constructor of the class
 	 * @param object smart pointer of the reference object (sort of training object) - should stay valid through time of using of this clas
 	 * @param scene smart pointer of the scene (sort of query object) - should stay valid through time of using of this clas
 	 * @param logger logger in which it will print information about the process
 	 * @param params params the parameters that determine which matcher would be used
+	 * @param matchers already trained matchers shared by more matches (the matcher is created when the needed one is empty)
 	 * @throw invalid_argument if there is called a not implemented method for matching
 	*/
-	CImagesMatch(const Ptr<CImage>& object, const Ptr<CImage>& scene, CLogger* logger, const SProcessParams& params);
+	CImagesMatch(const Ptr<CImage>& object, const Ptr<CImage>& scene, CLogger* logger, const SProcessParams& params, const STrainedMatchers& matchers = STrainedMatchers());
 	/**
-	 * @brief Move constructor
+	 * @brief Constructor from the already found knn matches (e.g. the part of the single pass over all the objects, see CGlobalDescriptorIndex)
+	 * @param object smart pointer of the reference object (sort of training object) - should stay valid through time of using of this clas
+	 * @param scene smart pointer of the scene (sort of query object) - should stay valid through time of using of this clas
+	 * @param knnMatches knn matches, only the distance of the second neighbour is used
+	 * @param sceneIsQuery false if the query of the knn matches is the object and the train is the scene, true if it is turned around
+	 * @param objectFeaturesCount number of the object features (the matched object features ratio is relative to it)
+	 * @param logger logger in which it will print information about the process
+	 * @param params params the parameters with the ratio test alpha
+	 * @throw invalid_argument if the image pointers are empty
+	*/
+	CImagesMatch(const Ptr<CImage>& object, const Ptr<CImage>& scene, const vector<vector<DMatch>>& knnMatches, bool sceneIsQuery,
+		size_t objectFeaturesCount, CLogger* logger, const SProcessParams& params);
+	/**
+	 * @brief Move constructor, all the members are moved (the image pointers are const, so they are copied)
 	 * @param right object to be moved
 	*/
-	CImagesMatch(CImagesMatch&& right) noexcept;
+	CImagesMatch(CImagesMatch&& right) = default;
+	/**
+	 * @brief Localizes the scene camera by the match (homography -> corners -> pose -> GCS location), it does not draw anything
+	 * 
+	 * The homography is computed if it was not computed yet. The pose is computed only if the projection or the GCS location is enabled in the parameters,
+	 * the GCS location only if it is enabled.
+	 * 
+	 * @param logger logger in which it will print information about the process
+	 * @param params the parameters with the camera information and the GCS switch
+	 * @param drawProjection whether the projected building volume is drawn (only if it is enabled in the parameters)
+	 * @return the result (homographyFound_ is false if the homography was not found)
+	*/
+	SLocalizationResult localize(Ptr<CLogger>& logger, const SProcessParams& params, bool drawProjection = false);
+	/**
+	 * @brief Localizes the scene camera by the given homography, it does not draw anything
+	 * @param object the reference image
+	 * @param scene the scene image
+	 * @param homography 3x3 homography from the reference image to the scene image (the result is empty if it is empty)
+	 * @param params the parameters with the camera information and the GCS switch
+	 * @param logger logger in which it will print information about the process
+	 * @param drawProjection whether the projected building volume is drawn (only if it is enabled in the parameters)
+	 * @return the result
+	*/
+	static SLocalizationResult localize(const Ptr<CImage>& object, const Ptr<CImage>& scene, const Mat& homography,
+		const SProcessParams& params, Ptr<CLogger>& logger, bool drawProjection = false);
+	/**
+	 * @brief Draws the already computed result (the matches with the mapped reference borders and the reference warped into the scene)
+	 * @param result result of the localize method
+	 * @param logger logger into which the images are put
+	 * @throw logic_error if the homography of the result was not found
+	*/
+	void drawPreview(const SLocalizationResult& result, Ptr<CLogger>& logger) const;
 	/**
 	 * @brief Previews the result (it includes computing the homography and smoothing out the matches)
 	 * 
+	 * It localizes the camera and then it draws the result (see localize and drawPreview).
 	 * It shows the needed transforamtion of the reference image (this transforamtion determines the location of the object in the scene)
 	 * It also shows all the filtered matches between the keypoints (and the keypoints to which the matches belong)
 	 * 
 	 * @param runName name of the current test 
 	 * @param logger logger in which it will print information about the process
 	 * @param params params the parameters that determine which matcher would be used
+	 * @return the localization result
+	 * @throw logic_error if the homography can't be found
 	*/
-	void drawPreviewAndResult(const string& runName, Ptr<CLogger>& logger, const SProcessParams& params);
+	SLocalizationResult drawPreviewAndResult(const string& runName, Ptr<CLogger>& logger, const SProcessParams& params);
+	/**
+	 * @brief Computes the homography from the filtered matches (RANSAC, RHO if RANSAC fails), it does not draw anything
+	 * 
+	 * If the GMS filter is enabled, the matches without the motion support are removed first (the matches of this object are changed).
+	 * 
+	 * @return true if the homography was found
+	*/
+	bool computeHomography();
+	/**
+	 * @brief Computes the homography by USAC MAGSAC with the bounded iterations (geometric verification), it does not draw anything
+	 * 
+	 * The homography and its inliers replace the ones of computeHomography (the preview uses them), RHO is not used when it fails.
+	 * 
+	 * @param params parameters of the verification
+	 * @return number of the inliers (0 if the homography was not found)
+	*/
+	size_t verifyHomography(const SVerificationParams& params);
+	/**
+	 * @brief Gives the corners of the reference image and their projections into the scene by the homography
+	 * @param objectCorners output corners of the reference image - (0, 0), (w, 0), (w, h), (0, h)
+	 * @param sceneCorners output projections of the corners in the scene image
+	 * @throw logic_error if the homography was not computed
+	*/
+	void getCorners(vector<Point2d>& objectCorners, vector<Point2d>& sceneCorners) const;
+	/**
+	 * @brief Gives the corners of the reference image and their projections by the given homography
+	 * @param homography 3x3 homography from the reference image to the scene image
+	 * @param objectSize size of the reference image
+	 * @param objectCorners output corners of the reference image - (0, 0), (w, 0), (w, h), (0, h)
+	 * @param sceneCorners output projections of the corners in the scene image
+	*/
+	static void getCorners(const Mat& homography, const Size& objectSize, vector<Point2d>& objectCorners, vector<Point2d>& sceneCorners);
+	/**
+	 * @brief Gives the keypoint coordinates of the filtered matches that are inliers of the homography
+	 * 
+	 * When the homography was found by the RHO fallback all the filtered matches are given.
+	 * 
+	 * @param objectPoints output coordinates in the reference image
+	 * @param scenePoints output coordinates in the scene image
+	 * @throw logic_error if the homography was not computed
+	*/
+	void getInlierCorrespondences(vector<Point2f>& objectPoints, vector<Point2f>& scenePoints) const;
+	/**
+	 * @brief Gives the homography from the reference image to the scene image
+	 * @return 3x3 matrix (empty if it was not computed or found)
+	*/
+	const Mat& getHomography() const { return objectSceneHomography_; }
 	/**
 	 * @brief Gives number of filtered matches
 	 * @return number of filtered matches
@@ -113,6 +305,11 @@ public:
 	 * @return the average ratio
 	*/
 	double getAvarageFirstToSecondRatio() const { return avarageFirstToSecondRatio_; }
+	/**
+	 * @brief Gives the statistics of the last homography estimation (GMS filter, RANSAC inliers, timing)
+	 * @return the statistics
+	*/
+	const SGeometryStats& getGeometryStats() const { return geometryStats_; }
 	/**
 	 * @brief Gives the image containing the reference object (sort of training object)
 	 * @return smarter pointer to object CImage
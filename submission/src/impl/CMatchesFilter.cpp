@@ -0,0 +1,154 @@
+#include "CMatchesFilter.h"
+
+CMatchesFilter::CMatchesFilter(const SProcessParams& params)
+	:
+	alpha_(params.loweRatioTestAlpha_),
+	crossCheck_(params.matchingParams_.crossCheck_)
+{
+}
+
+void CMatchesFilter::filter(const vector<vector<DMatch>>& knnMatches, bool sceneIsQuery, SFilteredMatches& result) const
+{
+	result = SFilteredMatches();
+
+	//flat arrays of the queries with at least one match (ratio is negative if there is no second neighbour)
+	vector<int> queries;
+	vector<int> objects;
+	vector<int> scenes;
+	vector<double> ratios;
+	queries.reserve(knnMatches.size());
+	objects.reserve(knnMatches.size());
+	scenes.reserve(knnMatches.size());
+	ratios.reserve(knnMatches.size());
+	double distancesSum = 0.0, ratiosSum = 0.0;
+	bool allHaveSecond = true;
+	int maxObjectIndex = -1, maxSceneIndex = -1;
+	for (size_t i = 0; i < knnMatches.size(); ++i) {
+		if (knnMatches[i].empty()) {
+			continue;
+		}
+		const DMatch& first = knnMatches[i][0];
+		double distance = first.distance;
+		result.minDistance_ = min(result.minDistance_, distance);
+		result.maxDistance_ = max(result.maxDistance_, distance);
+		distancesSum += distance;
+		const int objectIndex = sceneIsQuery ? first.trainIdx : first.queryIdx;
+		const int sceneIndex = sceneIsQuery ? first.queryIdx : first.trainIdx;
+		queries.push_back((int)i);
+		objects.push_back(objectIndex);
+		scenes.push_back(sceneIndex);
+		maxObjectIndex = max(maxObjectIndex, objectIndex);
+		maxSceneIndex = max(maxSceneIndex, sceneIndex);
+		if (knnMatches[i].size() < 2) {
+			allHaveSecond = false;
+			ratios.push_back(-1.0);
+			continue;
+		}
+		double ratio = distance / knnMatches[i][1].distance;
+		ratiosSum += ratio;
+		ratios.push_back(ratio);
+	}
+	const size_t count = queries.size();
+
+	//cross check - the match is kept only if it is the closest one of both its object and its scene feature (the first one on a tie),
+	//the object features repeat in the scene to object direction and the scene features in the object to scene direction
+	vector<bool> accepted(count, true);
+	if (crossCheck_ && count > 0) {
+		vector<int> closestOfObject((size_t)maxObjectIndex + 1, -1);
+		vector<int> closestOfScene((size_t)maxSceneIndex + 1, -1);
+		for (size_t e = 0; e < count; ++e) {
+			float distance = knnMatches[queries[e]][0].distance;
+			int& bestOfObject = closestOfObject[objects[e]];
+			if (bestOfObject < 0 || distance < knnMatches[queries[bestOfObject]][0].distance) {
+				bestOfObject = (int)e;
+			}
+			int& bestOfScene = closestOfScene[scenes[e]];
+			if (bestOfScene < 0 || distance < knnMatches[queries[bestOfScene]][0].distance) {
+				bestOfScene = (int)e;
+			}
+		}
+		for (size_t e = 0; e < count; ++e) {
+			accepted[e] = closestOfObject[objects[e]] == (int)e && closestOfScene[scenes[e]] == (int)e;
+			result.crossCheckRejected_ += accepted[e] ? 0 : 1;
+		}
+	}
+
+	//the queries with only one neighbour always pass, the rest is given by the n-th smallest ratio
+	size_t singles = 0;
+	vector<double> candidates;
+	candidates.reserve(count);
+	for (size_t e = 0; e < count; ++e) {
+		if (!accepted[e]) {
+			continue;
+		}
+		if (ratios[e] < 0) {
+			++singles;
+		}
+		//NaN ratio (both distances zero) never passes the test
+		else if (!isnan(ratios[e])) {
+			candidates.push_back(ratios[e]);
+		}
+	}
+	size_t needed = singles >= MIN_FILTERED_MATCHES ? 0 : MIN_FILTERED_MATCHES - singles;
+	double selectedRatio = numeric_limits<double>::infinity();
+	if (needed > 0 && candidates.size() >= needed) {
+		nth_element(candidates.begin(), candidates.begin() + (needed - 1), candidates.end());
+		selectedRatio = candidates[needed - 1];
+	}
+
+	//the same sequence of the thresholds as the relaxation loop (the step is added the same way)
+	size_t steps = 0;
+	for (double threshold = alpha_; threshold < 1; threshold += RATIO_TEST_ALPHA_STEP) {
+		++steps;
+		result.ratioThreshold_ = threshold;
+		if (needed == 0 || selectedRatio < threshold) {
+			break;
+		}
+	}
+	//alpha 1 - nothing is filtered
+	if (steps == 0) {
+		result = SFilteredMatches();
+		return;
+	}
+
+	//in the scene to object direction several scene features can lead to the same object feature, so the object features are counted only once
+	vector<bool> objectFeatureCounted;
+	for (size_t e = 0; e < count; ++e) {
+		if (!accepted[e]) {
+			continue;
+		}
+		if (ratios[e] < 0 || ratios[e] < alpha_) {
+			++result.firstFilteredSize_;
+			size_t objectFeature = (size_t)objects[e];
+			if (objectFeature >= objectFeatureCounted.size()) {
+				objectFeatureCounted.resize(objectFeature + 1, false);
+			}
+			if (!objectFeatureCounted[objectFeature]) {
+				objectFeatureCounted[objectFeature] = true;
+				++result.firstFilteredObjectFeatures_;
+			}
+		}
+		if (ratios[e] < 0 || ratios[e] < result.ratioThreshold_) {
+			result.matches_.emplace_back(objects[e], scenes[e], knnMatches[queries[e]][0].distance);
+		}
+	}
+
+	//every step accumulated all the queries again: average = sum / (weight + 1)
+	double weight = (double)steps * (double)count;
+	result.avarageDistance_ = (double)steps * distancesSum / (weight + 1.0);
+	if (allHaveSecond) {
+		result.avarageFirstToSecondRatio_ = (double)steps * ratiosSum / (weight + 1.0);
+		return;
+	}
+	//the weight grows also with the queries without the ratio, so the running average is replayed
+	double avarageWeight = 0.0, avarageRatio = 0.0;
+	for (size_t step = 0; step < steps; ++step) {
+		for (double ratio : ratios) {
+			++avarageWeight;
+			if (ratio >= 0 || isnan(ratio)) {
+				avarageRatio = ((avarageRatio * avarageWeight) + ratio) / (1 + avarageWeight);
+			}
+		}
+	}
+	result.avarageFirstToSecondRatio_ = avarageRatio;
+}
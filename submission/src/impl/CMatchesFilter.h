@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CMatchesFilter.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class that filters the knn matches by the adaptive Lowe's ratio test
+ *
+ *  The ratio test starts with the configured alpha and it is relaxed by fixed steps until enough matches pass it
+ *  (or the alpha reaches 1). The effective threshold is found by selection over the ratios computed once.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+//DMatch
+#include <opencv2/core/types.hpp>
+
+#include "SProcessParams.h"
+#include "parameters.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Result of the filtering of the knn matches
+*/
+struct SFilteredMatches {
+	vector<DMatch> matches_; ///< matches that passed the ratio test with the effective threshold (query is the object, train is the scene)
+	size_t firstFilteredSize_ = 0; ///< number of the matches that passed the ratio test with the configured alpha
+	size_t firstFilteredObjectFeatures_ = 0; ///< number of the distinct object features (queryIdx) of the matches that passed the ratio test with the configured alpha (the same in both matching directions)
+	double ratioThreshold_ = 0.0; ///< effective threshold of the ratio test (0 if the test was not done at all)
+	size_t crossCheckRejected_ = 0; ///< number of the found matches rejected by the cross check
+	double minDistance_ = numeric_limits<double>::max(); ///< minimal distance of the nearest neighbours
+	double maxDistance_ = 0.0; ///< maximal distance of the nearest neighbours
+	double avarageDistance_ = 0.0; ///< running average distance of the nearest neighbours (the same statistic as the original iterative filtering)
+	double avarageFirstToSecondRatio_ = 0.0; ///< running average first to second ratio (the same statistic as the original iterative filtering)
+};
+
+/**
+ * @brief Class that filters the knn matches by the adaptive Lowe's ratio test (and optionally by the cross check)
+ * 
+ * The knn matches are scanned only once into the flat arrays (first distance, first to second ratio, object and scene index).
+ * The number of the relaxation steps is then given by the n-th smallest ratio (n is the number of the missing matches),
+ * so the matches are not rescanned for every step of the threshold.
+ * 
+ * The running averages of the original iterative filtering were accumulated over all the relaxation steps,
+ * they are reproduced from the sums (or by replaying the flat ratios if some query has only one neighbour).
+ * 
+ * The cross check makes the found matches one-to-one, every object feature and every scene feature keeps only its closest match.
+ * It is not the mutual nearest neighbours check, only the found nearest neighbours are compared.
+ * 
+*/
+class CMatchesFilter
+{
+	const double alpha_; ///< the configured alpha of the ratio test
+	const bool crossCheck_; ///< whether the cross check is done
+public:
+	/**
+	 * @brief Constructor
+	 * @param params the parameters with the ratio test alpha and the matching parameters
+	*/
+	CMatchesFilter(const SProcessParams& params);
+	/**
+	 * @brief Filters the knn matches
+	 * @param knnMatches knn matches, the queries with no match are skipped, the queries with only one match always pass the ratio test
+	 * (only the distance of the second neighbour is used)
+	 * @param sceneIsQuery false if the query of the knn matches is the object and the train is the scene, true if it is turned around
+	 * @param result output result of the filtering
+	*/
+	void filter(const vector<vector<DMatch>>& knnMatches, bool sceneIsQuery, SFilteredMatches& result) const;
+};
@@ -4,14 +4,24 @@
 CObjectInSceneFinder::CObjectInSceneFinder(const SProcessParams& params, Ptr<CLogger> &logger, const string& runName, const string& sceneFilePath, const vector<string>& objectFilePaths)
 	:
 	params_(params),
-	logger_(logger)
+	logger_(logger),
+	gpsPrior_(params.gpsPriorParams_)
 {
 	detectorExtractor_ = CImage::createDetectorExtractor(params);
 	if (logger_.empty()) {
 		throw invalid_argument("CObjectInSceneFinder constructor was called with empty pointer to logger (CLogger) object.");
 	}
 	logger_->logSection("Run: " + runName, 0);
-	CImageBuilder bobTheBuilder; //Kabt Brokt toto schvaluje
+	if (params_.cacheParams_.enabled_) {
+		descriptorCache_ = makePtr<CDescriptorCache>(params_.cacheParams_, params_);
+	}
+	if (params_.threadingParams_.extractionThreads_ != 1) {
+		processingPool_ = makePtr<CImageProcessingPool>(params_, params_.threadingParams_.extractionThreads_);
+	}
+	if (params_.threadingParams_.matchingThreads_ != 1) {
+		matchingPool_ = makePtr<CWorkStealingPool>(params_.threadingParams_.matchingThreads_);
+	}
+	CImageBuilder bobTheBuilder(descriptorCache_); //Kabt Brokt toto schvaluje
 	sceneImage_ = bobTheBuilder.build(sceneFilePath, params, true, logger);
 	for (auto& it : objectFilePaths) {
 		objectImages_.push_back(bobTheBuilder.build(it, params, false, logger));
@@ -19,55 +29,620 @@ CObjectInSceneFinder::CObjectInSceneFinder(const SProcessParams& params, Ptr<CLo
 	logger_->log("images loaded").endl();
 }
 
+CObjectInSceneFinder::CObjectInSceneFinder(const SProcessParams& params, Ptr<CLogger>& logger, const string& runName, const vector<string>& objectFilePaths)
+	:
+	params_(params),
+	logger_(logger),
+	gpsPrior_(params.gpsPriorParams_)
+{
+	detectorExtractor_ = CImage::createDetectorExtractor(params);
+	if (logger_.empty()) {
+		throw invalid_argument("CObjectInSceneFinder constructor was called with empty pointer to logger (CLogger) object.");
+	}
+	logger_->logSection("Run: " + runName, 0);
+	if (params_.cacheParams_.enabled_) {
+		descriptorCache_ = makePtr<CDescriptorCache>(params_.cacheParams_, params_);
+	}
+	if (params_.threadingParams_.extractionThreads_ != 1) {
+		processingPool_ = makePtr<CImageProcessingPool>(params_, params_.threadingParams_.extractionThreads_);
+	}
+	if (params_.threadingParams_.matchingThreads_ != 1) {
+		matchingPool_ = makePtr<CWorkStealingPool>(params_.threadingParams_.matchingThreads_);
+	}
+	CImageBuilder bobTheBuilder(descriptorCache_);
+	for (auto& it : objectFilePaths) {
+		objectImages_.push_back(bobTheBuilder.build(it, params, false, logger));
+	}
+	logger_->log("reference images loaded").endl();
+}
+
+void CObjectInSceneFinder::setScene(const Ptr<CImage>& scene)
+{
+	sceneImage_ = scene;
+	sceneMatcher_.release();
+	matches_.clear();
+	bestMatchExist_ = false;
+}
+
+void CObjectInSceneFinder::setGpsPrior(const SGpsPriorParams& prior)
+{
+	if (prior.enabled_ && (!sio::numberInRange<double>(prior.longitude_, -180.0, 180.0) || !sio::numberInRange<double>(prior.latitude_, -89.0, 89.0))) {
+		throw invalid_argument("CObjectInSceneFinder: GPS prior longitude has to be in range <-180, 180> and latitude in range <-89, 89>.");
+	}
+	if (prior.enabled_ && !(prior.radius_ > 0)) {
+		throw invalid_argument("CObjectInSceneFinder: GPS prior radius has to be positive value.");
+	}
+	gpsPrior_ = prior;
+}
+
 //=================================================================================================
 
-void CObjectInSceneFinder::run( const string& runName, bool viewResult)
+void CObjectInSceneFinder::selectObjectsInRange()
 {
-	if (logger_.empty()) {
-		throw invalid_argument(
-			string("CObjectInSceneFinder: method run was called but the logger is empty") +
-			"(the given logger in constructor has to stay valid for the whole lifetime of CObjectInSceneFinder),");
+	objectInRange_.assign(objectImages_.size(), true);
+	if (!gpsPrior_.enabled_) {
+		return;
+	}
+	//the facades of the objects do not change, the index is built only once
+	if (gpsIndex_.empty()) {
+		gpsIndex_ = makePtr<CGpsPriorIndex>(objectImages_);
 	}
-	//set begin time
 	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	vector<size_t> inRange = gpsIndex_->query(gpsPrior_);
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	if (inRange.empty()) {
+		logger_->log("GPS prior: no object is within ").log(to_string(gpsPrior_.radius_)).log("[m], all the objects are used.").endl();
+		return;
+	}
+	objectInRange_.assign(objectImages_.size(), false);
+	for (auto& it : inRange) {
+		objectInRange_[it] = true;
+	}
+	logger_->log("GPS prior: ").log(to_string(inRange.size())).log(" of ").log(to_string(objectImages_.size()))
+		.log(" objects are within ").log(to_string(gpsPrior_.radius_)).log("[m], took: ")
+		.log(to_string(chrono::duration_cast<chrono::microseconds>(end - begin).count())).log("[us]").endl();
+}
 
-	logger_->logSection("detectig and describing features", 1);
+bool CObjectInSceneFinder::needsProcessing(size_t objectIndex) const
+{
+	return objectInRange_[objectIndex] || params_.retrievalParams_.enabled_ || params_.retrievalParams_.globalIndex_;
+}
+
+void CObjectInSceneFinder::detectDescribeSequential()
+{
 	logger_->logSection("Scene", 2);
 	//prepare the scene
 	sceneImage_->process(params_, logger_, detectorExtractor_);
 
 	//prepare the object
 	logger_->logSection("Objects", 2);
-	for (auto& ptr : objectImages_) {
+	for (size_t i = 0; i < objectImages_.size(); ++i) {
+		Ptr<CImage>& ptr = objectImages_[i];
+		if (!needsProcessing(i)) {
+			continue;
+		}
+		//already loaded from the descriptor cache
+		if (ptr->wasProcessed()) {
+			logger_->log("Image with filepath: " + ptr->getFilePath() + " was already processed (descriptor cache or previous scene).").endl();
+			continue;
+		}
 		ptr->process(params_, logger_, detectorExtractor_);
+		if (!descriptorCache_.empty()) {
+			descriptorCache_->store(*ptr, logger_);
+		}
 	}
+}
 
-	logger_->logSection("Timing", 2);
-	chrono::steady_clock::time_point afterDetectingDescring = chrono::steady_clock::now();
-	logger_->log("Detecting and describing all features took: ").
-		log(to_string(chrono::duration_cast<chrono::milliseconds>(afterDetectingDescring - begin).count())).
-		log("[ms]").endl();
+void CObjectInSceneFinder::detectDescribeConcurrent()
+{
+	//the scene is processed together with the objects that were not loaded from the descriptor cache
+	vector<Ptr<CImage>> toProcess;
+	vector<bool> objectLoadedFromCache(objectImages_.size());
+	toProcess.push_back(sceneImage_);
+	for (size_t i = 0; i < objectImages_.size(); ++i) {
+		if (!needsProcessing(i)) {
+			continue;
+		}
+		objectLoadedFromCache[i] = objectImages_[i]->wasProcessed();
+		if (!objectLoadedFromCache[i]) {
+			toProcess.push_back(objectImages_[i]);
+		}
+	}
 
-	logger_->logSection("Matching", 1);
-	//searching for the scene object matching combination with lowest avarage distance of matches
-	double featuresToMatchesRatio = 0.0;//numeric_limits<double>::max();
-	size_t bestScoreIndex = 0;
-	//that many matches will be created
-	matches_.reserve(objectImages_.size());
+	vector<Ptr<CBufferLogger>> logs = processingPool_->process(toProcess, 2);
+
+	//the logs are replayed in the same order as in the sequential processing
+	logger_->logSection("Scene", 2);
+	logs[0]->replay(*logger_);
+	logger_->logSection("Objects", 2);
+	size_t processedIndex = 1;
 	for (size_t i = 0; i < objectImages_.size(); ++i) {
+		if (!needsProcessing(i)) {
+			continue;
+		}
+		if (objectLoadedFromCache[i]) {
+			logger_->log("Image with filepath: " + objectImages_[i]->getFilePath() + " was already processed (descriptor cache or previous scene).").endl();
+			continue;
+		}
+		logs[processedIndex++]->replay(*logger_);
+		if (!descriptorCache_.empty()) {
+			descriptorCache_->store(*objectImages_[i], logger_);
+		}
+	}
+	logger_->log("Features were detected and described by ").log(to_string(processingPool_->getThreadsCount())).log(" threads.").endl();
+}
+
+void CObjectInSceneFinder::quantizeReferences()
+{
+	size_t floatBytes = 0, quantizedBytes = 0;
+	for (auto& object : objectImages_) {
+		//object out of the range of the GPS prior
+		if (!object->wasProcessed()) {
+			continue;
+		}
+		if (!object->hasQuantizedDescriptors()) {
+			floatBytes += object->getDescriptors().total() * object->getDescriptors().elemSize();
+			object->quantizeDescriptors();
+		}
+		quantizedBytes += object->getQuantizedDescriptors().total() * object->getQuantizedDescriptors().elemSize();
+	}
+	logger_->log("Reference descriptors were quantized, memory of the descriptors: ").log(to_string(quantizedBytes / 1024)).log(" kB");
+	if (floatBytes > 0) {
+		logger_->log(" (float descriptors: ").log(to_string(floatBytes / 1024)).log(" kB)");
+	}
+	logger_->endl();
+}
+
+void CObjectInSceneFinder::packBinaryDescriptors()
+{
+	sceneImage_->packBinaryDescriptors();
+	size_t bytes = sceneImage_->getPackedDescriptors().bytes();
+	for (auto& object : objectImages_) {
+		//object out of the range of the GPS prior
+		if (!object->wasProcessed()) {
+			continue;
+		}
+		object->packBinaryDescriptors();
+		bytes += object->getPackedDescriptors().bytes();
+	}
+	logger_->log("Binary descriptors were packed, memory of the packed descriptors: ").log(to_string(bytes / 1024)).log(" kB").endl();
+}
+
+//=================================================================================================
+
+void CObjectInSceneFinder::buildVocabulary()
+{
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	vector<Mat> descriptors;
+	descriptors.reserve(objectImages_.size());
+	for (auto& object : objectImages_) {
+		descriptors.push_back(object->getDescriptors());
+	}
+	vocabulary_ = makePtr<CVocabularyTree>(params_.retrievalParams_);
+	vocabulary_->train(descriptors);
+	for (auto& it : descriptors) {
+		vocabulary_->add(it);
+	}
+	vocabulary_->finalize();
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	logger_->log("Vocabulary was built, visual words: ").log(to_string(vocabulary_->getWordsCount()))
+		.log(", indexed objects: ").log(to_string(vocabulary_->getImagesCount()))
+		.log(", took: ").log(to_string(chrono::duration_cast<chrono::milliseconds>(end - begin).count())).log("[ms]").endl();
+}
+
+void CObjectInSceneFinder::selectCandidates()
+{
+	candidates_.clear();
+	if (vocabulary_.empty()) {
+		for (size_t i = 0; i < objectImages_.size(); ++i) {
+			if (objectInRange_[i]) {
+				candidates_.push_back(i);
+			}
+		}
+		return;
+	}
+
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	vector<SRetrievalCandidate> shortlist = vocabulary_->query(sceneImage_->getDescriptors(), (size_t)params_.retrievalParams_.shortlistSize_);
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	logger_->log("Vocabulary short list (").log(to_string(shortlist.size())).log(" of ").log(to_string(objectImages_.size()))
+		.log(" objects) took: ").log(to_string(chrono::duration_cast<chrono::microseconds>(end - begin).count())).log("[us]").endl();
+	for (auto& it : shortlist) {
+		if (!objectInRange_[it.imageIndex_]) {
+			continue;
+		}
+		logger_->log("  Compare index: ").log(to_string(it.imageIndex_)).log(", score: ").log(to_string(it.score_))
+			.log(", filepath: ").log(objectImages_[it.imageIndex_]->getFilePath()).endl();
+		candidates_.push_back(it.imageIndex_);
+	}
+	//no object of the short list is within the range of the GPS prior -> all the objects in the range
+	if (candidates_.empty()) {
+		logger_->log("  No object of the short list is within the range of the GPS prior, all the objects in the range are used.").endl();
+		for (size_t i = 0; i < objectImages_.size(); ++i) {
+			if (objectInRange_[i]) {
+				candidates_.push_back(i);
+			}
+		}
+	}
+}
+
+STrainedMatchers CObjectInSceneFinder::getTrainedMatchers(size_t objectIndex)
+{
+	STrainedMatchers matchers;
+	//the quantized and packed descriptors are matched by the brute force kernels without any index
+	if (params_.storageParams_.quantizeReferences_ || params_.storageParams_.packBinaryDescriptors_) {
+		return matchers;
+	}
+	const Ptr<CImage>& object = objectImages_[objectIndex];
+	//the empty side is not indexed, the matcher created per pair handles it
+	if (object->getKeypoints().empty() || sceneImage_->getKeypoints().empty()) {
+		return matchers;
+	}
+
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	if (CImagesMatch::sceneIsQuery(params_, object->getKeypoints().size(), sceneImage_->getKeypoints().size())) {
+		objectMatchers_.resize(objectImages_.size());
+		if (objectMatchers_[objectIndex].empty()) {
+			objectMatchers_[objectIndex] = CImagesMatch::createMatcher(params_);
+			objectMatchers_[objectIndex]->add(object->getDescriptors());
+			objectMatchers_[objectIndex]->train();
+		}
+		matchers.objectMatcher_ = objectMatchers_[objectIndex];
+	}
+	else {
+		if (sceneMatcher_.empty()) {
+			sceneMatcher_ = CImagesMatch::createMatcher(params_);
+			sceneMatcher_->add(sceneImage_->getDescriptors());
+			sceneMatcher_->train();
+		}
+		matchers.sceneMatcher_ = sceneMatcher_;
+	}
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	matchersTrainingMs_ += chrono::duration_cast<chrono::microseconds>(end - begin).count() / 1000.0;
+	return matchers;
+}
+
+int CObjectInSceneFinder::cascadeRejection(size_t objectIndex, const Ptr<DescriptorMatcher>& sceneMatcher, double bestRatio)
+{
+	const Ptr<CImage>& object = objectImages_[objectIndex];
+	const int featuresCount = (int)object->getKeypoints().size();
+	const int firstStageSize = max(CASCADE_MIN_SUBSET_SIZE, (int)(params_.cascadeParams_.subsetRatio_ * featuresCount));
+	if (firstStageSize >= featuresCount) {
+		return 0;
+	}
+	const int secondStageSize = min(featuresCount, firstStageSize * CASCADE_SECOND_STAGE_FACTOR);
+
+	//the descriptors with the strongest response, the objects are kept for all the scenes so they are ordered only once
+	cascadeSubsets_.resize(objectImages_.size());
+	if (cascadeSubsets_[objectIndex].empty()) {
+		vector<int> order(featuresCount);
+		for (int i = 0; i < featuresCount; ++i) {
+			order[i] = i;
+		}
+		const vector<KeyPoint>& keypoints = object->getKeypoints();
+		partial_sort(order.begin(), order.begin() + secondStageSize, order.end(), [&keypoints](int a, int b) {
+			return keypoints[a].response > keypoints[b].response;
+		});
+		cascadeSubsets_[objectIndex].create(secondStageSize, object->getDescriptors().cols, object->getDescriptors().type());
+		for (int i = 0; i < secondStageSize; ++i) {
+			object->getDescriptors().row(order[i]).copyTo(cascadeSubsets_[objectIndex].row(i));
+		}
+	}
+
+	const int stageSizes[] = { firstStageSize, secondStageSize };
+	for (int stage = 0; stage < 2; ++stage) {
+		if (stage > 0 && stageSizes[stage] >= featuresCount) {
+			break;
+		}
+		vector<vector<DMatch>> knnMatches;
+		sceneMatcher->knnMatch(cascadeSubsets_[objectIndex].rowRange(0, stageSizes[stage]), knnMatches, 2);
+		SFilteredMatches filtered;
+		CMatchesFilter(params_).filter(knnMatches, false, filtered);
+		double upperBound = (double)(filtered.firstFilteredSize_ + featuresCount - stageSizes[stage]) / featuresCount;
+		double estimate = (double)filtered.firstFilteredSize_ / stageSizes[stage];
+		//the first best object stays the best on the tie
+		if (min(upperBound, estimate + params_.cascadeParams_.tolerance_) <= bestRatio) {
+			logger_->log("Rejected by the cascade stage ").log(to_string(stage + 1)).log(" (").log(to_string(stageSizes[stage])).log(" of ")
+				.log(to_string(featuresCount)).log(" features), subset ratio: ").log(to_string(estimate))
+				.log(", upper bound: ").log(to_string(upperBound)).log(", best ratio: ").log(to_string(bestRatio)).endl();
+			return stage + 1;
+		}
+		//the subset is already better than the best, the next stage would not reject it
+		if (estimate > bestRatio) {
+			break;
+		}
+	}
+	return 0;
+}
+
+size_t CObjectInSceneFinder::matchCandidates()
+{
+	matchersTrainingMs_ = 0.0;
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	//the cascade needs the subset queries to give the same results as the full matching (the shared scene index)
+	const bool cascade = params_.cascadeParams_.enabled_ && !params_.storageParams_.quantizeReferences_ && !params_.storageParams_.packBinaryDescriptors_;
+	size_t stageRejects[2] = { 0, 0 };
+	double bestRatio = -1.0;
+	vector<size_t> matchedCandidates;
+	//that many matches will be created
+	matches_.reserve(candidates_.size());
+	for (size_t i = 0; i < candidates_.size(); ++i) {
 		//computing the keypoints, descriptors, matches
 		//move construction
-		logger_->endl().log("Compare index: ").log(to_string(i)).endl();
-		logger_->log("Matching scene with object that has filepath: ").log(objectImages_[i]->getFilePath()).endl();
-		matches_.emplace_back(CImagesMatch(objectImages_[i], sceneImage_, logger_, params_));
+		logger_->endl().log("Compare index: ").log(to_string(candidates_[i])).endl();
+		logger_->log("Matching scene with object that has filepath: ").log(objectImages_[candidates_[i]]->getFilePath()).endl();
+		STrainedMatchers matchers = getTrainedMatchers(candidates_[i]);
+		if (cascade && bestRatio >= 0 && !matchers.sceneMatcher_.empty()) {
+			int stage = cascadeRejection(candidates_[i], matchers.sceneMatcher_, bestRatio);
+			if (stage > 0) {
+				++stageRejects[stage - 1];
+				continue;
+			}
+		}
+		matches_.emplace_back(CImagesMatch(objectImages_[candidates_[i]], sceneImage_, logger_, params_, matchers));
+		matchedCandidates.push_back(candidates_[i]);
+		bestRatio = max(bestRatio, matches_.back().getMatchedObjectFeaturesRatio());
+	}
+	if (cascade) {
+		logger_->endl().log("Cascade rejected in the first stage: ").log(to_string(stageRejects[0]))
+			.log(", in the second stage: ").log(to_string(stageRejects[1]))
+			.log(", fully matched: ").log(to_string(matchedCandidates.size())).log(" of ").log(to_string(candidates_.size())).endl();
+	}
+	candidates_ = move(matchedCandidates);
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	logger_->endl().log("Pairwise matching of ").log(to_string(candidates_.size())).log(" objects took: ")
+		.log(to_string(chrono::duration_cast<chrono::milliseconds>(end - begin).count())).log("[ms], training of the shared matchers: ")
+		.log(to_string(matchersTrainingMs_)).log("[ms]").endl();
+	return selectBestMatch();
+}
+
+size_t CObjectInSceneFinder::matchCandidatesConcurrent()
+{
+	matchersTrainingMs_ = 0.0;
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	//the lazy training is not thread safe, so all the needed matchers are trained first
+	vector<STrainedMatchers> matchers(candidates_.size());
+	for (size_t i = 0; i < candidates_.size(); ++i) {
+		matchers[i] = getTrainedMatchers(candidates_[i]);
+	}
+
+	vector<Ptr<CBufferLogger>> logs(candidates_.size());
+	vector<Ptr<CImagesMatch>> results(candidates_.size());
+	vector<double> ratios(candidates_.size());
+	const size_t noMatch = numeric_limits<size_t>::max();
+	atomic<size_t> bestIndex(noMatch);
+	for (size_t i = 0; i < candidates_.size(); ++i) {
+		logs[i] = makePtr<CBufferLogger>(true, 1);
+	}
+
+	matchingPool_->run(candidates_.size(), [&](size_t i) {
+		logs[i]->endl().log("Compare index: ").log(to_string(candidates_[i])).endl();
+		logs[i]->log("Matching scene with object that has filepath: ").log(objectImages_[candidates_[i]]->getFilePath()).endl();
+		results[i] = makePtr<CImagesMatch>(objectImages_[candidates_[i]], sceneImage_, logs[i].get(), params_, matchers[i]);
+		ratios[i] = results[i]->getMatchedObjectFeaturesRatio();
+		//the ratio is written before the index is published (release), the other threads read it after they load the index (acquire)
+		size_t current = bestIndex.load(memory_order_acquire);
+		while (current == noMatch || ratios[i] > ratios[current] || (ratios[i] == ratios[current] && i < current)) {
+			if (bestIndex.compare_exchange_weak(current, i, memory_order_acq_rel, memory_order_acquire)) {
+				break;
+			}
+		}
+	});
+
+	matches_.reserve(candidates_.size());
+	for (size_t i = 0; i < candidates_.size(); ++i) {
+		logs[i]->replay(*logger_);
+		matches_.emplace_back(move(*results[i]));
+	}
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	logger_->endl().log("Pairwise matching of ").log(to_string(candidates_.size())).log(" objects by ").log(to_string(matchingPool_->getThreadsCount()))
+		.log(" threads took: ").log(to_string(chrono::duration_cast<chrono::milliseconds>(end - begin).count())).log("[ms], training of the shared matchers: ")
+		.log(to_string(matchersTrainingMs_)).log("[ms]").endl();
+	return bestIndex.load() == noMatch ? 0 : bestIndex.load();
+}
 
+size_t CObjectInSceneFinder::verifyTopCandidates(size_t bestScoreIndex)
+{
+	const SVerificationParams& params = params_.verificationParams_;
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	//the candidates ordered by the ratio (the winner of the ranking is the first one)
+	vector<size_t> order;
+	order.push_back(bestScoreIndex);
+	for (size_t i = 0; i < matches_.size(); ++i) {
+		if (i != bestScoreIndex) {
+			order.push_back(i);
+		}
+	}
+	stable_sort(order.begin() + 1, order.end(), [this](size_t a, size_t b) {
+		return matches_[a].getMatchedObjectFeaturesRatio() > matches_[b].getMatchedObjectFeaturesRatio();
+	});
+	order.resize(min(order.size(), (size_t)params.topK_));
+
+	size_t bestIndex = bestScoreIndex;
+	verification_.done_ = true;
+	for (size_t rank = 0; rank < order.size(); ++rank) {
+		size_t inliers = matches_[order[rank]].verifyHomography(params);
+		logger_->log("Verification of the compare index: ").log(to_string(candidates_[order[rank]])).log(", inliers: ").log(to_string(inliers))
+			.log(" of ").log(to_string(matches_[order[rank]].getNumberOfMatches())).log(" matches, took: ")
+			.log(to_string(matches_[order[rank]].getGeometryStats().homographyMs_)).log("[ms]").endl();
+		if (rank == 0 || inliers > verification_.inliers_) {
+			verification_.secondInliers_ = rank == 0 ? 0 : verification_.inliers_;
+			verification_.inliers_ = inliers;
+			bestIndex = order[rank];
+		}
+		else if (inliers > verification_.secondInliers_) {
+			verification_.secondInliers_ = inliers;
+		}
+	}
+	if (verification_.inliers_ > 0) {
+		verification_.inlierRate_ = (double)verification_.inliers_ / (double)matches_[bestIndex].getNumberOfMatches();
+		verification_.confidence_ = verification_.inlierRate_ * (1.0 - (double)verification_.secondInliers_ / (double)verification_.inliers_);
+	}
+	verification_.verified_ = verification_.inliers_ >= (size_t)params.minInliers_ && verification_.confidence_ >= params.minConfidence_;
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	logger_->log("Geometric verification of ").log(to_string(order.size())).log(" candidates took: ")
+		.log(to_string(chrono::duration_cast<chrono::milliseconds>(end - begin).count())).log("[ms], inliers: ").log(to_string(verification_.inliers_))
+		.log(", inlier rate: ").log(to_string(verification_.inlierRate_)).log(", confidence: ").log(to_string(verification_.confidence_))
+		.log(verification_.verified_ ? " - verified" : " - rejected").endl();
+	return bestIndex;
+}
+
+size_t CObjectInSceneFinder::selectBestMatch() const
+{
+	//searching for the scene object matching combination with highest ratio of the matched object features
+	double featuresToMatchesRatio = 0.0;
+	size_t bestScoreIndex = 0;
+	for (size_t i = 0; i < matches_.size(); ++i) {
 		//checking if the match is possible to be the best until now
-		double currentRatio = matches_.back().getMatchedObjectFeaturesRatio();//matches_.back().getAvarageMatchesDistance();
+		double currentRatio = matches_[i].getMatchedObjectFeaturesRatio();
 		if (currentRatio > featuresToMatchesRatio) {
 			bestScoreIndex = i;
 			featuresToMatchesRatio = currentRatio;
 		}
-		bestMatchExist_ = true;
+	}
+	return bestScoreIndex;
+}
+
+size_t CObjectInSceneFinder::matchGlobalIndex()
+{
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+	SGlobalMatches globalMatches = globalIndex_->match(*sceneImage_, params_.loweRatioTestAlpha_);
+	chrono::steady_clock::time_point end = chrono::steady_clock::now();
+	logger_->log("Scene was matched against the global index (").log(to_string(globalIndex_->size())).log(" descriptors) in one pass, took: ")
+		.log(to_string(chrono::duration_cast<chrono::milliseconds>(end - begin).count())).log("[ms]").endl();
+
+	candidates_.clear();
+	for (size_t i = 0; i < objectImages_.size(); ++i) {
+		if (objectInRange_[i] && !globalMatches.imagesKnnMatches_[i].empty()) {
+			candidates_.push_back(i);
+		}
+	}
+	//no object got any match (e.g. scene without features) -> all the objects in the range have empty matches
+	if (candidates_.empty()) {
+		for (size_t i = 0; i < objectImages_.size(); ++i) {
+			if (objectInRange_[i]) {
+				candidates_.push_back(i);
+			}
+		}
+	}
+	stable_sort(candidates_.begin(), candidates_.end(), [&globalMatches](size_t a, size_t b) {
+		return globalMatches.votes_[a] > globalMatches.votes_[b];
+	});
+
+	matches_.reserve(candidates_.size());
+	for (size_t i = 0; i < candidates_.size(); ++i) {
+		size_t objectIndex = candidates_[i];
+		logger_->endl().log("Compare index: ").log(to_string(objectIndex)).log(", votes: ").log(to_string(globalMatches.votes_[objectIndex])).endl();
+		logger_->log("Statistics of the object that has filepath: ").log(objectImages_[objectIndex]->getFilePath()).endl();
+		matches_.emplace_back(CImagesMatch(objectImages_[objectIndex], sceneImage_, globalMatches.imagesKnnMatches_[objectIndex], true,
+			globalIndex_->getImageFeaturesCount(objectIndex), logger_, params_));
+	}
+	return selectBestMatch();
+}
+
+void CObjectInSceneFinder::measureHnswRecall()
+{
+	const CImagesMatch& bestMatch = matches_[bestMatchIndex_];
+	if (bestMatch.getObjectImage()->hasQuantizedDescriptors()) {
+		logger_->log("HNSW recall can't be measured with the quantized references.").endl();
+		return;
+	}
+	//the same direction as the pairwise matching - the object descriptors are the queries
+	double bruteForceMs = 0.0, buildMs = 0.0;
+	vector<SHnswRecall> measurements = CHnswMatcher::measureRecall(bestMatch.getSceneImage()->getDescriptors(), bestMatch.getObjectImage()->getDescriptors(),
+		params_.hnswParams_, HNSW_RECALL_EF_SEARCH_VALUES, bruteForceMs, buildMs);
+	logger_->logSection("HNSW recall vs latency", 2);
+	logger_->log("Train (scene) descriptors: ").log(to_string(bestMatch.getSceneImage()->getDescriptors().rows))
+		.log(", query (object) descriptors: ").log(to_string(bestMatch.getObjectImage()->getDescriptors().rows)).endl();
+	logger_->log("Brute force: ").log(to_string(bruteForceMs)).log("[ms], HNSW build: ").log(to_string(buildMs)).log("[ms]").endl();
+	for (auto& it : measurements) {
+		logger_->log("efSearch: ").log(to_string(it.efSearch_)).log(", recall@1: ").log(to_string(it.recall_))
+			.log(", search: ").log(to_string(it.latencyMs_)).log("[ms]").endl();
+	}
+}
+
+void CObjectInSceneFinder::benchmarkGemm()
+{
+	const CImagesMatch& bestMatch = matches_[bestMatchIndex_];
+	if (bestMatch.getObjectImage()->hasQuantizedDescriptors()) {
+		logger_->log("GEMM matching can't be benchmarked with the quantized references.").endl();
+		return;
+	}
+	vector<SGemmBenchmark> measurements = CGemmMatcher::benchmark(bestMatch.getObjectImage()->getDescriptors(), bestMatch.getSceneImage()->getDescriptors(),
+		GEMM_BENCHMARK_DESCRIPTORS_COUNTS);
+	logger_->logSection("GEMM matching vs BFMatcher", 2);
+	for (auto& it : measurements) {
+		logger_->log("Descriptors: ").log(to_string(it.descriptorsCount_)).log(" x ").log(to_string(it.descriptorsCount_))
+			.log(", BFMatcher: ").log(to_string(it.bruteForceMs_)).log("[ms], GEMM: ").log(to_string(it.gemmMs_))
+			.log("[ms], speedup: ").log(to_string(it.bruteForceMs_ / max(it.gemmMs_, 1e-3)))
+			.log(", agreement: ").log(to_string(it.agreement_)).endl();
+	}
+}
+
+//=================================================================================================
+
+void CObjectInSceneFinder::run( const string& runName, bool viewResult)
+{
+	if (logger_.empty()) {
+		throw invalid_argument(
+			string("CObjectInSceneFinder: method run was called but the logger is empty") +
+			"(the given logger in constructor has to stay valid for the whole lifetime of CObjectInSceneFinder),");
+	}
+	if (sceneImage_.empty()) {
+		throw logic_error("CObjectInSceneFinder: method run was called without a scene.");
+	}
+	//results of the previous scene
+	matches_.clear();
+	bestMatchExist_ = false;
+	localization_ = SLocalizationResult();
+	//set begin time
+	chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+
+	logger_->logSection("detectig and describing features", 1);
+	selectObjectsInRange();
+	if (processingPool_.empty()) {
+		detectDescribeSequential();
+	}
+	else {
+		detectDescribeConcurrent();
+	}
+	//the vocabulary and the global index are built from the float (not quantized) descriptors
+	if (params_.retrievalParams_.enabled_ && vocabulary_.empty()) {
+		buildVocabulary();
+	}
+	if (params_.retrievalParams_.globalIndex_ && globalIndex_.empty()) {
+		chrono::steady_clock::time_point indexBegin = chrono::steady_clock::now();
+		globalIndex_ = makePtr<CGlobalDescriptorIndex>(objectImages_, params_);
+		chrono::steady_clock::time_point indexEnd = chrono::steady_clock::now();
+		logger_->log("Global index of ").log(to_string(globalIndex_->size())).log(" object descriptors was built, took: ")
+			.log(to_string(chrono::duration_cast<chrono::milliseconds>(indexEnd - indexBegin).count())).log("[ms]").endl();
+	}
+	if (params_.storageParams_.quantizeReferences_) {
+		quantizeReferences();
+	}
+	if (params_.storageParams_.packBinaryDescriptors_) {
+		packBinaryDescriptors();
+	}
+
+	logger_->logSection("Timing", 2);
+	chrono::steady_clock::time_point afterDetectingDescring = chrono::steady_clock::now();
+	logger_->log("Detecting and describing all features took: ").
+		log(to_string(chrono::duration_cast<chrono::milliseconds>(afterDetectingDescring - begin).count())).
+		log("[ms]").endl();
+
+	logger_->logSection("Matching", 1);
+	size_t bestScoreIndex = 0;
+	if (!globalIndex_.empty()) {
+		bestScoreIndex = matchGlobalIndex();
+	}
+	else {
+		selectCandidates();
+		bestScoreIndex = matchingPool_.empty() ? matchCandidates() : matchCandidatesConcurrent();
+	}
+	bestMatchExist_ = !matches_.empty();
+	verification_ = SVerificationResult();
+	if (params_.verificationParams_.enabled_ && bestMatchExist_) {
+		bestScoreIndex = verifyTopCandidates(bestScoreIndex);
 	}
 
 	logger_->logSection("Timing", 2);
@@ -83,13 +658,37 @@ void CObjectInSceneFinder::run( const string& runName, bool viewResult)
 	bestMatchIndex_ = bestScoreIndex;
 
 	logger_->logSection("Results", 1);
+	//e.g. all the references are out of the range of the GPS prior
+	if (!bestMatchExist_) {
+		logger_->log("No object was matched with the scene, the result is not previewed and located.").endl();
+		return;
+	}
 	logger_->logSection("Detected image", 2);
-	logger_->log("Best object match for scene is object with compare index: ").log(to_string(bestMatchIndex_)).endl();
-	logger_->log("Best object match for scene is object with filepath: ").log(objectImages_[bestMatchIndex_]->getFilePath()).endl();
+	logger_->log("Best object match for scene is object with compare index: ").log(to_string(candidates_[bestMatchIndex_])).endl();
+	logger_->log("Best object match for scene is object with filepath: ").log(objectImages_[candidates_[bestMatchIndex_]]->getFilePath()).endl();
+	if (params_.matchingMethod_ == EAlgorithm::ALG_HNSW_MATCHING && params_.hnswParams_.measureRecall_) {
+		measureHnswRecall();
+	}
+	if (params_.matchingMethod_ == EAlgorithm::ALG_GEMM_MATCHING && params_.matchingParams_.benchmarkGemm_) {
+		benchmarkGemm();
+	}
 
-	if (viewResult) {
+	//the expensive 3D and GPS stages are not run for the unreliable result
+	if (verification_.done_ && !verification_.verified_) {
+		logger_->log("The best object did not pass the geometric verification, the result is not previewed and located.").endl();
+	}
+	else if (!viewResult) {
+		//headless run - only the localization is computed, nothing is drawn
+		localization_ = matches_[bestMatchIndex_].localize(logger_, params_);
+		chrono::steady_clock::time_point afterLocalization = chrono::steady_clock::now();
+		logger_->logSection("Timing", 2);
+		logger_->log("Localization took: ").
+			log(to_string(chrono::duration_cast<chrono::milliseconds>(afterLocalization - afterMatching).count())).
+			log("[ms]").endl();
+	}
+	else {
 
-		matches_[bestMatchIndex_].drawPreviewAndResult(runName, logger_, params_);
+		localization_ = matches_[bestMatchIndex_].drawPreviewAndResult(runName, logger_, params_);
 		logger_->logSection("The result object stats",2);
 		logger_->log("Avarage feature match distance: ").log(to_string(matches_[bestMatchIndex_].getAvarageMatchesDistance())).endl();
 		logger_->log("Average first to second ratio is  ").log(to_string(matches_[bestMatchIndex_].getAvarageFirstToSecondRatio())).endl();
@@ -118,10 +717,21 @@ void CObjectInSceneFinder::viewBestResult(const string& runName)
 			"(the given logger in constructor has to stay valid for the whole lifetime of CObjectInSceneFinder),");
 	}
 	if (bestMatchExist_) {
-		matches_[bestMatchIndex_].drawPreviewAndResult(runName, logger_, params_);
+		if (verification_.done_ && !verification_.verified_) {
+			logger_->log("The best object did not pass the geometric verification, the 3D and GPS location may be wrong.").endl();
+		}
+		localization_ = matches_[bestMatchIndex_].drawPreviewAndResult(runName, logger_, params_);
 	}
 	else {
 		throw logic_error("View of matches was called without computing matches first");
 	}
 
+}
+
+CImagesMatch& CObjectInSceneFinder::getBestMatch()
+{
+	if (!bestMatchExist_) {
+		throw logic_error("Best match was requested without computing matches first");
+	}
+	return matches_[bestMatchIndex_];
 }
\ No newline at end of file
@@ -24,8 +24,28 @@
 #include "CImagesMatch.h"
 #include "CImage.h"
 #include "CImageBuilder.h"
+#include "CDescriptorCache.h"
+#include "CImageProcessingPool.h"
+#include "CWorkStealingPool.h"
+#include "CBufferLogger.h"
+#include "CVocabularyTree.h"
+#include "CGlobalDescriptorIndex.h"
+#include "CGpsPriorIndex.h"
+#include "SpecializedInputOutput.h"
 
 
+/**
+ * @brief Result of the geometric verification of the best candidates
+*/
+struct SVerificationResult {
+	bool done_ = false; ///< whether the verification was done
+	bool verified_ = false; ///< whether the best candidate passed the verification (false - the result is not reliable, e.g. a wrong facade)
+	size_t inliers_ = 0; ///< number of the inliers of the best candidate
+	size_t secondInliers_ = 0; ///< number of the inliers of the second best candidate
+	double inlierRate_ = 0.0; ///< ratio of the inliers to the matches of the best candidate
+	double confidence_ = 0.0; ///< confidence score - inlier rate x (1 - second inliers / inliers)
+};
+
 /**
  * @brief Class that manages the other classes to find the best reference image for the scene
  * 
@@ -35,13 +55,130 @@
 */
 class CObjectInSceneFinder {
 	Ptr<CImage::CDetectorExtractor> detectorExtractor_; ///< detector extractor with which all the CImage processing is being called
+	Ptr<CDescriptorCache> descriptorCache_; ///< cache of the reference images features (empty if the cache is disabled)
+	Ptr<CImageProcessingPool> processingPool_; ///< pool of threads that process the images concurrently (empty if the processing is sequential)
+	Ptr<CWorkStealingPool> matchingPool_; ///< pool of threads that match the scene with the objects concurrently (empty if the matching is sequential)
+	Ptr<CVocabularyTree> vocabulary_; ///< vocabulary with the inverted files of the objects (empty if the retrieval is disabled or not built yet)
+	Ptr<CGlobalDescriptorIndex> globalIndex_; ///< single index of the descriptors of all the objects (empty if it is disabled or not built yet)
+	Ptr<CGpsPriorIndex> gpsIndex_; ///< spatial index of the facades of the objects (empty if the GPS prior is disabled or not built yet)
+	SGpsPriorParams gpsPrior_; ///< approximate position of the device for the current scene
+	vector<bool> objectInRange_; ///< whether the object is within the radius of the GPS prior (all true if the prior is disabled)
+	Ptr<DescriptorMatcher> sceneMatcher_; ///< matcher trained with the scene descriptors, shared by all the objects of the scene (empty until it is needed)
+	vector<Ptr<DescriptorMatcher>> objectMatchers_; ///< matchers trained with the object descriptors, kept for all the scenes (empty until they are needed)
+	double matchersTrainingMs_ = 0.0; ///< time spent by training of the matchers in the current run
+	vector<Mat> cascadeSubsets_; ///< descriptors of the objects ordered by the response of their keypoints (only the part used by the cascade, empty until it is needed)
 	const SProcessParams params_; ///<parameters used for the processing
 	Ptr<CLogger> logger_; ///< smart pointer to logger to which is being logged the results and all the process
 	Ptr<CImage> sceneImage_; ///< smart pointer to a scene in which the object is being searched
 	vector<Ptr<CImage>> objectImages_; ///< vector of smart pointers pointing to images of the objects that are being found in the image
 	vector<CImagesMatch> matches_; ///< vector in which all the matches are stored (matches between a scane and some reference object)
-	size_t bestMatchIndex_; ///< Index pointing to the best result, in other words the object that was "found" (doesn't has to be found) in the scene. (index in the objectImages_ vector)
+	vector<size_t> candidates_; ///< indices of the objects that were matched with the scene (in the objectImages_ vector, the same order as matches_)
+	size_t bestMatchIndex_; ///< Index pointing to the best result, in other words the object that was "found" (doesn't has to be found) in the scene. (index in the matches_ and candidates_ vectors)
 	bool bestMatchExist_ = false; ///< information whether bestMatchIndex_ is valid
+	SVerificationResult verification_; ///< result of the geometric verification of the current run
+	SLocalizationResult localization_; ///< localization of the camera by the best match of the current run
+
+	/**
+	 * @brief marks the objects within the radius of the GPS prior (all the objects if the prior is disabled or no object is in the range)
+	*/
+	void selectObjectsInRange();
+	/**
+	 * @brief Gives information whether the object has to be detected and described
+	 * 
+	 * The vocabulary and the global index are built from all the objects, so the objects out of the range are skipped only without them.
+	 * 
+	 * @param objectIndex index of the object in the objectImages_ vector
+	 * @return true if the object is processed in this run
+	*/
+	bool needsProcessing(size_t objectIndex) const;
+	/**
+	 * @brief detects and describes features of the scene and all the objects one by one (objects loaded from the descriptor cache are skipped)
+	*/
+	void detectDescribeSequential();
+	/**
+	 * @brief detects and describes features of the scene and all the objects concurrently in the processing pool (objects loaded from the descriptor cache are skipped)
+	 * 
+	 * The results and the log are the same as in the sequential processing.
+	 * 
+	*/
+	void detectDescribeConcurrent();
+	/**
+	 * @brief replaces the float descriptors of all the objects by the quantized ones (after they are detected, described and stored in the cache)
+	*/
+	void quantizeReferences();
+	/**
+	 * @brief packs the binary descriptors of the scene and all the objects for the popcount Hamming matching
+	*/
+	void packBinaryDescriptors();
+	/**
+	 * @brief trains the vocabulary by the descriptors of the objects and adds all the objects into its inverted files (only once, the objects are kept)
+	*/
+	void buildVocabulary();
+	/**
+	 * @brief chooses the objects that are matched with the scene (the short list of the vocabulary or all the objects, only the objects within the range of the GPS prior)
+	*/
+	void selectCandidates();
+	/**
+	 * @brief gives the trained matcher for the pair of the scene and the object (it is trained when it is needed for the first time)
+	 * 
+	 * The side that is indexed is chosen by the matching direction. The scene matcher is trained once per scene, the object matchers once per run of the app.
+	 * 
+	 * @param objectIndex index of the object in the objectImages_ vector
+	 * @return the trained matchers (empty if the brute force kernels of the quantized or packed descriptors are used)
+	*/
+	STrainedMatchers getTrainedMatchers(size_t objectIndex);
+	/**
+	 * @brief decides whether the object can be skipped because it can't beat the best object (cascade of the subsets of its descriptors)
+	 * 
+	 * Every stage matches the descriptors with the strongest response against the shared scene matcher. The results of these queries
+	 * are the same as in the full matching, so (passed + not matched) / all is the exact upper bound of the matched object features ratio.
+	 * The reference is also rejected when the ratio of the subset plus the tolerance can't beat the best.
+	 * 
+	 * @param objectIndex index of the object in the objectImages_ vector
+	 * @param sceneMatcher matcher trained with the scene descriptors
+	 * @param bestRatio the best matched object features ratio until now
+	 * @return the stage that rejected the object (0 if the object has to be matched fully)
+	*/
+	int cascadeRejection(size_t objectIndex, const Ptr<DescriptorMatcher>& sceneMatcher, double bestRatio);
+	/**
+	 * @brief matches the scene with the candidate objects one by one (pairwise matches), the objects rejected by the cascade are removed from the candidates
+	 * @return index of the best match in the matches_ vector
+	*/
+	size_t matchCandidates();
+	/**
+	 * @brief matches the scene with the candidate objects concurrently in the matching pool (pairwise matches)
+	 * 
+	 * The matchers are trained before the matching, then they are only read. The log of every object is buffered and replayed
+	 * in the order of the candidates, the matches are stored in the same order and the best index is reduced lock free
+	 * (the higher ratio, the lower index on the tie), so the result is the same as the sequential one regardless of the timing.
+	 * 
+	 * @return index of the best match in the matches_ vector
+	*/
+	size_t matchCandidatesConcurrent();
+	/**
+	 * @brief matches the scene against the global index in one pass, the objects with the matches are the candidates (ordered by their votes)
+	 * @return index of the best match in the matches_ vector
+	*/
+	size_t matchGlobalIndex();
+	/**
+	 * @brief verifies the top candidates by the robust homography, the candidate with the most inliers is the best (the higher ratio on the tie)
+	 * @param bestScoreIndex index of the best match by the ratio in the matches_ vector
+	 * @return index of the best verified match in the matches_ vector
+	*/
+	size_t verifyTopCandidates(size_t bestScoreIndex);
+	/**
+	 * @brief searches for the match with the highest matched object features ratio (the first one on the tie)
+	 * @return index of the best match in the matches_ vector (0 if there is no match)
+	*/
+	size_t selectBestMatch() const;
+	/**
+	 * @brief measures the recall and latency of the HNSW search against the brute force on the best match and logs them
+	*/
+	void measureHnswRecall();
+	/**
+	 * @brief measures the time of the GEMM matching against BFMatcher for several numbers of the descriptors of the best match and logs it
+	*/
+	void benchmarkGemm();
 public:
 	/**
 	 * @brief Constructor
@@ -54,6 +191,30 @@ public:
 	 * @throw invalid_argument (if the pointer to logger is empty)
 	*/
 	CObjectInSceneFinder(const SProcessParams& params, Ptr<CLogger>& logger, const string& runName, const string& sceneFilePath, const vector<string>& objectFilePaths);
+	/**
+	 * @brief Constructor without the scene (the scene is set later by setScene, e.g. frames of a video)
+	 * 
+	 * The reference objects are processed only once in the first run and they are reused (kept warm) for all the following scenes.
+	 * 
+	 * @param params parameters of the algorithms that would be used
+	 * @param logger smart pointer to logger to which will be logged the results and all the processes information (for correct working the logger has to stay valid for the using time of this class)
+	 * @param runName name of the current test
+	 * @param objectFilePaths  vector with filepaths of images of the reference objects (relative to the place of run of the app)
+	 * @throw ios_base::failure (because of image loading)
+	 * @throw invalid_argument (if the pointer to logger is empty)
+	*/
+	CObjectInSceneFinder(const SProcessParams& params, Ptr<CLogger>& logger, const string& runName, const vector<string>& objectFilePaths);
+	/**
+	 * @brief Sets a new scene, the results of the previous run are discarded (run has to be called again)
+	 * @param scene the not processed scene image
+	*/
+	void setScene(const Ptr<CImage>& scene);
+	/**
+	 * @brief Sets the approximate position of the device for the following runs (the GPS prior of the parameters is used until it is set)
+	 * @param prior the position and the radius (enabled_ false disables the prefiltering)
+	 * @throw invalid_argument if the enabled prior has longitude out of <-180, 180>, latitude out of <-89, 89> (the longitude degree is too short near the poles) or not positive radius
+	*/
+	void setGpsPrior(const SGpsPriorParams& prior);
 	/**
 	 * @brief the main body of the process (detecting and describing features, matching and keypoints matches filtering)
 	 * @param runName name of the current test
@@ -69,6 +230,27 @@ public:
 	 * @throw invalid_argument (if the pointer to logger is empty)
 	*/
 	void viewBestResult(const string& runName);
+	/**
+	 * @brief Gives information whether the last run matched some object (see getBestMatch)
+	 * @return true if the best match exists
+	*/
+	bool bestMatchExists() const { return bestMatchExist_; }
+	/**
+	 * @brief Gives the match between the scene and the best suiting reference object
+	 * @return the best match
+	 * @throw logic_error is thrown if the method run was not called first or no object was matched (see bestMatchExists)
+	*/
+	CImagesMatch& getBestMatch();
+	/**
+	 * @brief Gives the result of the geometric verification of the last run
+	 * @return the result (done_ is false if the verification is disabled)
+	*/
+	const SVerificationResult& getVerification() const { return verification_; }
+	/**
+	 * @brief Gives the localization of the camera by the best match of the last run (it is computed also without the view)
+	 * @return the result (homographyFound_ is false if there was no match, no homography or the verification rejected the match)
+	*/
+	const SLocalizationResult& getLocalization() const { return localization_; }
 	//print all the log, should be used on the end
 
 	/**
@@ -189,11 +189,111 @@ void COperator::logParams(Ptr<CLogger>& logger, const CFileLoader& loader)
 #endif
     
     logger->endl();
+    if (params.cacheParams_.enabled_) {
+        logger->log("Descriptor cache of the reference images: ON, directory: ").log(params.cacheParams_.directory_).endl();
+    }
+    else {
+        logger->log("Descriptor cache of the reference images: OFF").endl();
+    }
+    logger->log("Threads detecting and describing features: ").log(to_string(params.threadingParams_.extractionThreads_)).log(" (0 means all hardware threads)").endl();
+    logger->log("Threads matching the scene with the references: ").log(to_string(params.threadingParams_.matchingThreads_)).log(" (0 means all hardware threads)").endl();
+    logger->log("Contrast enhancement: ").log(params.claheParams_.mode_ == EContrastEnhancement::ADAPTIVE ? ADAPTIVE_CLAHE_STR : CLAHE_STR)
+        .log(", clip limit: ").log(to_string(params.claheParams_.clipLimit_))
+        .log(", tiles grid: ").log(to_string(params.claheParams_.tilesGrid_))
+        .log(", parallel bands: ").log(to_string(params.claheParams_.parallelBands_)).log(" (0 means number of threads)").endl();
+    logger->log("Maximal working resolution of the scene: ").log(to_string(params.resolutionParams_.maxSceneResolution_))
+        .log(", of the references: ").log(to_string(params.resolutionParams_.maxReferenceResolution_)).log(" (0 means full resolution)").endl();
+    if (params.gridParams_.enabled()) {
+        logger->log("Grid detection: ").log(to_string(params.gridParams_.cols_)).log("x").log(to_string(params.gridParams_.rows_))
+            .log(" cells, features limit of the cell: ").log(to_string(params.gridParams_.cellFeaturesLimit_)).log(" (0 means features limit divided by the number of cells)").endl();
+    }
+    else {
+        logger->log("Grid detection: OFF").endl();
+    }
+    logger->log("Quantized reference descriptors: ").log(params.storageParams_.quantizeReferences_ ? "ON (matched by the quantized brute force L2 kernel)" : "OFF").endl();
+    logger->log("Packed binary descriptors: ").log(params.storageParams_.packBinaryDescriptors_ ? "ON (matched by the brute force popcount Hamming kernel)" : "OFF").endl();
+    if (params.retrievalParams_.enabled_) {
+        logger->log("Vocabulary retrieval: ON, branching factor: ").log(to_string(params.retrievalParams_.branching_))
+            .log(", depth: ").log(to_string(params.retrievalParams_.depth_))
+            .log(", shortlist size: ").log(to_string(params.retrievalParams_.shortlistSize_)).endl();
+    }
+    else {
+        logger->log("Vocabulary retrieval: OFF (all the references are matched)").endl();
+    }
+    logger->log("Matching direction: ").log(params.matchingParams_.direction_ == EMatchingDirection::OBJECT_TO_SCENE ? OBJECT_TO_SCENE_STR :
+        params.matchingParams_.direction_ == EMatchingDirection::SCENE_TO_OBJECT ? SCENE_TO_OBJECT_STR : AUTO_DIRECTION_STR).endl();
+    logger->log("Cross check of the matches: ").log(params.matchingParams_.crossCheck_ ? "enabled" : "disabled").endl();
+    if (params.matchingMethod_ == EAlgorithm::ALG_GEMM_MATCHING) {
+        logger->log("GEMM benchmark against BFMatcher: ").log(params.matchingParams_.benchmarkGemm_ ? "ON" : "OFF").endl();
+    }
+    if (params.matchingMethod_ == EAlgorithm::ALG_HNSW_MATCHING) {
+        logger->log("HNSW M: ").log(to_string(params.hnswParams_.M_))
+            .log(", efConstruction: ").log(to_string(params.hnswParams_.efConstruction_))
+            .log(", efSearch: ").log(to_string(params.hnswParams_.efSearch_))
+            .log(", index file: ").log(params.hnswParams_.indexFile_.empty() ? "none" : params.hnswParams_.indexFile_)
+            .log(", recall measurement: ").log(params.hnswParams_.measureRecall_ ? "ON" : "OFF").endl();
+    }
+    logger->log("Global descriptor index: ").log(params.retrievalParams_.globalIndex_ ? "ON (the scene is matched once against all the references, they are ranked by votes)" : "OFF").endl();
+    if (params.verificationParams_.enabled_) {
+        logger->log("Geometric verification: ON, top candidates: ").log(to_string(params.verificationParams_.topK_))
+            .log(", iterations budget: ").log(to_string(params.verificationParams_.maxIterations_))
+            .log(", minimal inliers: ").log(to_string(params.verificationParams_.minInliers_))
+            .log(", minimal confidence: ").log(to_string(params.verificationParams_.minConfidence_)).endl();
+    }
+    else {
+        logger->log("Geometric verification: OFF").endl();
+    }
+    if (params.cascadeParams_.enabled_) {
+        logger->log("Cascade rejection: ON, subset ratio: ").log(to_string(params.cascadeParams_.subsetRatio_))
+            .log(", tolerance: ").log(to_string(params.cascadeParams_.tolerance_)).endl();
+    }
+    else {
+        logger->log("Cascade rejection: OFF").endl();
+    }
+    if (params.gmsParams_.enabled_) {
+        logger->log("GMS filter before RANSAC: ON, grid size: ").log(to_string(params.gmsParams_.gridSize_))
+            .log(", threshold factor: ").log(to_string(params.gmsParams_.thresholdFactor_)).endl();
+    }
+    else {
+        logger->log("GMS filter before RANSAC: OFF").endl();
+    }
+    if (params.trackingParams_.enabled_) {
+        logger->log("Frame tracking (streaming mode): ON, minimal inliers: ").log(to_string(params.trackingParams_.minInliers_))
+            .log(", maximal reprojection error: ").log(to_string(params.trackingParams_.maxReprojectionError_))
+            .log(", window size: ").log(to_string(params.trackingParams_.windowSize_))
+            .log(", pyramid levels: ").log(to_string(params.trackingParams_.pyramidLevels_)).endl();
+    }
+    else {
+        logger->log("Frame tracking (streaming mode): OFF").endl();
+    }
+    logger->log("Pose solver: ").log(params.poseParams_.solver_ == EPoseSolver::IPPE ? IPPE_POSE_STR : ITERATIVE_POSE_STR)
+        .log(params.poseParams_.solver_ == EPoseSolver::IPPE ? (params.poseParams_.refine_ ? " (refined)" : " (not refined)") : "").endl();
+    if (params.gpsPriorParams_.enabled_) {
+        logger->log("GPS prior: ON, longitude: ").log(to_string(params.gpsPriorParams_.longitude_))
+            .log(", latitude: ").log(to_string(params.gpsPriorParams_.latitude_))
+            .log(", radius: ").log(to_string(params.gpsPriorParams_.radius_)).log("[m]").endl();
+    }
+    else {
+        logger->log("GPS prior: OFF").endl();
+    }
     logger->log("camera focal length: ").log(to_string(params.cameraInfo_.focalLength_)).endl();
     logger->log("camera sensors size x: ").log(to_string(params.cameraInfo_.chipSizeX_)).endl();
     logger->log("camera sensors size y: ").log(to_string(params.cameraInfo_.chipSizeY_)).endl();
 }
 
+void COperator::pause(const CFileLoader& loader)
+{
+    if (!loader.pauseAtExit()) {
+        return;
+    }
+#ifdef _WIN32
+    system("pause");
+#else
+    std::cout << "Press Enter to continue . . ." << endl;
+    cin.get();
+#endif
+}
+
 int COperator::run()
 {
     //load values
@@ -203,12 +303,12 @@ int COperator::run()
     }
     catch (ios_base::failure& e) {
         std::cout << e.what() << endl;
-        system("pause");
+        pause(fileLoader);
         return -1;
     } 
     catch (logic_error& e) {
         std::cout << e.what() << endl;
-        system("pause");
+        pause(fileLoader);
         return -1;
     }
 
@@ -233,27 +333,42 @@ int COperator::run()
         //log the settings
         logParams(logger, fileLoader);
         //run the algorithms
-        CObjectInSceneFinder finder(fileLoader.getProcessParams(), logger, fileLoader.getRunName(), fileLoader.getSceneFilepath(), fileLoader.getReferencesFilepaths());
-        finder.run(fileLoader.getRunName(), fileLoader.previewResult());
-        finder.report();
+        if (fileLoader.streamMode()) {
+            logger->log("Stream source: ").log(fileLoader.getStreamSource())
+                .log(fileLoader.streamDropStaleFrames() ? " (stale frames are dropped)" : " (all frames are processed)").endl();
+            string outputRoot = fileLoader.outputRoot();
+            if (!outputRoot.empty() && outputRoot.back() != '/' && outputRoot.back() != '\\') {
+                outputRoot += "/";
+            }
+            CStreamLocalizer localizer(fileLoader.getProcessParams(), logger, fileLoader.getRunName(), fileLoader.getReferencesFilepaths(),
+                outputRoot + fileLoader.getRunName() + STREAM_RECORDS_FILE_SUFFIX);
+            CFrameSource source(fileLoader.getStreamSource(), fileLoader.streamDropStaleFrames());
+            localizer.run(source, fileLoader.streamMaxFrames());
+            logger->flush();
+        }
+        else {
+            CObjectInSceneFinder finder(fileLoader.getProcessParams(), logger, fileLoader.getRunName(), fileLoader.getSceneFilepath(), fileLoader.getReferencesFilepaths());
+            finder.run(fileLoader.getRunName(), fileLoader.previewResult());
+            finder.report();
+        }
     }
     catch (ios_base::failure e) {
         logger->logError(e.what());
-        system("pause");
+        pause(fileLoader);
         return -1;
     }
     catch (invalid_argument e) {
         logger->logError(e.what());
-        system("pause");
+        pause(fileLoader);
         return -1;
     }
     catch (logic_error e) {
         logger->logError(e.what());
-        system("pause");
+        pause(fileLoader);
         return -1;
     }
 
     consoleLogger->logSection("FINISHED", 0);
-    system("pause");
+    pause(fileLoader);
     return 1;
 }
@@ -20,6 +20,8 @@
 #include "SProcessParams.h"
 #include "parameters.h"
 #include "CFileLoader.h"
+#include "CStreamLocalizer.h"
+#include "CFrameSource.h"
 
 using namespace std;
 
@@ -40,6 +42,11 @@ class COperator
      * @return the set parameters
     */
     static void logParams(Ptr<CLogger>& logger, const CFileLoader& loader);
+    /**
+     * @brief Waits for the user before the application exits (the console window stays open), only if it is enabled in the configuration
+     * @param loader the file loader with the configuration (it may be not loaded)
+    */
+    static void pause(const CFileLoader& loader);
 public:
     /**
      * @brief static method that executes the program
@@ -0,0 +1,171 @@
+#include "CStreamLocalizer.h"
+
+SFrameRecord CStreamLocalizer::processFrame(const Mat& frame, long long frameIndex)
+{
+	SFrameRecord record;
+	record.frameIndex_ = frameIndex;
+
+	Ptr<CImage> scene = makePtr<CImage>(frame, "frame_" + to_string(frameIndex), params_.resolutionParams_.maxSceneResolution_);
+	if (tracker_.isTracking()) {
+		//the frame is not processed, its image is still the gray frame in the working resolution
+		if (tracker_.track(scene->getImage())) {
+			record.tracked_ = true;
+			record.referenceFilePath_ = trackedReference_->getFilePath();
+			record.matchesCount_ = tracker_.getInliersCount();
+			record.reprojectionError_ = tracker_.getReprojectionError();
+			copyLocalization(CImagesMatch::localize(trackedReference_, scene, tracker_.getHomography(), params_, frameLoggerBase_), record);
+			return record;
+		}
+		tracker_.stop();
+		trackedReference_.reset();
+	}
+
+	//the processing enhances the contrast of the image in place, the tracking needs the original gray frame
+	Mat trackingFrame;
+	if (params_.trackingParams_.enabled_) {
+		trackingFrame = scene->getImage().clone();
+	}
+	finder_->setScene(scene);
+	finder_->run(runName_, false);
+	if (!finder_->bestMatchExists()) {
+		return record;
+	}
+
+	CImagesMatch& bestMatch = finder_->getBestMatch();
+	record.referenceFilePath_ = bestMatch.getObjectImage()->getFilePath();
+	record.matchedObjectFeaturesRatio_ = bestMatch.getMatchedObjectFeaturesRatio();
+	record.matchesCount_ = bestMatch.getNumberOfMatches();
+	//the finder localizes the best match in the headless run (the match rejected by the verification is not located at all)
+	copyLocalization(finder_->getLocalization(), record);
+	if (!record.homographyFound_) {
+		return record;
+	}
+
+	if (params_.trackingParams_.enabled_ && record.poseFound_) {
+		vector<Point2f> objectPoints, scenePoints;
+		bestMatch.getInlierCorrespondences(objectPoints, scenePoints);
+		if (tracker_.start(trackingFrame, objectPoints, scenePoints, bestMatch.getHomography())) {
+			trackedReference_ = bestMatch.getObjectImage();
+		}
+	}
+	return record;
+}
+
+void CStreamLocalizer::copyLocalization(const SLocalizationResult& localization, SFrameRecord& record)
+{
+	record.homographyFound_ = localization.homographyFound_;
+	record.poseFound_ = localization.poseFound_;
+	record.rVec_ = localization.rVec_;
+	record.tVec_ = localization.tVec_;
+	record.gcsFound_ = localization.gcsFound_;
+	record.cameraGcs_ = localization.cameraGcs_;
+}
+
+void CStreamLocalizer::writeRecord(const SFrameRecord& record)
+{
+	records_ << record.frameIndex_ << ',' << record.droppedFrames_ << ',' << record.processingMs_ << ','
+		<< record.referenceFilePath_ << ',' << record.tracked_ << ',' << record.matchesCount_ << ',' << record.matchedObjectFeaturesRatio_ << ','
+		<< record.reprojectionError_ << ','
+		<< record.homographyFound_ << ',' << record.poseFound_ << ','
+		<< record.rVec_[0] << ',' << record.rVec_[1] << ',' << record.rVec_[2] << ','
+		<< record.tVec_[0] << ',' << record.tVec_[1] << ',' << record.tVec_[2] << ','
+		<< record.gcsFound_ << ',' << record.cameraGcs_.latitude_ << ',' << record.cameraGcs_.longitude << '\n';
+
+	logger_->log("Frame ").log(to_string(record.frameIndex_))
+		.log(" (dropped before: ").log(to_string(record.droppedFrames_)).log(")")
+		.log(", reference: ").log(record.referenceFilePath_)
+		.log(record.tracked_ ? ", tracked inliers: " : ", matches: ").log(to_string(record.matchesCount_))
+		.log(", took: ").log(to_string(record.processingMs_)).log(" ms");
+	if (record.gcsFound_) {
+		logger_->log(", camera location: ").log(record.cameraGcs_);
+	}
+	else if (!record.homographyFound_) {
+		logger_->log(", homography not found");
+	}
+	logger_->endl();
+}
+
+CStreamLocalizer::CStreamLocalizer(const SProcessParams& params, Ptr<CLogger>& logger, const string& runName, const vector<string>& objectFilePaths, const string& recordsFilePath)
+	:
+	params_(params),
+	logger_(logger),
+	tracker_(params.trackingParams_),
+	runName_(runName)
+{
+	if (logger_.empty()) {
+		throw invalid_argument("CStreamLocalizer constructor was called with empty pointer to logger (CLogger) object.");
+	}
+	//timing mode of the buffer - the images are never stored
+	frameLogger_ = makePtr<CBufferLogger>(true, 0);
+	frameLoggerBase_ = frameLogger_;
+
+	finder_ = makePtr<CObjectInSceneFinder>(params_, frameLoggerBase_, runName, objectFilePaths);
+	//the loading of the references is logged
+	frameLogger_->replay(*logger_);
+
+	try {
+		boost::filesystem::path recordsPath(recordsFilePath);
+		if (recordsPath.has_parent_path()) {
+			boost::filesystem::create_directories(recordsPath.parent_path());
+		}
+	}
+	catch (exception& e) {
+		throw ios_base::failure(string("Stream records directory can't be created! System message: ") + e.what());
+	}
+	records_.open(recordsFilePath, ofstream::trunc);
+	if (!records_.is_open()) {
+		throw ios_base::failure("Stream records file can't be created: " + recordsFilePath);
+	}
+	records_ << setprecision(10);
+	records_ << "frame,dropped_frames,processing_ms,reference,tracked,matches,matched_ratio,reprojection_error,homography_found,pose_found,"
+		<< "rvec_x,rvec_y,rvec_z,tvec_x,tvec_y,tvec_z,gps_found,latitude,longitude\n";
+	logger_->log("Stream records file: ").log(recordsFilePath).endl();
+}
+
+void CStreamLocalizer::run(CFrameSource& source, long long maxFrames)
+{
+	logger_->logSection("Stream", 1);
+	logger_->log("Source frame rate: ").log(to_string(source.getFps())).log(" fps").endl();
+
+	Mat frame;
+	long long frameIndex = 0, droppedFrames = 0;
+	long long processedFrames = 0, droppedFramesTotal = 0;
+	double processingMsTotal = 0.0;
+	long long trackedFrames = 0;
+	double trackedMsTotal = 0.0;
+	while ((maxFrames == 0 || processedFrames < maxFrames) && source.next(frame, frameIndex, droppedFrames)) {
+		chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+		SFrameRecord record = processFrame(frame, frameIndex);
+		chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+		record.droppedFrames_ = droppedFrames;
+		record.processingMs_ = chrono::duration<double, milli>(end - begin).count();
+		writeRecord(record);
+		frameLogger_->clear();
+
+		++processedFrames;
+		droppedFramesTotal += droppedFrames;
+		processingMsTotal += record.processingMs_;
+		if (record.tracked_) {
+			++trackedFrames;
+			trackedMsTotal += record.processingMs_;
+		}
+	}
+	records_.flush();
+
+	logger_->logSection("Stream summary", 2);
+	logger_->log("Processed frames: ").log(to_string(processedFrames)).log(", dropped frames: ").log(to_string(droppedFramesTotal)).endl();
+	if (processedFrames > 0) {
+		logger_->log("Average processing time of the frame: ").log(to_string(processingMsTotal / processedFrames)).log(" ms").endl();
+	}
+	if (params_.trackingParams_.enabled_) {
+		long long localizedFrames = processedFrames - trackedFrames;
+		logger_->log("Tracked frames: ").log(to_string(trackedFrames)).log(", fully localized frames: ").log(to_string(localizedFrames)).endl();
+		if (trackedFrames > 0) {
+			logger_->log("Average processing time of the tracked frame: ").log(to_string(trackedMsTotal / trackedFrames)).log(" ms").endl();
+		}
+		if (localizedFrames > 0) {
+			logger_->log("Average processing time of the fully localized frame: ").log(to_string((processingMsTotal - trackedMsTotal) / localizedFrames)).log(" ms").endl();
+		}
+	}
+}
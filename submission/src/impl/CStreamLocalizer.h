@@ -0,0 +1,118 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CStreamLocalizer.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class that localizes the camera in every frame of a video or of an image sequence
+ *
+ *  The detector, the reference images (their keypoints and descriptors) and the buffers are kept between the frames.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <iomanip>
+#include <boost/filesystem.hpp>
+
+//wrapper around basic shared pointer
+#include <opencv2/core/cvstd_wrapper.hpp>
+
+#include "CObjectInSceneFinder.h"
+#include "CFrameSource.h"
+#include "CFrameTracker.h"
+#include "CImageLocator3D.h"
+#include "CBufferLogger.h"
+#include "SProcessParams.h"
+#include "SGcsCoords.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Localization record of one frame
+*/
+struct SFrameRecord {
+	long long frameIndex_ = -1; ///< index of the frame in the source
+	long long droppedFrames_ = 0; ///< number of the frames dropped before this frame (the processing fell behind)
+	double processingMs_ = 0.0; ///< processing time of the frame in milliseconds
+	string referenceFilePath_; ///< filepath of the best suiting reference image
+	double matchedObjectFeaturesRatio_ = 0.0; ///< ratio of the filtered matches to the keypoints of the reference (see CImagesMatch)
+	size_t matchesCount_ = 0; ///< number of the filtered matches (of the tracked inliers when the frame was tracked)
+	bool tracked_ = false; ///< whether the frame was tracked from the previous frame (otherwise it was fully localized)
+	double reprojectionError_ = 0.0; ///< mean reprojection error of the tracked inliers (only for the tracked frame)
+	bool homographyFound_ = false; ///< whether the homography was found
+	bool poseFound_ = false; ///< whether the rotation and translation are valid
+	Vec3d rVec_; ///< rotation of the camera (from the reference image space to the camera space, Rodrigues vector)
+	Vec3d tVec_; ///< translation of the camera (from the reference image space to the camera space)
+	bool gcsFound_ = false; ///< whether the GCS location is valid
+	sm::SGcsCoords cameraGcs_ = sm::SGcsCoords(0.0, 0.0); ///< GCS (GPS) location of the camera
+};
+
+/**
+ * @brief Class that localizes the camera in every frame of a video or of an image sequence
+ * 
+ * Usage is following: construct (the references are loaded) -> run with the frame source
+ * 
+ * Every frame is processed as a scene by the CObjectInSceneFinder that keeps the references processed (warm) and the detector is reused.
+ * The detailed log of the frame is dropped, only a short line per frame goes into the logger and the record of every frame
+ * (pose and GPS) is written into the records file (CSV).
+ * 
+ * With the tracking enabled the inliers of the localized frame are tracked into the next frames (see CFrameTracker) and the full
+ * localization (relocalization) is done only when the tracking is lost.
+ * 
+*/
+class CStreamLocalizer
+{
+	const SProcessParams params_; ///< parameters of the processing
+	Ptr<CLogger> logger_; ///< logger for the summary of the frames
+	Ptr<CBufferLogger> frameLogger_; ///< logger for the detailed log of one frame (it is cleared after every frame)
+	Ptr<CLogger> frameLoggerBase_; ///< the frameLogger_ as the base class pointer (needed by the finder)
+	Ptr<CObjectInSceneFinder> finder_; ///< finder keeping the references and the detector
+	CFrameTracker tracker_; ///< tracker of the inliers between the frames (used only when the tracking is enabled)
+	Ptr<CImage> trackedReference_; ///< reference image of the tracked inliers
+	const string runName_; ///< name of the current run
+	ofstream records_; ///< file with the records of the frames
+
+	/**
+	 * @brief Localizes the camera in one frame
+	 * @param frame the frame
+	 * @param frameIndex index of the frame in the source
+	 * @return the record of the frame (without the timing and dropped frames information)
+	*/
+	SFrameRecord processFrame(const Mat& frame, long long frameIndex);
+	/**
+	 * @brief Fills the homography, pose and GCS location of the frame into the record
+	 * @param localization the localization of the frame (see CImagesMatch::localize)
+	 * @param record the record of the frame
+	*/
+	static void copyLocalization(const SLocalizationResult& localization, SFrameRecord& record);
+	/**
+	 * @brief Writes the record of the frame into the records file and the summary line into the logger
+	 * @param record the record
+	*/
+	void writeRecord(const SFrameRecord& record);
+public:
+	/**
+	 * @brief Constructor, it loads the reference images and opens the records file
+	 * @param params parameters of the processing
+	 * @param logger logger for the summary of the frames
+	 * @param runName name of the current run
+	 * @param objectFilePaths filepaths of the reference images
+	 * @param recordsFilePath filepath of the records file (CSV)
+	 * @throw ios_base::failure if the images can't be loaded or the records file can't be created
+	 * @throw invalid_argument if the pointer to logger is empty
+	*/
+	CStreamLocalizer(const SProcessParams& params, Ptr<CLogger>& logger, const string& runName, const vector<string>& objectFilePaths, const string& recordsFilePath);
+	/**
+	 * @brief Localizes the frames of the source until the source ends or the frames limit is reached
+	 * @param source the frames source
+	 * @param maxFrames maximal number of the processed frames (0 means no limit)
+	 * @throw all CImage, CImagesMatch and CObjectInSceneFinder exceptions
+	*/
+	void run(CFrameSource& source, long long maxFrames);
+};
@@ -0,0 +1,256 @@
+#include "CVocabularyTree.h"
+
+Mat CVocabularyTree::toFloatDescriptors(const Mat& descriptors)
+{
+	if (descriptors.type() == CV_32F) {
+		return descriptors;
+	}
+	if (descriptors.type() != CV_8U) {
+		throw invalid_argument("CVocabularyTree supports only float (CV_32F) or binary (CV_8U) descriptors.");
+	}
+	Mat bits(descriptors.rows, descriptors.cols * 8, CV_32F);
+	for (int r = 0; r < descriptors.rows; ++r) {
+		const uchar* in = descriptors.ptr<uchar>(r);
+		float* out = bits.ptr<float>(r);
+		for (int c = 0; c < descriptors.cols; ++c) {
+			for (int b = 0; b < 8; ++b) {
+				out[c * 8 + b] = (float)((in[c] >> (7 - b)) & 1);
+			}
+		}
+	}
+	return bits;
+}
+
+int CVocabularyTree::quantize(const float* descriptor) const
+{
+	int node = 0;
+	while (nodes_[node].firstChild_ >= 0) {
+		int bestChild = nodes_[node].firstChild_;
+		float bestDistance = numeric_limits<float>::max();
+		for (int child = nodes_[node].firstChild_; child < nodes_[node].firstChild_ + nodes_[node].childrenCount_; ++child) {
+			float distance = normL2Sqr<float, float>(centers_.ptr<float>(child), descriptor, centers_.cols);
+			if (distance < bestDistance) {
+				bestDistance = distance;
+				bestChild = child;
+			}
+		}
+		node = bestChild;
+	}
+	return nodes_[node].wordId_;
+}
+
+vector<pair<int, int>> CVocabularyTree::wordsHistogram(const Mat& descriptors) const
+{
+	Mat floatDescriptors = toFloatDescriptors(descriptors);
+	if (floatDescriptors.cols != centers_.cols) {
+		throw invalid_argument("CVocabularyTree - the descriptors have different size than the vocabulary.");
+	}
+	vector<int> words(floatDescriptors.rows);
+	parallel_for_(Range(0, floatDescriptors.rows), [&](const Range& range) {
+		for (int r = range.start; r < range.end; ++r) {
+			words[r] = quantize(floatDescriptors.ptr<float>(r));
+		}
+	});
+
+	sort(words.begin(), words.end());
+	vector<pair<int, int>> histogram;
+	for (int word : words) {
+		if (histogram.empty() || histogram.back().first != word) {
+			histogram.emplace_back(word, 0);
+		}
+		++histogram.back().second;
+	}
+	return histogram;
+}
+
+//=================================================================================================
+
+CVocabularyTree::CVocabularyTree(const SRetrievalParams& params)
+	:
+	params_(params)
+{
+}
+
+void CVocabularyTree::train(const vector<Mat>& descriptors)
+{
+	nodes_.clear();
+	centers_ = Mat();
+	wordsCount_ = 0;
+	invertedFiles_.clear();
+	idf_.clear();
+	imagesDescriptorsCount_.clear();
+	imagesCount_ = 0;
+	finalized_ = false;
+
+	//uniform subsampling of all the descriptors
+	size_t total = 0;
+	for (auto& it : descriptors) {
+		total += (size_t)it.rows;
+	}
+	if (total == 0) {
+		throw invalid_argument("CVocabularyTree can't be trained without descriptors.");
+	}
+	size_t step = (total + VOCABULARY_MAX_TRAINING_DESCRIPTORS - 1) / VOCABULARY_MAX_TRAINING_DESCRIPTORS;
+	Mat data;
+	size_t counter = 0;
+	for (auto& it : descriptors) {
+		if (it.empty()) {
+			continue;
+		}
+		Mat floatDescriptors = toFloatDescriptors(it);
+		if (data.empty()) {
+			data.create((int)((total + step - 1) / step), floatDescriptors.cols, CV_32F);
+		}
+		else if (floatDescriptors.cols != data.cols) {
+			throw invalid_argument("CVocabularyTree - all the training descriptors have to have the same size.");
+		}
+		for (int r = 0; r < floatDescriptors.rows; ++r, ++counter) {
+			if (counter % step == 0) {
+				floatDescriptors.row(r).copyTo(data.row((int)(counter / step)));
+			}
+		}
+	}
+
+	//k-means uses the random generator of the thread, it is seeded so the vocabulary is reproducible
+	//the generator of the caller is restored when the training ends (also on the exception)
+	struct SRngRestorer {
+		RNG saved_ = theRNG();
+		~SRngRestorer() { theRNG() = saved_; }
+	} rngRestorer;
+	theRNG() = RNG(VOCABULARY_RNG_SEED);
+	const int branching = params_.branching_;
+	nodes_.push_back(SNode());
+	centers_ = Mat::zeros(1, data.cols, CV_32F);
+	struct SBuildItem {
+		int node_;
+		Mat data_;
+		int level_;
+	};
+	vector<SBuildItem> stack;
+	stack.push_back({ 0, data, 0 });
+	while (!stack.empty()) {
+		SBuildItem item = stack.back();
+		stack.pop_back();
+		//too deep or too few descriptors to be split -> visual word
+		if (item.level_ >= params_.depth_ || item.data_.rows <= branching) {
+			nodes_[item.node_].wordId_ = wordsCount_++;
+			continue;
+		}
+
+		Mat labels, centers;
+		kmeans(item.data_, branching, labels, TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, VOCABULARY_KMEANS_ITERATIONS, 1e-4),
+			1, KMEANS_PP_CENTERS, centers);
+		int firstChild = (int)nodes_.size();
+		nodes_[item.node_].firstChild_ = firstChild;
+		nodes_[item.node_].childrenCount_ = branching;
+		for (int c = 0; c < branching; ++c) {
+			nodes_.push_back(SNode());
+			centers_.push_back(centers.row(c));
+		}
+
+		//split the descriptors of the node between its children
+		vector<int> counts(branching, 0);
+		for (int r = 0; r < labels.rows; ++r) {
+			++counts[labels.at<int>(r)];
+		}
+		vector<Mat> parts(branching);
+		for (int c = 0; c < branching; ++c) {
+			parts[c].create(counts[c], item.data_.cols, CV_32F);
+			counts[c] = 0;
+		}
+		for (int r = 0; r < labels.rows; ++r) {
+			int c = labels.at<int>(r);
+			item.data_.row(r).copyTo(parts[c].row(counts[c]++));
+		}
+		//reversed, so the children are processed in their order
+		for (int c = branching - 1; c >= 0; --c) {
+			stack.push_back({ firstChild + c, parts[c], item.level_ + 1 });
+		}
+	}
+	invertedFiles_.resize(wordsCount_);
+}
+
+size_t CVocabularyTree::add(const Mat& descriptors)
+{
+	if (wordsCount_ == 0) {
+		throw logic_error("CVocabularyTree - the images can be added only after the training.");
+	}
+	if (finalized_) {
+		throw logic_error("CVocabularyTree - the images can't be added after finalize.");
+	}
+	uint32_t imageIndex = (uint32_t)imagesCount_++;
+	imagesDescriptorsCount_.push_back((float)descriptors.rows);
+	if (!descriptors.empty()) {
+		for (auto& it : wordsHistogram(descriptors)) {
+			//the raw count, it is weighted in finalize
+			invertedFiles_[it.first].push_back({ imageIndex, (float)it.second });
+		}
+	}
+	return imageIndex;
+}
+
+void CVocabularyTree::finalize()
+{
+	idf_.assign(wordsCount_, 0.0f);
+	vector<float> norms(imagesCount_, 0.0f);
+	for (int w = 0; w < wordsCount_; ++w) {
+		if (invertedFiles_[w].empty()) {
+			continue;
+		}
+		idf_[w] = (float)log((double)imagesCount_ / (double)invertedFiles_[w].size());
+		for (auto& posting : invertedFiles_[w]) {
+			posting.weight_ = posting.weight_ / imagesDescriptorsCount_[posting.imageIndex_] * idf_[w];
+			norms[posting.imageIndex_] += posting.weight_;
+		}
+	}
+	for (auto& file : invertedFiles_) {
+		for (auto& posting : file) {
+			if (norms[posting.imageIndex_] > 0) {
+				posting.weight_ /= norms[posting.imageIndex_];
+			}
+		}
+	}
+	finalized_ = true;
+}
+
+vector<SRetrievalCandidate> CVocabularyTree::query(const Mat& descriptors, size_t shortlistSize) const
+{
+	if (!finalized_) {
+		throw logic_error("CVocabularyTree - query was called before finalize.");
+	}
+	vector<SRetrievalCandidate> candidates(imagesCount_);
+	for (size_t i = 0; i < imagesCount_; ++i) {
+		candidates[i] = { i, 0.0f };
+	}
+	if (!descriptors.empty()) {
+		vector<pair<int, int>> histogram = wordsHistogram(descriptors);
+		vector<float> weights(histogram.size());
+		float norm = 0.0f;
+		for (size_t i = 0; i < histogram.size(); ++i) {
+			weights[i] = (float)histogram[i].second / (float)descriptors.rows * idf_[histogram[i].first];
+			norm += weights[i];
+		}
+		//L1 distance of the normalised vectors: |q - d| = 2 + sum over the common words (|q_w - d_w| - q_w - d_w)
+		vector<float> accumulator(imagesCount_, 0.0f);
+		for (size_t i = 0; norm > 0 && i < histogram.size(); ++i) {
+			float q = weights[i] / norm;
+			if (q <= 0) {
+				continue;
+			}
+			for (auto& posting : invertedFiles_[histogram[i].first]) {
+				accumulator[posting.imageIndex_] += fabs(q - posting.weight_) - q - posting.weight_;
+			}
+		}
+		//similarity 1 - |q - d| / 2
+		for (size_t i = 0; i < imagesCount_; ++i) {
+			candidates[i].score_ = -accumulator[i] / 2.0f;
+		}
+	}
+
+	size_t count = min(shortlistSize, candidates.size());
+	partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](const SRetrievalCandidate& a, const SRetrievalCandidate& b) {
+		return a.score_ > b.score_ || (a.score_ == b.score_ && a.imageIndex_ < b.imageIndex_);
+	});
+	candidates.resize(count);
+	return candidates;
+}
@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CVocabularyTree.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class of the visual vocabulary (hierarchical k-means) with the TF-IDF weighted inverted files of the reference images
+ *
+ *  It is used to choose a short list of the reference images that are matched with the scene (image retrieval).
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+//Matrices, kmeans, random numbers
+#include <opencv2/core.hpp>
+//parallel_for_
+#include <opencv2/core/utility.hpp>
+
+#include "SProcessParams.h"
+#include "parameters.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Candidate reference image given by the retrieval
+*/
+struct SRetrievalCandidate {
+	size_t imageIndex_; ///< index of the reference image (the order in which the images were added)
+	float score_; ///< similarity of the bag of words vectors in range [0, 1] (1 means the same vectors)
+};
+
+/**
+ * @brief Class of the visual vocabulary (hierarchical k-means) with the TF-IDF weighted inverted files of the reference images
+ * 
+ * Usage is following: construct -> train (descriptors of the reference images) -> add every reference image -> finalize -> query for every scene
+ * 
+ * The vocabulary is a tree with branching factor k and depth L (at most k^L visual words), every node is split by k-means of its descriptors.
+ * The descriptor is quantized by descending the tree (k distance computations per level), so the quantization is cheap even for large vocabularies.
+ * The images are represented by L1 normalised TF-IDF vectors of the visual words and the similarity is computed only over the common words
+ * by the inverted files (Nister, Stewenius: Scalable Recognition with a Vocabulary Tree).
+ * 
+ * Float descriptors (SIFT, RootSIFT) are clustered directly, binary descriptors (CV_8U - ORB, BEBLID) are unpacked into bits (0/1 floats),
+ * so the L2 distance of the bit vectors is the square root of the Hamming distance.
+ * 
+*/
+class CVocabularyTree
+{
+	/**
+	 * @brief Node of the tree, the centers of the node children are the rows firstChild_ ... firstChild_ + childrenCount_ - 1 of the centers matrix
+	*/
+	struct SNode {
+		int firstChild_ = -1; ///< index of the first child node (-1 for a leaf)
+		int childrenCount_ = 0; ///< number of the children
+		int wordId_ = -1; ///< visual word of the leaf (-1 for an inner node)
+	};
+	/**
+	 * @brief Item of the inverted file
+	*/
+	struct SPosting {
+		uint32_t imageIndex_; ///< index of the reference image
+		float weight_; ///< TF-IDF weight of the word in the image (after the normalisation)
+	};
+
+	const SRetrievalParams params_; ///< parameters of the vocabulary
+	vector<SNode> nodes_; ///< nodes of the tree, the root is the first one
+	Mat centers_; ///< centers of the nodes (one row per node, the root row is not used)
+	int wordsCount_ = 0; ///< number of the visual words (leaves)
+	vector<vector<SPosting>> invertedFiles_; ///< postings of every word (the image indices are increasing)
+	vector<float> idf_; ///< inverse document frequency of every word
+	vector<float> imagesDescriptorsCount_; ///< number of the descriptors of every added image (the term frequency is relative to it)
+	size_t imagesCount_ = 0; ///< number of the added images
+	bool finalized_ = false; ///< whether the weights of the postings were computed
+
+	/**
+	 * @brief Converts the descriptors into the float form used by the vocabulary
+	 * @param descriptors float (CV_32F) or binary (CV_8U) descriptors
+	 * @return float descriptors (binary ones are unpacked into 0/1 values)
+	 * @throw invalid_argument if the type of the descriptors is not supported
+	*/
+	static Mat toFloatDescriptors(const Mat& descriptors);
+	/**
+	 * @brief Quantizes one descriptor into the visual word
+	 * @param descriptor pointer to the float descriptor
+	 * @return the visual word
+	*/
+	int quantize(const float* descriptor) const;
+	/**
+	 * @brief Quantizes all the descriptors and counts the occurrences of the words
+	 * @param descriptors the descriptors (float or binary)
+	 * @return pairs (word, count) sorted by the word
+	*/
+	vector<pair<int, int>> wordsHistogram(const Mat& descriptors) const;
+public:
+	/**
+	 * @brief Constructor
+	 * @param params parameters of the vocabulary (branching factor, depth, shortlist size)
+	*/
+	CVocabularyTree(const SRetrievalParams& params);
+	/**
+	 * @brief Trains the tree by the hierarchical k-means (the previous vocabulary and images are discarded)
+	 * 
+	 * At most VOCABULARY_MAX_TRAINING_DESCRIPTORS descriptors are used (uniformly subsampled), the random generator is seeded,
+	 * so the vocabulary is the same for the same descriptors. The random generator of the thread (theRNG) is restored afterwards.
+	 * 
+	 * @param descriptors descriptors of the reference images (every image one matrix, float or binary)
+	 * @throw invalid_argument if there are no descriptors
+	*/
+	void train(const vector<Mat>& descriptors);
+	/**
+	 * @brief Adds the reference image into the inverted files
+	 * @param descriptors descriptors of the image
+	 * @return index of the image
+	 * @throw logic_error if the tree was not trained or the images were already finalized
+	*/
+	size_t add(const Mat& descriptors);
+	/**
+	 * @brief Computes the IDF and the normalised TF-IDF weights of the postings (has to be called after all the images were added)
+	*/
+	void finalize();
+	/**
+	 * @brief Gives the reference images most similar to the scene
+	 * @param descriptors descriptors of the scene
+	 * @param shortlistSize maximal number of the candidates
+	 * @return candidates sorted by the decreasing score (ties by the image index)
+	 * @throw logic_error if finalize was not called
+	*/
+	vector<SRetrievalCandidate> query(const Mat& descriptors, size_t shortlistSize) const;
+	/**
+	 * @brief Gives the number of the visual words
+	 * @return the number of the leaves of the tree
+	*/
+	int getWordsCount() const { return wordsCount_; }
+	/**
+	 * @brief Gives the number of the added images
+	 * @return the number
+	*/
+	size_t getImagesCount() const { return imagesCount_; }
+	/**
+	 * @brief Gives information whether the images can be queried
+	 * @return true after finalize
+	*/
+	bool isFinalized() const { return finalized_; }
+};
@@ -0,0 +1,95 @@
+#include "CWorkStealingPool.h"
+
+bool CWorkStealingPool::popFront(atomic<uint64_t>& range, size_t& task)
+{
+	uint64_t current = range.load(memory_order_acquire);
+	while (true) {
+		uint64_t begin = current >> 32, end = current & 0xFFFFFFFFULL;
+		if (begin >= end) {
+			return false;
+		}
+		if (range.compare_exchange_weak(current, packRange(begin + 1, end), memory_order_acq_rel, memory_order_acquire)) {
+			task = (size_t)begin;
+			return true;
+		}
+	}
+}
+
+bool CWorkStealingPool::stealBack(atomic<uint64_t>& range, size_t& task)
+{
+	uint64_t current = range.load(memory_order_acquire);
+	while (true) {
+		uint64_t begin = current >> 32, end = current & 0xFFFFFFFFULL;
+		if (begin >= end) {
+			return false;
+		}
+		if (range.compare_exchange_weak(current, packRange(begin, end - 1), memory_order_acq_rel, memory_order_acquire)) {
+			task = (size_t)(end - 1);
+			return true;
+		}
+	}
+}
+
+//=================================================================================================
+
+CWorkStealingPool::CWorkStealingPool(unsigned int threadsCount)
+	:
+	threadsCount_(threadsCount == 0 ? max(thread::hardware_concurrency(), 1u) : threadsCount)
+{
+}
+
+void CWorkStealingPool::run(size_t tasksCount, const function<void(size_t)>& task)
+{
+	vector<exception_ptr> errors(tasksCount);
+	auto runTask = [&](size_t i) {
+		try {
+			task(i);
+		}
+		catch (...) {
+			errors[i] = current_exception();
+		}
+	};
+
+	const size_t workersCount = min((size_t)threadsCount_, tasksCount);
+	unique_ptr<atomic<uint64_t>[]> ranges(new atomic<uint64_t>[max(workersCount, (size_t)1)]);
+	for (size_t w = 0; w < workersCount; ++w) {
+		ranges[w].store(packRange(tasksCount * w / workersCount, tasksCount * (w + 1) / workersCount));
+	}
+
+	auto worker = [&](size_t workerIndex) {
+		size_t i;
+		while (true) {
+			if (popFront(ranges[workerIndex], i)) {
+				runTask(i);
+				continue;
+			}
+			//the tasks are never added, so when no victim has a task the work is done
+			bool stolen = false;
+			for (size_t v = 1; v < workersCount && !stolen; ++v) {
+				stolen = stealBack(ranges[(workerIndex + v) % workersCount], i);
+			}
+			if (!stolen) {
+				return;
+			}
+			runTask(i);
+		}
+	};
+
+	vector<thread> workers;
+	//the calling thread is one of the workers
+	for (size_t w = 1; w < workersCount; ++w) {
+		workers.emplace_back(worker, w);
+	}
+	if (workersCount > 0) {
+		worker(0);
+	}
+	for (auto& it : workers) {
+		it.join();
+	}
+
+	for (auto& it : errors) {
+		if (it) {
+			rethrow_exception(it);
+		}
+	}
+}
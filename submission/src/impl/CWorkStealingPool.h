@@ -0,0 +1,78 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       CWorkStealingPool.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains class that runs independent tasks on more threads, the idle threads steal the tasks of the busy ones
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Class that runs independent tasks on more threads, the idle threads steal the tasks of the busy ones
+ * 
+ * Usage is following: construct (once) -> call run with the number of the tasks and the task function (as many times as needed)
+ * 
+ * The tasks are split into contiguous ranges, one for every worker. The worker takes the tasks from the front of its range,
+ * when its range is empty it steals the tasks from the back of the ranges of the other workers. Every range is one atomic word
+ * (begin and end), so the owner and the thieves only compete by compare and swap, there is no lock.
+ * The tasks of a different cost are balanced this way and the order of the tasks of one worker stays mostly sequential.
+ * 
+*/
+class CWorkStealingPool
+{
+	const unsigned int threadsCount_; ///< number of the worker threads (including the calling thread)
+
+	/**
+	 * @brief Packs the range of the tasks into one word
+	 * @param begin the first task
+	 * @param end the task after the last one
+	 * @return the packed range
+	*/
+	static uint64_t packRange(uint64_t begin, uint64_t end) { return (begin << 32) | end; }
+	/**
+	 * @brief Takes the first task of the range (the owner of the range)
+	 * @param range the range
+	 * @param task output task
+	 * @return false if the range is empty
+	*/
+	static bool popFront(atomic<uint64_t>& range, size_t& task);
+	/**
+	 * @brief Takes the last task of the range (the other workers)
+	 * @param range the range
+	 * @param task output task
+	 * @return false if the range is empty
+	*/
+	static bool stealBack(atomic<uint64_t>& range, size_t& task);
+public:
+	/**
+	 * @brief Constructor
+	 * @param threadsCount number of the worker threads (0 means number of the hardware threads)
+	*/
+	CWorkStealingPool(unsigned int threadsCount);
+	/**
+	 * @brief Gives number of the worker threads
+	 * @return the number of threads
+	*/
+	size_t getThreadsCount() const { return threadsCount_; }
+	/**
+	 * @brief Runs all the tasks and waits for them
+	 * @param tasksCount number of the tasks (the task gets its index, at most 2^32 - 1 tasks)
+	 * @param task the task function, it is called from more threads at once
+	 * @throw the first exception (in the order of the tasks) that occured in the tasks, all the tasks are run anyway
+	*/
+	void run(size_t tasksCount, const function<void(size_t)>& task);
+};
@@ -0,0 +1,456 @@
+#include "DescriptorKernels.h"
+
+#ifdef DK_X86_KERNELS_ENABLED
+#include <immintrin.h>
+#endif
+
+//========================================RootSIFT========================================
+
+static void rootSiftRowScalar(float* row, int cols)
+{
+	float norm1Sum = 0.0f;
+	for (int j = 0; j < cols; ++j) {
+		norm1Sum += row[j];
+	}
+	//protection against the zero descriptor (the original implementation would produce inf)
+	float invNorm1 = 1.0f / max(norm1Sum, dk::ROOTSIFT_EPS);
+
+	float norm2Sum = 0.0f;
+	for (int j = 0; j < cols; ++j) {
+		row[j] = sqrt((row[j] + dk::ROOTSIFT_EPS) * invNorm1);
+		norm2Sum += row[j] * row[j];
+	}
+
+	float invNorm2 = 1.0f / (norm2Sum + dk::ROOTSIFT_EPS);
+	for (int j = 0; j < cols; ++j) {
+		row[j] *= invNorm2;
+	}
+}
+
+static void rootSiftRowPrecise(float* row, int cols)
+{
+	AutoBuffer<double, 128> buffer(cols);
+	double* values = buffer.data();
+
+	double norm1Sum = 0.0;
+	for (int j = 0; j < cols; ++j) {
+		norm1Sum += row[j];
+	}
+	norm1Sum = max(norm1Sum, (double)dk::ROOTSIFT_EPS);
+
+	double norm2Sum = 0.0;
+	for (int j = 0; j < cols; ++j) {
+		values[j] = sqrt((row[j] + (double)dk::ROOTSIFT_EPS) / norm1Sum);
+		norm2Sum += values[j] * values[j];
+	}
+
+	norm2Sum += dk::ROOTSIFT_EPS;
+	for (int j = 0; j < cols; ++j) {
+		row[j] = (float)(values[j] / norm2Sum);
+	}
+}
+
+#ifdef DK_X86_KERNELS_ENABLED
+/**
+ * @brief horizontal sum of the 8 floats in the AVX register
+*/
+DK_TARGET_AVX2 static inline float horizontalSumAvx2(__m256 v)
+{
+	__m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum);
+}
+
+DK_TARGET_AVX2 static void rootSiftRowAvx2(float* row, int cols)
+{
+	const int vecCols = cols & ~7;
+
+	//L1 norm (two accumulators to hide the latency of the addition)
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	int j = 0;
+	for (; j + 16 <= vecCols; j += 16) {
+		acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(row + j));
+		acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(row + j + 8));
+	}
+	for (; j < vecCols; j += 8) {
+		acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(row + j));
+	}
+	float norm1Sum = horizontalSumAvx2(_mm256_add_ps(acc0, acc1));
+	for (; j < cols; ++j) {
+		norm1Sum += row[j];
+	}
+	float invNorm1 = 1.0f / max(norm1Sum, dk::ROOTSIFT_EPS);
+
+	//square root of the L1 normalised values and the L2 norm
+	const __m256 eps = _mm256_set1_ps(dk::ROOTSIFT_EPS);
+	const __m256 invNorm1Vec = _mm256_set1_ps(invNorm1);
+	__m256 acc2 = _mm256_setzero_ps();
+	for (j = 0; j < vecCols; j += 8) {
+		__m256 v = _mm256_sqrt_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(row + j), eps), invNorm1Vec));
+		_mm256_storeu_ps(row + j, v);
+		acc2 = _mm256_fmadd_ps(v, v, acc2);
+	}
+	float norm2Sum = horizontalSumAvx2(acc2);
+	for (; j < cols; ++j) {
+		row[j] = sqrt((row[j] + dk::ROOTSIFT_EPS) * invNorm1);
+		norm2Sum += row[j] * row[j];
+	}
+
+	//L2 normalisation
+	float invNorm2 = 1.0f / (norm2Sum + dk::ROOTSIFT_EPS);
+	const __m256 invNorm2Vec = _mm256_set1_ps(invNorm2);
+	for (j = 0; j < vecCols; j += 8) {
+		_mm256_storeu_ps(row + j, _mm256_mul_ps(_mm256_loadu_ps(row + j), invNorm2Vec));
+	}
+	for (; j < cols; ++j) {
+		row[j] *= invNorm2;
+	}
+}
+#endif
+
+//========================================quantized L2========================================
+
+static float l2SqrQuantizedScalar(const uchar* query, float invScale, const float* train, int cols)
+{
+	float sum = 0.0f;
+	for (int j = 0; j < cols; ++j) {
+		float diff = query[j] * invScale - train[j];
+		sum += diff * diff;
+	}
+	return sum;
+}
+
+#ifdef DK_X86_KERNELS_ENABLED
+DK_TARGET_AVX2 static float l2SqrQuantizedAvx2(const uchar* query, float invScale, const float* train, int cols)
+{
+	const int vecCols = cols & ~7;
+	const __m256 invScaleVec = _mm256_set1_ps(invScale);
+	__m256 acc = _mm256_setzero_ps();
+	int j = 0;
+	for (; j < vecCols; j += 8) {
+		//8 bytes -> 8 floats
+		__m256i q = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(query + j)));
+		__m256 diff = _mm256_fmsub_ps(_mm256_cvtepi32_ps(q), invScaleVec, _mm256_loadu_ps(train + j));
+		acc = _mm256_fmadd_ps(diff, diff, acc);
+	}
+	float sum = horizontalSumAvx2(acc);
+	for (; j < cols; ++j) {
+		float diff = query[j] * invScale - train[j];
+		sum += diff * diff;
+	}
+	return sum;
+}
+#endif
+
+void dk::quantizeDescriptors(const Mat& descriptors, Mat& quantized, float& scale)
+{
+	if (descriptors.type() != CV_32F) {
+		throw invalid_argument("Only the CV_32F descriptors (SIFT, RootSIFT) can be quantized");
+	}
+	double maxValue = 0.0;
+	if (!descriptors.empty()) {
+		minMaxLoc(descriptors, nullptr, &maxValue);
+	}
+	scale = maxValue > 0.0 ? (float)(255.0 / maxValue) : 1.0f;
+	//rounding and saturation
+	descriptors.convertTo(quantized, CV_8U, scale);
+}
+
+void dk::top2L2Quantized(const Mat& queryQuantized, float queryScale, const Mat& train, STop2Matches& result)
+{
+	if (queryQuantized.type() != CV_8U || train.type() != CV_32F) {
+		throw invalid_argument("Quantized L2 matching needs CV_8U query and CV_32F train descriptors");
+	}
+	if (!queryQuantized.empty() && !train.empty() && queryQuantized.cols != train.cols) {
+		throw invalid_argument("Quantized L2 matching needs descriptors of the same length");
+	}
+	result.resize(queryQuantized.rows);
+
+	typedef float (*DistanceFunction)(const uchar*, float, const float*, int);
+	DistanceFunction distance = l2SqrQuantizedScalar;
+#ifdef DK_X86_KERNELS_ENABLED
+	static const bool avx2Supported = checkHardwareSupport(CV_CPU_AVX2) && checkHardwareSupport(CV_CPU_FMA3);
+	if (avx2Supported) {
+		distance = l2SqrQuantizedAvx2;
+	}
+#endif
+
+	const float invScale = 1.0f / queryScale;
+	const int cols = queryQuantized.cols;
+	double stripes = max(1.0, queryQuantized.rows / 64.0);
+	parallel_for_(Range(0, queryQuantized.rows), [&](const Range& range) {
+		for (int i = range.start; i < range.end; ++i) {
+			const uchar* query = queryQuantized.ptr<uchar>(i);
+			int idx1 = -1, idx2 = -1;
+			float dist1 = numeric_limits<float>::max(), dist2 = numeric_limits<float>::max();
+			for (int t = 0; t < train.rows; ++t) {
+				float dist = distance(query, invScale, train.ptr<float>(t), cols);
+				if (dist < dist1) {
+					dist2 = dist1; idx2 = idx1;
+					dist1 = dist; idx1 = t;
+				}
+				else if (dist < dist2) {
+					dist2 = dist; idx2 = t;
+				}
+			}
+			//squared distances are compared, the result is the L2 distance (the same as NORM_L2 of the OpenCV matchers)
+			result.trainIdx1_[i] = idx1;
+			result.trainIdx2_[i] = idx2;
+			if (idx1 >= 0) result.distance1_[i] = sqrt(dist1);
+			if (idx2 >= 0) result.distance2_[i] = sqrt(dist2);
+		}
+	}, stripes);
+}
+
+//========================================Hamming========================================
+
+static inline int popcount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(x);
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static int hammingScalar(const uint64_t* a, const uint64_t* b, int words)
+{
+	int distance = 0;
+	for (int j = 0; j < words; ++j) {
+		distance += popcount64(a[j] ^ b[j]);
+	}
+	return distance;
+}
+
+#ifdef DK_X86_KERNELS_ENABLED
+DK_TARGET_AVX2 static int hammingAvx2(const uint64_t* a, const uint64_t* b, int words)
+{
+	//popcount of the bytes by the nibble lookup table, the bytes are summed by the SAD instruction
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+											0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i lowMask = _mm256_set1_epi8(0x0F);
+	__m256i acc = _mm256_setzero_si256();
+	for (int j = 0; j < words; j += 4) {
+		__m256i v = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(a + j)),
+									 _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j)));
+		__m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowMask));
+		__m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask));
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+	}
+	__m128i sum = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+	sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+	return (int)_mm_cvtsi128_si64(sum);
+}
+
+DK_TARGET_AVX512_POPCNT static int hammingAvx512(const uint64_t* a, const uint64_t* b, int words)
+{
+	__m512i acc = _mm512_setzero_si512();
+	int j = 0;
+	for (; j + 8 <= words; j += 8) {
+		__m512i v = _mm512_xor_si512(_mm512_loadu_si512(a + j), _mm512_loadu_si512(b + j));
+		acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+	}
+	int distance = (int)_mm512_reduce_add_epi64(acc);
+	//the rest of the row (4 words, e.g. 256 bit ORB descriptor)
+	if (j < words) {
+		__m256i v = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(a + j)),
+									 _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j)));
+		__m256i counts = _mm256_popcnt_epi64(v);
+		__m128i sum = _mm_add_epi64(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1));
+		sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+		distance += (int)_mm_cvtsi128_si64(sum);
+	}
+	return distance;
+}
+#endif
+
+void dk::top2Hamming(const uint64_t* query, int queryRows, const uint64_t* train, int trainRows, int strideWords, STop2Matches& result)
+{
+	if (strideWords % 4 != 0) {
+		throw invalid_argument("Hamming matching needs the row stride to be a multiple of 4 words");
+	}
+	result.resize(queryRows);
+
+	typedef int (*DistanceFunction)(const uint64_t*, const uint64_t*, int);
+	DistanceFunction distance = hammingScalar;
+#ifdef DK_X86_KERNELS_ENABLED
+	static const bool avx512Supported = checkHardwareSupport(CV_CPU_AVX_512F) && checkHardwareSupport(CV_CPU_AVX_512VL) &&
+		checkHardwareSupport(CV_CPU_AVX_512VPOPCNTDQ);
+	static const bool avx2Supported = checkHardwareSupport(CV_CPU_AVX2);
+	if (avx512Supported) {
+		distance = hammingAvx512;
+	}
+	else if (avx2Supported) {
+		distance = hammingAvx2;
+	}
+#endif
+
+	double stripes = max(1.0, queryRows / 64.0);
+	parallel_for_(Range(0, queryRows), [&](const Range& range) {
+		for (int i = range.start; i < range.end; ++i) {
+			const uint64_t* queryRow = query + (size_t)i * strideWords;
+			int idx1 = -1, idx2 = -1;
+			int dist1 = numeric_limits<int>::max(), dist2 = numeric_limits<int>::max();
+			for (int t = 0; t < trainRows; ++t) {
+				int dist = distance(queryRow, train + (size_t)t * strideWords, strideWords);
+				if (dist < dist1) {
+					dist2 = dist1; idx2 = idx1;
+					dist1 = dist; idx1 = t;
+				}
+				else if (dist < dist2) {
+					dist2 = dist; idx2 = t;
+				}
+			}
+			result.trainIdx1_[i] = idx1;
+			result.trainIdx2_[i] = idx2;
+			if (idx1 >= 0) result.distance1_[i] = (float)dist1;
+			if (idx2 >= 0) result.distance2_[i] = (float)dist2;
+		}
+	}, stripes);
+}
+
+//=================================================================================================
+
+bool dk::rootSiftKernelSupported(ERootSiftKernel kernel)
+{
+	if (kernel != ERootSiftKernel::AVX2) {
+		return true;
+	}
+#ifdef DK_X86_KERNELS_ENABLED
+	static const bool avx2Supported = checkHardwareSupport(CV_CPU_AVX2) && checkHardwareSupport(CV_CPU_FMA3);
+	return avx2Supported;
+#else
+	return false;
+#endif
+}
+
+void dk::rootSiftRow(float* row, int cols, ERootSiftKernel kernel)
+{
+	switch (kernel)
+	{
+	case ERootSiftKernel::PRECISE:
+		rootSiftRowPrecise(row, cols);
+		return;
+	case ERootSiftKernel::AVX2:
+#ifdef DK_X86_KERNELS_ENABLED
+		if (rootSiftKernelSupported(kernel)) {
+			rootSiftRowAvx2(row, cols);
+			return;
+		}
+#endif
+		throw invalid_argument("RootSIFT AVX2 kernel is not supported on this platform or CPU");
+	default:
+		rootSiftRowScalar(row, cols);
+		return;
+	}
+}
+
+void dk::rootSiftRow(float* row, int cols, bool preciseAccumulation)
+{
+	if (preciseAccumulation) {
+		rootSiftRow(row, cols, ERootSiftKernel::PRECISE);
+		return;
+	}
+	static const ERootSiftKernel fastKernel = rootSiftKernelSupported(ERootSiftKernel::AVX2) ? ERootSiftKernel::AVX2 : ERootSiftKernel::SCALAR;
+	rootSiftRow(row, cols, fastKernel);
+}
+
+void dk::rootSiftNormalize(Mat& descriptors, bool preciseAccumulation)
+{
+	if (descriptors.type() != CV_32F) {
+		throw invalid_argument("RootSIFT can be computed only from the CV_32F descriptors (SIFT)");
+	}
+	const int cols = descriptors.cols;
+	//one stripe has at least 64 rows so the threads overhead is small
+	double stripes = max(1.0, descriptors.rows / 64.0);
+	parallel_for_(Range(0, descriptors.rows), [&](const Range& range) {
+		for (int i = range.start; i < range.end; ++i) {
+			rootSiftRow(descriptors.ptr<float>(i), cols, preciseAccumulation);
+		}
+	}, stripes);
+}
+
+//========================================GEMM L2========================================
+
+void dk::squaredNorms(const Mat& descriptors, vector<float>& norms)
+{
+	if (!descriptors.empty() && descriptors.type() != CV_32F) {
+		throw invalid_argument("Squared norms can be computed only for the CV_32F descriptors");
+	}
+	norms.resize(descriptors.rows);
+	parallel_for_(Range(0, descriptors.rows), [&](const Range& range) {
+		for (int i = range.start; i < range.end; ++i) {
+			norms[i] = normL2Sqr<float, float>(descriptors.ptr<float>(i), descriptors.cols);
+		}
+	});
+}
+
+void dk::top2L2Gemm(const Mat& query, const Mat& train, const vector<float>& trainNorms, STop2Matches& result)
+{
+	if ((!query.empty() && query.type() != CV_32F) || (!train.empty() && train.type() != CV_32F)) {
+		throw invalid_argument("GEMM L2 matching needs CV_32F descriptors");
+	}
+	if (!query.empty() && !train.empty() && query.cols != train.cols) {
+		throw invalid_argument("GEMM L2 matching needs descriptors of the same length");
+	}
+	if (trainNorms.size() != (size_t)train.rows) {
+		throw invalid_argument("GEMM L2 matching needs the squared norms of all the train descriptors");
+	}
+	result.resize(query.rows);
+	if (query.empty() || train.empty()) {
+		return;
+	}
+
+	const int cols = query.cols;
+	const int queryBlocks = (query.rows + GEMM_QUERY_BLOCK - 1) / GEMM_QUERY_BLOCK;
+	parallel_for_(Range(0, queryBlocks), [&](const Range& range) {
+		Mat dots; //the tile, reused by all the blocks of the task
+		for (int block = range.start; block < range.end; ++block) {
+			const int queryBegin = block * GEMM_QUERY_BLOCK;
+			const int queryEnd = min(query.rows, queryBegin + GEMM_QUERY_BLOCK);
+			const Mat queryBlock = query.rowRange(queryBegin, queryEnd);
+			for (int trainBegin = 0; trainBegin < train.rows; trainBegin += GEMM_TRAIN_BLOCK) {
+				const int trainEnd = min(train.rows, trainBegin + GEMM_TRAIN_BLOCK);
+				gemm(queryBlock, train.rowRange(trainBegin, trainEnd), 1.0, noArray(), 0.0, dots, GEMM_2_T);
+				//fused top-2 selection of the tile (the partial distance |t|^2 - 2 q.t)
+				for (int q = 0; q < queryBlock.rows; ++q) {
+					const float* dot = dots.ptr<float>(q);
+					const int i = queryBegin + q;
+					int idx1 = result.trainIdx1_[i], idx2 = result.trainIdx2_[i];
+					float dist1 = result.distance1_[i], dist2 = result.distance2_[i];
+					for (int t = 0; t < trainEnd - trainBegin; ++t) {
+						float dist = trainNorms[trainBegin + t] - 2.0f * dot[t];
+						if (dist < dist1) {
+							dist2 = dist1; idx2 = idx1;
+							dist1 = dist; idx1 = trainBegin + t;
+						}
+						else if (dist < dist2) {
+							dist2 = dist; idx2 = trainBegin + t;
+						}
+					}
+					result.trainIdx1_[i] = idx1; result.distance1_[i] = dist1;
+					result.trainIdx2_[i] = idx2; result.distance2_[i] = dist2;
+				}
+			}
+			//the exact distances of the found neighbours (the same as NORM_L2 of the OpenCV matchers)
+			for (int i = queryBegin; i < queryEnd; ++i) {
+				const float* row = query.ptr<float>(i);
+				result.distance1_[i] = sqrt(normL2Sqr<float, float>(row, train.ptr<float>(result.trainIdx1_[i]), cols));
+				if (result.trainIdx2_[i] < 0) {
+					result.distance2_[i] = numeric_limits<float>::max();
+					continue;
+				}
+				result.distance2_[i] = sqrt(normL2Sqr<float, float>(row, train.ptr<float>(result.trainIdx2_[i]), cols));
+				if (result.distance2_[i] < result.distance1_[i]) {
+					swap(result.trainIdx1_[i], result.trainIdx2_[i]);
+					swap(result.distance1_[i], result.distance2_[i]);
+				}
+			}
+		}
+	});
+}
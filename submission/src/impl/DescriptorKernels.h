@@ -0,0 +1,200 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       DescriptorKernels.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains low level (vectorised) kernels working with the keypoint descriptors
+ *
+ * (all of them are in dk namespace - descriptor kernels)
+ *
+ * The kernels have a SIMD implementation (AVX2) that is chosen at runtime when the CPU supports it, otherwise the scalar fallback is used.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdexcept>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+//Matrices
+#include <opencv2/core/mat.hpp>
+//parallel_for_, hardware support checks
+#include <opencv2/core/utility.hpp>
+//gemm
+#include <opencv2/core.hpp>
+
+using namespace std;
+using namespace cv;
+
+//x86 SIMD kernels are compiled only for x86 platforms (GCC and Clang need the target attribute, MSVC allows the intrinsics without it)
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DK_X86_KERNELS_ENABLED
+#if defined(__GNUC__) || defined(__clang__)
+#define DK_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define DK_TARGET_AVX512_POPCNT __attribute__((target("avx512f,avx512vl,avx512vpopcntdq")))
+#else
+#define DK_TARGET_AVX2
+#define DK_TARGET_AVX512_POPCNT
+#endif
+#endif
+
+namespace dk {
+	/**
+	 * @brief epsilon used in the RootSIFT computation (the same as in the original CImage implementation)
+	*/
+	const float ROOTSIFT_EPS = 1e-7f;
+	/**
+	 * @brief maximal absolute difference of a RootSIFT descriptor value computed by rootSiftNormalize from the original CImage implementation
+	 * 
+	 * The values are in range [0, 1], the float accumulation of 128 values gives error in order of 1e-7, so the tolerance has a big reserve.
+	 * All the kernels are checked against it by the standalone RootSIFT check (src/checks/RootSiftCheck.cpp).
+	 * 
+	*/
+	const float ROOTSIFT_TOLERANCE = 1e-5f;
+	/**
+	 * @brief Implementations of the RootSIFT of one descriptor
+	*/
+	enum class ERootSiftKernel {
+		SCALAR, ///< scalar float computation (the fallback of AVX2)
+		AVX2, ///< vectorised float computation (only x86 CPUs with AVX2 and FMA)
+		PRECISE ///< scalar double precision computation
+	};
+	/**
+	 * @brief Checks whether the RootSIFT kernel can run on this platform and CPU
+	 * @param kernel the kernel
+	 * @return true if the kernel can be used
+	*/
+	bool rootSiftKernelSupported(ERootSiftKernel kernel);
+	/**
+	 * @brief RootSIFT (Hellinger kernel) of one descriptor by the given kernel, in place
+	 * @param row the descriptor values (non-negative)
+	 * @param cols number of the values
+	 * @param kernel the kernel
+	 * @throw invalid_argument if the kernel is not supported (see rootSiftKernelSupported)
+	*/
+	void rootSiftRow(float* row, int cols, ERootSiftKernel kernel);
+	/**
+	 * @brief RootSIFT (Hellinger kernel) of one descriptor, in place: L1 normalisation -> square root -> L2 normalisation
+	 * 
+	 * The L2 normalisation follows the original implementation (division by the sum of squares, that is 1 after the L1 normalisation and square root)
+	 * 
+	 * @param row the descriptor values (non-negative)
+	 * @param cols number of the values
+	 * @param preciseAccumulation if true the scalar double precision computation is used instead of the vectorised float one
+	*/
+	void rootSiftRow(float* row, int cols, bool preciseAccumulation);
+	/**
+	 * @brief Converts all the SIFT descriptors into the RootSIFT descriptors, in place and rows in parallel
+	 * 
+	 * The result differs from the original implementation at most by ROOTSIFT_TOLERANCE
+	 * 
+	 * @param descriptors SIFT descriptors (CV_32F, one descriptor per row)
+	 * @param preciseAccumulation if true the scalar double precision computation is used instead of the vectorised float one
+	 * @throw invalid_argument if the descriptors are not CV_32F
+	*/
+	void rootSiftNormalize(Mat& descriptors, bool preciseAccumulation);
+
+	/**
+	 * @brief Flat result of the search for the two nearest neighbours (one item for every query descriptor)
+	 * 
+	 * Index -1 means that the neighbour was not found (the train set has less descriptors), its distance is then max float.
+	 * 
+	*/
+	struct STop2Matches {
+		vector<int> trainIdx1_; ///< index of the nearest train descriptor
+		vector<float> distance1_; ///< distance to the nearest train descriptor
+		vector<int> trainIdx2_; ///< index of the second nearest train descriptor
+		vector<float> distance2_; ///< distance to the second nearest train descriptor
+
+		/**
+		 * @brief Resizes all the arrays, the new items are "not found"
+		 * @param count number of the query descriptors
+		*/
+		void resize(size_t count) {
+			trainIdx1_.assign(count, -1);
+			distance1_.assign(count, numeric_limits<float>::max());
+			trainIdx2_.assign(count, -1);
+			distance2_.assign(count, numeric_limits<float>::max());
+		}
+		/**
+		 * @brief Gives number of the query descriptors
+		 * @return the count
+		*/
+		size_t size() const { return trainIdx1_.size(); }
+	};
+
+	/**
+	 * @brief Quantizes the float descriptors (SIFT, RootSIFT) into bytes, quantized value = round(value * scale)
+	 * 
+	 * The scale is chosen so the maximal value of all the descriptors is 255 (one scale for the whole matrix)
+	 * 
+	 * @param descriptors float descriptors (CV_32F, non-negative values)
+	 * @param quantized output quantized descriptors (CV_8U, the same size)
+	 * @param scale output scale of the quantization
+	 * @throw invalid_argument if the descriptors are not CV_32F
+	*/
+	void quantizeDescriptors(const Mat& descriptors, Mat& quantized, float& scale);
+	/**
+	 * @brief Finds two nearest train descriptors (L2 distance) for every quantized query descriptor, brute force, query rows in parallel
+	 * 
+	 * The distance is computed directly on the quantized data: |query / scale - train|, the query is never converted into the float matrix.
+	 * 
+	 * @param queryQuantized quantized query descriptors (CV_8U)
+	 * @param queryScale scale of the query quantization (see quantizeDescriptors)
+	 * @param train float train descriptors (CV_32F, the same number of columns)
+	 * @param result output nearest neighbours
+	 * @throw invalid_argument if the types or sizes of the descriptors are wrong
+	*/
+	void top2L2Quantized(const Mat& queryQuantized, float queryScale, const Mat& train, STop2Matches& result);
+	/**
+	 * @brief Finds two nearest train descriptors (Hamming distance) for every query descriptor, brute force, query rows in parallel
+	 * 
+	 * The descriptors are packed bits in 64 bit words, every row has strideWords words (multiple of 4, the padding words are zero).
+	 * The popcount kernel is chosen at runtime: AVX-512 VPOPCNTDQ -> AVX2 (nibble lookup) -> scalar.
+	 * 
+	 * @param query packed query descriptors
+	 * @param queryRows number of the query descriptors
+	 * @param train packed train descriptors
+	 * @param trainRows number of the train descriptors
+	 * @param strideWords number of the words of one row (the same for the query and the train, multiple of 4)
+	 * @param result output nearest neighbours (the distance is the number of different bits)
+	 * @throw invalid_argument if the stride is not a multiple of 4
+	*/
+	void top2Hamming(const uint64_t* query, int queryRows, const uint64_t* train, int trainRows, int strideWords, STop2Matches& result);
+
+	/**
+	 * @brief number of the query descriptors in one tile of the GEMM matching (one parallel task)
+	*/
+	const int GEMM_QUERY_BLOCK = 128;
+	/**
+	 * @brief number of the train descriptors in one tile of the GEMM matching (128 x 512 floats = 256 kB of the dot products)
+	*/
+	const int GEMM_TRAIN_BLOCK = 512;
+	/**
+	 * @brief Computes the squared L2 norms of the float descriptors
+	 * @param descriptors float descriptors (CV_32F, one descriptor per row)
+	 * @param norms output squared norms (one per row)
+	 * @throw invalid_argument if the descriptors are not CV_32F
+	*/
+	void squaredNorms(const Mat& descriptors, vector<float>& norms);
+	/**
+	 * @brief Finds two nearest train descriptors (L2 distance) for every query descriptor, brute force by the matrix multiplication
+	 * 
+	 * The squared distance is expanded as |q|^2 + |t|^2 - 2 q.t, the dot products of a tile (query block x train block) are computed by gemm
+	 * and the two nearest neighbours are selected directly from the tile, so the whole distance matrix is never stored.
+	 * |q|^2 does not change the order within the query row, so it is not added at all. The distances of the two found
+	 * neighbours are computed again directly (the expansion loses the precision), so they are the same as the ones of BFMatcher.
+	 * The query blocks are processed in parallel.
+	 * 
+	 * @param query float query descriptors (CV_32F)
+	 * @param train float train descriptors (CV_32F, the same number of columns)
+	 * @param trainNorms squared norms of the train descriptors (see squaredNorms)
+	 * @param result output nearest neighbours
+	 * @throw invalid_argument if the types or sizes of the descriptors are wrong
+	*/
+	void top2L2Gemm(const Mat& query, const Mat& train, const vector<float>& trainNorms, STop2Matches& result);
+}
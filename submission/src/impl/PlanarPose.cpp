@@ -0,0 +1,329 @@
+#include "PlanarPose.h"
+
+/**
+ * @brief Solves the linear system in place by the Gaussian elimination with the partial pivoting
+ * @tparam N size of the system
+ * @param a matrix of the system (it is destroyed)
+ * @param b right side, the solution on the output
+ * @return false if the system is singular
+*/
+template<int N>
+static bool solveLinearSystem(Matx<double, N, N>& a, Vec<double, N>& b)
+{
+	for (int col = 0; col < N; ++col) {
+		int pivot = col;
+		for (int row = col + 1; row < N; ++row) {
+			if (abs(a(row, col)) > abs(a(pivot, col))) {
+				pivot = row;
+			}
+		}
+		if (abs(a(pivot, col)) < pp::PIVOT_EPS) {
+			return false;
+		}
+		if (pivot != col) {
+			for (int j = col; j < N; ++j) {
+				swap(a(pivot, j), a(col, j));
+			}
+			swap(b[pivot], b[col]);
+		}
+		for (int row = col + 1; row < N; ++row) {
+			double factor = a(row, col) / a(col, col);
+			for (int j = col; j < N; ++j) {
+				a(row, j) -= factor * a(col, j);
+			}
+			b[row] -= factor * b[col];
+		}
+	}
+	for (int row = N - 1; row >= 0; --row) {
+		double sum = b[row];
+		for (int j = row + 1; j < N; ++j) {
+			sum -= a(row, j) * b[j];
+		}
+		b[row] = sum / a(row, row);
+	}
+	return true;
+}
+
+/**
+ * @brief Gives the skew-symmetric (cross product) matrix of the vector
+*/
+static Matx33d crossMatrix(const Vec3d& v)
+{
+	return Matx33d(
+		0.0, -v[2], v[1],
+		v[2], 0.0, -v[0],
+		-v[1], v[0], 0.0);
+}
+
+/**
+ * @brief Translation with the lowest algebraic error for the given rotation (linear least squares in the normalized image coordinates)
+ * @param R the rotation
+ * @param centeredPoints object points centered around the origin of the plane (z = 0)
+ * @param normalizedPoints image points in the normalized image coordinates
+ * @param t output translation
+ * @return false if the system is singular
+*/
+static bool solveTranslation(const Matx33d& R, const array<Point2d, pp::PLANAR_POSE_POINTS>& centeredPoints,
+	const array<Point2d, pp::PLANAR_POSE_POINTS>& normalizedPoints, Vec3d& t)
+{
+	Matx33d normal = Matx33d::zeros();
+	Vec3d right;
+	for (int i = 0; i < pp::PLANAR_POSE_POINTS; ++i) {
+		Vec3d rotated = R * Vec3d(centeredPoints[i].x, centeredPoints[i].y, 0.0);
+		double u = normalizedPoints[i].x, v = normalizedPoints[i].y;
+		//(1, 0, -u) * t = u * Z - X and (0, 1, -v) * t = v * Z - Y
+		Vec3d rowU(1.0, 0.0, -u), rowV(0.0, 1.0, -v);
+		double rightU = u * rotated[2] - rotated[0];
+		double rightV = v * rotated[2] - rotated[1];
+		normal += rowU * rowU.t() + rowV * rowV.t();
+		right += rowU * rightU + rowV * rightV;
+	}
+	t = right;
+	return solveLinearSystem<3>(normal, t);
+}
+
+/**
+ * @brief Root mean square reprojection error of the centered points (the plane is z = 0)
+*/
+static double centeredReprojectionError(const Matx33d& R, const Vec3d& t, const array<Point2d, pp::PLANAR_POSE_POINTS>& centeredPoints,
+	const array<Point2d, pp::PLANAR_POSE_POINTS>& imagePoints, const Matx33d& cameraMatrix)
+{
+	double sum = 0.0;
+	for (int i = 0; i < pp::PLANAR_POSE_POINTS; ++i) {
+		Vec3d camera = R * Vec3d(centeredPoints[i].x, centeredPoints[i].y, 0.0) + t;
+		if (camera[2] <= 0.0) {
+			return numeric_limits<double>::max();
+		}
+		Vec3d projected = cameraMatrix * camera;
+		double dx = projected[0] / projected[2] - imagePoints[i].x;
+		double dy = projected[1] / projected[2] - imagePoints[i].y;
+		sum += dx * dx + dy * dy;
+	}
+	return sqrt(sum / pp::PLANAR_POSE_POINTS);
+}
+
+/**
+ * @brief One Gauss-Newton step of the reprojection error (rotation is updated on the left - exp(w) * R, translation is added)
+ * @return false if the normal equations are singular
+*/
+static bool refinementStep(const Matx33d& R, const Vec3d& t, const array<Point2d, pp::PLANAR_POSE_POINTS>& centeredPoints,
+	const array<Point2d, pp::PLANAR_POSE_POINTS>& imagePoints, const Matx33d& cameraMatrix, Matx33d& refinedR, Vec3d& refinedT)
+{
+	const double fx = cameraMatrix(0, 0), fy = cameraMatrix(1, 1), cx = cameraMatrix(0, 2), cy = cameraMatrix(1, 2);
+	Matx<double, 6, 6> normal = Matx<double, 6, 6>::zeros();
+	Vec<double, 6> gradient;
+	for (int i = 0; i < pp::PLANAR_POSE_POINTS; ++i) {
+		Vec3d rotated = R * Vec3d(centeredPoints[i].x, centeredPoints[i].y, 0.0);
+		Vec3d camera = rotated + t;
+		double invZ = 1.0 / camera[2];
+		//derivative of the projection by the camera space point
+		Matx<double, 2, 3> projection(
+			fx * invZ, 0.0, -fx * camera[0] * invZ * invZ,
+			0.0, fy * invZ, -fy * camera[1] * invZ * invZ);
+		//derivative of the camera space point by the rotation (-[RX]x) and by the translation (I)
+		Matx<double, 3, 6> point;
+		Matx33d rotationPart = -crossMatrix(rotated);
+		for (int r = 0; r < 3; ++r) {
+			for (int c = 0; c < 3; ++c) {
+				point(r, c) = rotationPart(r, c);
+			}
+			point(r, 3 + r) = 1.0;
+		}
+		Matx<double, 2, 6> jacobian = projection * point;
+		Vec2d residual(fx * camera[0] * invZ + cx - imagePoints[i].x, fy * camera[1] * invZ + cy - imagePoints[i].y);
+		normal += jacobian.t() * jacobian;
+		gradient += jacobian.t() * residual;
+	}
+	Vec<double, 6> step = -gradient;
+	if (!solveLinearSystem<6>(normal, step)) {
+		return false;
+	}
+	refinedR = pp::rotationVectorToMatrix(Vec3d(step[0], step[1], step[2])) * R;
+	refinedT = t + Vec3d(step[3], step[4], step[5]);
+	return true;
+}
+
+//=================================================================================================
+
+Matx33d pp::rotationVectorToMatrix(const Vec3d& rVec)
+{
+	double theta = norm(rVec);
+	if (theta < numeric_limits<double>::epsilon()) {
+		return Matx33d::eye() + crossMatrix(rVec);
+	}
+	Matx33d k = crossMatrix(rVec * (1.0 / theta));
+	return Matx33d::eye() + k * sin(theta) + (k * k) * (1.0 - cos(theta));
+}
+
+Vec3d pp::rotationMatrixToVector(const Matx33d& R)
+{
+	Vec3d skew(R(2, 1) - R(1, 2), R(0, 2) - R(2, 0), R(1, 0) - R(0, 1));
+	double sinTheta = 0.5 * norm(skew);
+	double cosTheta = max(-1.0, min(1.0, 0.5 * (R(0, 0) + R(1, 1) + R(2, 2) - 1.0)));
+	double theta = atan2(sinTheta, cosTheta);
+	if (sinTheta < 1e-5) {
+		if (cosTheta > 0.0) {
+			//the angle close to zero - first order approximation
+			return skew * 0.5;
+		}
+		//the angle close to pi - the axis from the symmetric part (R = 2 * a * a^T - I)
+		int largest = 0;
+		for (int i = 1; i < 3; ++i) {
+			if (R(i, i) > R(largest, largest)) {
+				largest = i;
+			}
+		}
+		Vec3d axis;
+		axis[largest] = sqrt(max(0.0, (R(largest, largest) + 1.0) * 0.5));
+		for (int i = 0; i < 3; ++i) {
+			if (i != largest) {
+				axis[i] = (R(largest, i) + R(i, largest)) / (4.0 * axis[largest]);
+			}
+		}
+		return axis * (theta / norm(axis));
+	}
+	return skew * (theta / (2.0 * sinTheta));
+}
+
+double pp::reprojectionError(const SPlanarPose& pose, const array<Point2d, PLANAR_POSE_POINTS>& objectPoints, double planeZ,
+	const array<Point2d, PLANAR_POSE_POINTS>& imagePoints, const Matx33d& cameraMatrix)
+{
+	double sum = 0.0;
+	for (int i = 0; i < PLANAR_POSE_POINTS; ++i) {
+		Vec3d camera = pose.R_ * Vec3d(objectPoints[i].x, objectPoints[i].y, planeZ) + pose.t_;
+		if (camera[2] <= 0.0) {
+			return numeric_limits<double>::max();
+		}
+		Vec3d projected = cameraMatrix * camera;
+		double dx = projected[0] / projected[2] - imagePoints[i].x;
+		double dy = projected[1] / projected[2] - imagePoints[i].y;
+		sum += dx * dx + dy * dy;
+	}
+	return sqrt(sum / PLANAR_POSE_POINTS);
+}
+
+bool pp::solvePlanarPose(const array<Point2d, PLANAR_POSE_POINTS>& objectPoints, double planeZ,
+	const array<Point2d, PLANAR_POSE_POINTS>& imagePoints, const Matx33d& cameraMatrix, bool refine, SPlanarPose& pose)
+{
+	//the object points are centered (IPPE decomposes the homography in the origin) and scaled for the homography estimation
+	Point2d origin(0.0, 0.0);
+	for (int i = 0; i < PLANAR_POSE_POINTS; ++i) {
+		origin += objectPoints[i];
+	}
+	origin *= 1.0 / PLANAR_POSE_POINTS;
+	array<Point2d, PLANAR_POSE_POINTS> centeredPoints;
+	double scale = 0.0;
+	for (int i = 0; i < PLANAR_POSE_POINTS; ++i) {
+		centeredPoints[i] = objectPoints[i] - origin;
+		scale = max(scale, max(abs(centeredPoints[i].x), abs(centeredPoints[i].y)));
+	}
+	if (scale <= 0.0) {
+		return false;
+	}
+	//normalized image coordinates (the inverse of the camera matrix without skew)
+	const double fx = cameraMatrix(0, 0), fy = cameraMatrix(1, 1), cx = cameraMatrix(0, 2), cy = cameraMatrix(1, 2);
+	array<Point2d, PLANAR_POSE_POINTS> normalizedPoints;
+	for (int i = 0; i < PLANAR_POSE_POINTS; ++i) {
+		normalizedPoints[i] = Point2d((imagePoints[i].x - cx) / fx, (imagePoints[i].y - cy) / fy);
+	}
+
+	//homography from the scaled plane to the normalized image (h22 = 1), two equations per point
+	Matx<double, 8, 8> system = Matx<double, 8, 8>::zeros();
+	Vec<double, 8> h;
+	for (int i = 0; i < PLANAR_POSE_POINTS; ++i) {
+		double x = centeredPoints[i].x / scale, y = centeredPoints[i].y / scale;
+		double u = normalizedPoints[i].x, v = normalizedPoints[i].y;
+		double rowU[8] = { x, y, 1.0, 0.0, 0.0, 0.0, -u * x, -u * y };
+		double rowV[8] = { 0.0, 0.0, 0.0, x, y, 1.0, -v * x, -v * y };
+		for (int j = 0; j < 8; ++j) {
+			system(2 * i, j) = rowU[j];
+			system(2 * i + 1, j) = rowV[j];
+		}
+		h[2 * i] = u;
+		h[2 * i + 1] = v;
+	}
+	if (!solveLinearSystem<8>(system, h)) {
+		return false;
+	}
+
+	//projection of the plane origin and the jacobian of the homography in the origin
+	const double p = h[2], q = h[5];
+	const double j00 = h[0] - h[6] * p, j01 = h[1] - h[7] * p;
+	const double j10 = h[3] - h[6] * q, j11 = h[4] - h[7] * q;
+
+	//Rv - rotation of the z axis to the direction of the projected origin
+	Vec3d direction = Vec3d(p, q, 1.0) * (1.0 / sqrt(p * p + q * q + 1.0));
+	Matx33d k = crossMatrix(Vec3d(-direction[1], direction[0], 0.0));
+	Matx33d rv = Matx33d::eye() + k + (k * k) * (1.0 / (1.0 + direction[2]));
+
+	//B = [I | -v] * Rv restricted to the first two columns, A = B^-1 * J
+	Matx22d b(
+		rv(0, 0) - p * rv(2, 0), rv(0, 1) - p * rv(2, 1),
+		rv(1, 0) - q * rv(2, 0), rv(1, 1) - q * rv(2, 1));
+	double determinantB = b(0, 0) * b(1, 1) - b(0, 1) * b(1, 0);
+	if (abs(determinantB) < PIVOT_EPS) {
+		return false;
+	}
+	Matx22d bInverse(b(1, 1), -b(0, 1), -b(1, 0), b(0, 0));
+	Matx22d a = bInverse * (1.0 / determinantB) * Matx22d(j00, j01, j10, j11);
+
+	//largest singular value of A
+	double frobenius = a(0, 0) * a(0, 0) + a(0, 1) * a(0, 1) + a(1, 0) * a(1, 0) + a(1, 1) * a(1, 1);
+	double determinantA = a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+	double gamma = sqrt(0.5 * (frobenius + sqrt(max(0.0, frobenius * frobenius - 4.0 * determinantA * determinantA))));
+	if (gamma < PIVOT_EPS) {
+		return false;
+	}
+	Matx22d r22 = a * (1.0 / gamma);
+
+	//the third row of the first two columns (b * b^T = I - R22^T * R22)
+	double b0 = sqrt(max(0.0, 1.0 - r22(0, 0) * r22(0, 0) - r22(1, 0) * r22(1, 0)));
+	double b1 = sqrt(max(0.0, 1.0 - r22(0, 1) * r22(0, 1) - r22(1, 1) * r22(1, 1)));
+	if (-(r22(0, 0) * r22(0, 1) + r22(1, 0) * r22(1, 1)) < 0.0) {
+		b1 = -b1;
+	}
+
+	//two solutions of the plane ambiguity (the sign of the third row), the one with the lower reprojection error is chosen
+	bool found = false;
+	for (double sign : { 1.0, -1.0 }) {
+		Vec3d column0(r22(0, 0), r22(1, 0), sign * b0);
+		Vec3d column1(r22(0, 1), r22(1, 1), sign * b1);
+		Vec3d column2 = column0.cross(column1);
+		Matx33d local(
+			column0[0], column1[0], column2[0],
+			column0[1], column1[1], column2[1],
+			column0[2], column1[2], column2[2]);
+		Matx33d R = rv * local;
+		Vec3d t;
+		if (!solveTranslation(R, centeredPoints, normalizedPoints, t)) {
+			continue;
+		}
+		double error = centeredReprojectionError(R, t, centeredPoints, imagePoints, cameraMatrix);
+		if (!found || error < pose.reprojectionError_) {
+			pose.R_ = R;
+			pose.t_ = t;
+			pose.reprojectionError_ = error;
+			found = true;
+		}
+	}
+	if (!found || pose.reprojectionError_ == numeric_limits<double>::max()) {
+		return false;
+	}
+
+	if (refine) {
+		Matx33d refinedR;
+		Vec3d refinedT;
+		if (refinementStep(pose.R_, pose.t_, centeredPoints, imagePoints, cameraMatrix, refinedR, refinedT)) {
+			double error = centeredReprojectionError(refinedR, refinedT, centeredPoints, imagePoints, cameraMatrix);
+			if (error < pose.reprojectionError_) {
+				pose.R_ = refinedR;
+				pose.t_ = refinedT;
+				pose.reprojectionError_ = error;
+			}
+		}
+	}
+
+	//back from the centered plane to the original one - X_centered = X - (origin, planeZ)
+	pose.t_ -= pose.R_ * Vec3d(origin.x, origin.y, planeZ);
+	return true;
+}
@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------------------
+/**
+ * \file       PlanarPose.h
+ * \author     Pavel Kriz
+ * \date       16/10/2026
+ * \brief      Contains the closed-form pose solver of the planar object (IPPE) working only with the fixed-size matrices
+ *
+ * (all of them are in pp namespace - planar pose)
+ *
+ * The solver is the Infinitesimal Plane-based Pose Estimation (T. Collins, A. Bartoli: Infinitesimal Plane-Based Pose Estimation, IJCV 2014).
+ * Nothing is allocated on the heap, all the matrices are Matx/Vec and the linear systems are solved in place.
+ *
+*/
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cmath>
+#include <array>
+#include <limits>
+#include <algorithm>
+
+//fixed-size matrices (Matx, Vec) and points
+#include <opencv2/core/matx.hpp>
+#include <opencv2/core/types.hpp>
+
+using namespace std;
+using namespace cv;
+
+namespace pp {
+	/**
+	 * @brief number of the points of the solver (corners of the reference image)
+	*/
+	const int PLANAR_POSE_POINTS = 4;
+	/**
+	 * @brief the linear system with the smaller pivot is considered singular (the coordinates are normalized before)
+	*/
+	const double PIVOT_EPS = 1e-12;
+
+	/**
+	 * @brief Pose of the camera - the point X of the object is in the camera space R_ * X + t_
+	*/
+	struct SPlanarPose {
+		Matx33d R_ = Matx33d::eye(); ///< rotation from the object space to the camera space
+		Vec3d t_; ///< translation from the object space to the camera space
+		double reprojectionError_ = numeric_limits<double>::max(); ///< root mean square reprojection error of the points in pixels
+	};
+
+	/**
+	 * @brief Converts the rotation vector to the rotation matrix (the same as Rodrigues, without the heap allocation)
+	 * @param rVec rotation vector (axis scaled by the angle in radians)
+	 * @return the rotation matrix
+	*/
+	Matx33d rotationVectorToMatrix(const Vec3d& rVec);
+	/**
+	 * @brief Converts the rotation matrix to the rotation vector (the same as Rodrigues, without the heap allocation)
+	 * @param R the rotation matrix (orthonormal)
+	 * @return rotation vector (axis scaled by the angle in radians, the angle is in range <0, pi>)
+	*/
+	Vec3d rotationMatrixToVector(const Matx33d& R);
+	/**
+	 * @brief Computes the root mean square reprojection error of the planar points
+	 * @param pose the pose (reprojectionError_ is not used)
+	 * @param objectPoints points of the object plane (x, y, planeZ)
+	 * @param planeZ z coordinate of the object plane
+	 * @param imagePoints the observed projections of the object points in pixels
+	 * @param cameraMatrix camera intrinsics matrix (without skew)
+	 * @return the error in pixels (max double if any point is behind the camera)
+	*/
+	double reprojectionError(const SPlanarPose& pose, const array<Point2d, PLANAR_POSE_POINTS>& objectPoints, double planeZ,
+		const array<Point2d, PLANAR_POSE_POINTS>& imagePoints, const Matx33d& cameraMatrix);
+	/**
+	 * @brief Solves the pose of the planar object by IPPE (both solutions of the plane ambiguity are computed, the one with the lower error is chosen)
+	 *
+	 * The object plane is z = planeZ, the object points are centered inside the solver so any placement of the plane is allowed.
+	 * The refinement is one Gauss-Newton step minimizing the reprojection error (it is kept only if it lowers the error).
+	 *
+	 * @param objectPoints points of the object plane (x, y, planeZ), no three of them can be collinear
+	 * @param planeZ z coordinate of the object plane
+	 * @param imagePoints the observed projections of the object points in pixels
+	 * @param cameraMatrix camera intrinsics matrix (without skew)
+	 * @param refine whether the refinement step is done
+	 * @param pose output pose with its reprojection error
+	 * @return false if the configuration of the points is degenerated (the pose is not set)
+	*/
+	bool solvePlanarPose(const array<Point2d, PLANAR_POSE_POINTS>& objectPoints, double planeZ,
+		const array<Point2d, PLANAR_POSE_POINTS>& imagePoints, const Matx33d& cameraMatrix, bool refine, SPlanarPose& pose);
+}
@@ -21,6 +21,10 @@ string algToStr(const EAlgorithm alg) {
 		return BF_MATCHING_STR;
 	case EAlgorithm::ALG_FLANN_MATCHING:
 		return FLANN_MATCHING_STR;
+	case EAlgorithm::ALG_HNSW_MATCHING:
+		return HNSW_MATCHING_STR;
+	case EAlgorithm::ALG_GEMM_MATCHING:
+		return GEMM_MATCHING_STR;
 	default:
 		throw invalid_argument("Error algorithm method cannot be converted to string, the string is not known! (probably non recognized method)");
 		break;
@@ -52,13 +56,19 @@ EAlgorithm strToAlg(const string& str)
 	else if (str == FLANN_MATCHING_STR) {
 		return EAlgorithm::ALG_FLANN_MATCHING;
 	}
+	else if (str == HNSW_MATCHING_STR) {
+		return EAlgorithm::ALG_HNSW_MATCHING;
+	}
+	else if (str == GEMM_MATCHING_STR) {
+		return EAlgorithm::ALG_GEMM_MATCHING;
+	}
 	else {
 		throw invalid_argument("Error invalid algorithm method was used! The string has to have one of following form: " +
 			SIFT_STR + " , " + ROOTSIFT_STR + " , " + PRECISE_ROOTSIFT_STR + " , " + ORB_STR +
 #ifdef COMPILE_EXPERIMENTAL_MODULES_ENABLED
 			BEBLID_STR + " , " +
 #endif
-			BF_MATCHING_STR + " , " + FLANN_MATCHING_STR
+			BF_MATCHING_STR + " , " + FLANN_MATCHING_STR + " , " + HNSW_MATCHING_STR + " , " + GEMM_MATCHING_STR
 		);
 	}
 }
@@ -36,8 +36,20 @@ const string ORB_STR =  "ORB";
 const string BEBLID_STR = "BEBLID";
 #endif
 
+const string CLAHE_STR = "CLAHE";
+const string ADAPTIVE_CLAHE_STR = "adaptive";
+
 const string BF_MATCHING_STR = "BF_matching";
 const string FLANN_MATCHING_STR = "FLANN_matching";
+const string HNSW_MATCHING_STR = "HNSW_matching";
+const string GEMM_MATCHING_STR = "GEMM_matching";
+//matching direction
+const string OBJECT_TO_SCENE_STR = "object_to_scene";
+const string SCENE_TO_OBJECT_STR = "scene_to_object";
+const string AUTO_DIRECTION_STR = "auto";
+//pose solver
+const string ITERATIVE_POSE_STR = "iterative";
+const string IPPE_POSE_STR = "IPPE";
 
 //========================================console or file system========================================
 /**
@@ -107,6 +119,194 @@ struct SBEBLIDParams {
 };
 #endif
 
+///Descriptor cache parameters
+/**
+  The cache stores keypoints and descriptors of the reference images on the disk (see CDescriptorCache)
+*/
+struct SDescriptorCacheParams {
+	bool enabled_ = false; ///< whether the keypoints and descriptors of the reference images are cached on the disk
+	string directory_ = "descriptor_cache"; ///< directory with the cache entries (relative to the place where the app is running)
+};
+
+/**
+ * @brief Enum for specifying the contrast enhancement of the images before the detection
+*/
+enum class EContrastEnhancement {
+	CLAHE, ///< CLAHE is always done
+	ADAPTIVE ///< CLAHE is done only when the local contrast of the image requires it, otherwise the global histogram equalisation is done
+};
+
+///Contrast enhancement parameters
+/**
+  Parameters of the preprocessing stage (see CClaheStage), default values are the original values of the prototype
+*/
+struct SClaheParams {
+	EContrastEnhancement mode_ = EContrastEnhancement::CLAHE; ///< mode of the contrast enhancement
+	double clipLimit_ = 3.0; ///< CLAHE clip limit
+	int tilesGrid_ = 8; ///< CLAHE tiles grid size (in both axes)
+	int parallelBands_ = 0; ///< number of bands of the image processed in parallel (0 is the number of OpenCV threads)
+};
+
+///Working resolution parameters
+/**
+  The images are downscaled after loading (see CImage), the longer side of the image is limited (0 means the full resolution)
+*/
+struct SResolutionParams {
+	int maxSceneResolution_ = 0; ///< maximal size of the longer side of the scene image in pixels
+	int maxReferenceResolution_ = 0; ///< maximal size of the longer side of the reference images in pixels
+};
+
+///Grid detection parameters
+/**
+  The image can be split into a grid of cells, every cell is detected separately (in parallel) with its own features limit (see CImage::detectGridFeatures)
+*/
+struct SGridDetectionParams {
+	int cols_ = 0; ///< number of the grid columns (0 disables the grid detection together with rows_)
+	int rows_ = 0; ///< number of the grid rows (0 disables the grid detection together with cols_)
+	int cellFeaturesLimit_ = 0; ///< features limit of every cell (0 means the features limit divided by the number of cells)
+
+	/**
+	 * @brief Gives information whether the grid detection is enabled
+	 * @return true if the image is split into the cells
+	*/
+	bool enabled() const { return cols_ > 0 && rows_ > 0; }
+};
+
+///Descriptors storage parameters
+/**
+  Representation of the reference images descriptors in the memory
+*/
+struct SDescriptorStorageParams {
+	bool quantizeReferences_ = false; ///< float descriptors (SIFT, RootSIFT) of the reference images are quantized into bytes (see CImage::quantizeDescriptors)
+	bool packBinaryDescriptors_ = false; ///< binary descriptors (ORB, BEBLID) of all the images are packed for the popcount Hamming matching (see CBinaryDescriptorStore)
+};
+
+///Retrieval parameters
+/**
+  Choosing of the reference images that are matched with the scene by the visual vocabulary (see CVocabularyTree)
+*/
+struct SRetrievalParams {
+	bool enabled_ = false; ///< only the short list of the reference images given by the vocabulary is matched (otherwise all of them)
+	int branching_ = 10; ///< branching factor of the vocabulary tree (k of the hierarchical k-means)
+	int depth_ = 4; ///< depth of the vocabulary tree (at most branching_^depth_ visual words)
+	int shortlistSize_ = 10; ///< number of the reference images that are matched with the scene
+	bool globalIndex_ = false; ///< the scene is matched once against the single index of all the reference descriptors (see CGlobalDescriptorIndex)
+};
+
+/**
+ * @brief Direction of the matching - which descriptors are the queries (the other side is indexed by the matcher)
+*/
+enum class EMatchingDirection {
+	OBJECT_TO_SCENE, ///< object descriptors are the queries, the scene is indexed once per scene and shared by all the objects
+	SCENE_TO_OBJECT, ///< scene descriptors are the queries, every object is indexed once and kept for all the scenes
+	AUTO ///< the bigger side of every pair is indexed
+};
+
+///Matching parameters
+/**
+  Parameters of the matching of the scene with the objects
+*/
+struct SMatchingParams {
+	EMatchingDirection direction_ = EMatchingDirection::OBJECT_TO_SCENE; ///< which descriptors are the queries
+	bool crossCheck_ = false; ///< the found matches are made one-to-one (every object and every scene feature keeps only its closest match)
+	bool benchmarkGemm_ = false; ///< the GEMM matching is compared with BFMatcher for several numbers of the descriptors (GEMM_matching only)
+};
+
+///HNSW parameters
+/**
+  Parameters of the HNSW graph used by the HNSW matching method (see CHnswIndex)
+*/
+struct SHnswParams {
+	int M_ = 16; ///< maximal number of the neighbours of the node (2 * M_ on the level 0)
+	int efConstruction_ = 200; ///< size of the candidates list during the build (the bigger the better graph and the slower build)
+	int efSearch_ = 64; ///< size of the candidates list during the search (the bigger the higher recall and the slower search)
+	string indexFile_; ///< file with the saved graph of the global descriptor index (empty - the graph is not saved)
+	bool measureRecall_ = false; ///< the recall and latency of the search are measured against the brute force for the best match
+};
+
+///Geometric verification parameters
+/**
+  Robust homography (USAC MAGSAC) of the top candidates by the matched object features ratio, the candidates are ranked by the inliers count
+*/
+struct SVerificationParams {
+	bool enabled_ = false; ///< whether the top candidates are verified
+	int topK_ = 3; ///< number of the verified candidates
+	int maxIterations_ = 500; ///< iterations budget of one homography estimation
+	double confidence_ = 0.99; ///< confidence of the estimation (the estimation terminates early when it is reached)
+	double threshold_ = 3.0; ///< maximal reprojection error of the inlier (pixels)
+	int minInliers_ = 15; ///< the best candidate is rejected if it has fewer inliers
+	double minConfidence_ = 0.1; ///< the best candidate is rejected if its confidence score is lower
+};
+
+///Cascade parameters
+/**
+  Early rejection of the references that can't beat the best reference matched until now
+*/
+struct SCascadeParams {
+	bool enabled_ = false; ///< whether the references are first matched by the subset of their descriptors
+	double subsetRatio_ = 0.1; ///< ratio of the descriptors (with the strongest response) matched in the first stage (4x more in the second stage)
+	double tolerance_ = 0.05; ///< margin added to the estimate of the subset, the reference is rejected if even the estimate with the margin can't beat the best (1 - only the exact bound is used)
+};
+
+///GMS parameters
+/**
+  Grid-based motion statistics filter of the matches before the homography estimation (see CGmsFilter)
+*/
+struct SGmsParams {
+	bool enabled_ = false; ///< whether the matches are filtered by GMS before RANSAC
+	int gridSize_ = 20; ///< number of the cells of the grid in both axes
+	double thresholdFactor_ = 6.0; ///< factor of the threshold of the motion statistics (the higher the stricter)
+};
+
+///Frame tracking parameters
+/**
+  Tracking of the inlier correspondences between the consecutive frames of the stream (pyramidal Lucas-Kanade optical flow)
+*/
+struct STrackingParams {
+	bool enabled_ = false; ///< the frames are tracked after the successful localization instead of the full detection and matching
+	int minInliers_ = 30; ///< minimal number of the tracked inliers, the frame is relocalized when fewer are left
+	double maxReprojectionError_ = 3.0; ///< maximal mean reprojection error (pixels of the working resolution) of the tracked inliers, the frame is relocalized when it is exceeded
+	int windowSize_ = 21; ///< size of the search window of the optical flow at each pyramid level
+	int pyramidLevels_ = 3; ///< maximal pyramid level of the optical flow (0 means no pyramid)
+};
+
+/**
+ * @brief Solver of the camera pose from the corners of the reference image
+*/
+enum class EPoseSolver {
+	ITERATIVE, ///< solvePnP with SOLVEPNP_ITERATIVE (Levenberg-Marquardt), it is run twice
+	IPPE ///< closed-form planar solver (see PlanarPose.h), nothing is allocated
+};
+
+///Pose parameters
+/**
+  Parameters of the computation of the camera pose (see CImageLocator3D)
+*/
+struct SPoseParams {
+	EPoseSolver solver_ = EPoseSolver::ITERATIVE; ///< solver of the pose
+	bool refine_ = true; ///< one Gauss-Newton step of the reprojection error after the IPPE solver
+};
+
+///GPS prior parameters
+/**
+  Approximate position of the device (coarse GPS fix), only the references within the radius are matched (see CGpsPriorIndex)
+*/
+struct SGpsPriorParams {
+	bool enabled_ = false; ///< the references are prefiltered by the position
+	double longitude_ = 0.0; ///< approximate longitude of the device
+	double latitude_ = 0.0; ///< approximate latitude of the device
+	double radius_ = 500.0; ///< radius in meters around the position in which the facades of the references have to be
+};
+
+///Multithreading parameters
+/**
+  Number of threads used in the individual stages of the processing (1 is the sequential processing, 0 is the number of hardware threads)
+*/
+struct SThreadingParams {
+	unsigned int extractionThreads_ = 1; ///< number of threads detecting and describing features of the images (see CImageProcessingPool)
+	unsigned int matchingThreads_ = 1; ///< number of threads matching the scene with the objects (see CWorkStealingPool)
+};
+
 
 /**
  * @brief Enum with all implemented algorithms that can be vary
@@ -125,7 +325,9 @@ enum class EAlgorithm {
 	ALG_BEBLID,
 #endif
 	ALG_BF_MATCHING,
-	ALG_FLANN_MATCHING
+	ALG_FLANN_MATCHING,
+	ALG_HNSW_MATCHING,
+	ALG_GEMM_MATCHING
 };
 
 ///All parameters that are being passed in the program
@@ -149,6 +351,23 @@ struct SProcessParams {
 	bool calcProjectionFrom3D_; ///< determines if part of the output will be the volume recognision image (projected guessed bounding box of the building)
 	bool calcGCSLocation_; ///<determines if the global location (GPS) calculation will take place
 
+	//not part of the constructor, default values are used unless set
+	SDescriptorCacheParams cacheParams_; ///< parameters of the reference descriptor cache
+	SThreadingParams threadingParams_; ///< multithreading parameters
+	SClaheParams claheParams_; ///< contrast enhancement parameters
+	SResolutionParams resolutionParams_; ///< working resolution parameters
+	SGridDetectionParams gridParams_; ///< grid detection parameters
+	SDescriptorStorageParams storageParams_; ///< descriptors storage parameters
+	SRetrievalParams retrievalParams_; ///< retrieval parameters
+	SMatchingParams matchingParams_; ///< matching parameters
+	SHnswParams hnswParams_; ///< HNSW matching parameters
+	SVerificationParams verificationParams_; ///< geometric verification parameters
+	SCascadeParams cascadeParams_; ///< cascade rejection parameters
+	SGmsParams gmsParams_; ///< GMS filter parameters
+	STrackingParams trackingParams_; ///< frame tracking parameters of the streaming mode
+	SPoseParams poseParams_; ///< pose solver parameters
+	SGpsPriorParams gpsPriorParams_; ///< GPS prior parameters
+
 
 	///basic constructor
 	SProcessParams(const EAlgorithm& detectMethod,
@@ -17,29 +17,9 @@ double sm::gcsDistance(SGcsCoords first, SGcsCoords second)
 	return EARTH_RADIUS_IN_METERS * 2 * asin(sqrt(insideSqrt)); //in meters
 }
 
-double sm::distance(double ax, double ay, double bx, double by)
-{
-	double diffX = ax - bx;
-	double diffY = ay - by;
-	return sqrt(pow(diffX, 2) + pow(diffY, 2));
-}
-
-double sm::distance(double ax, double ay, double az, double bx, double by, double bz)
-{
-	double diffX = ax - bx;
-	double diffY = ay - by;
-	double diffZ = az - bz;
-	return sqrt(pow(diffX, 2) + pow(diffY, 2) + pow(diffZ, 2));
-}
-
-Point2d sm::getMidPoint2D(double ax, double ay, double bx, double by)
-{
-	return Point2d((ax + bx)/2, (ay + by)/2);
-}
-
 Mat sm::getHomogenousVector3D(double x, double y, double z)
 {
-	return (Mat_<double>(4,1) << x, y, z, 1.0);
+	return Mat(getHomogenousVec3D(x, y, z));
 }
 
 double sm::metersInLatDeg(double latitude)
@@ -72,100 +52,93 @@ double sm::longtitudeCorrectionFactor(double latitude)
 }
 
 
-double sm::radToDeg(double radAngle)
+void sm::SPlanarTriplesBatch::reserve(size_t count)
 {
-	return radAngle * (180.0 / M_PI);
+	p1x_.reserve(count);
+	p1y_.reserve(count);
+	p2x_.reserve(count);
+	p2y_.reserve(count);
+	p3x_.reserve(count);
+	p3y_.reserve(count);
+	referenceIndex_.reserve(count);
 }
 
-double sm::degToRad(double degAngle)
+void sm::SPlanarTriplesBatch::push_back(const Point2d& p1, const Point2d& p2, const Point2d& p3, int referenceIndex)
 {
-	return degAngle * (M_PI / 180.0);
+	p1x_.push_back(p1.x);
+	p1y_.push_back(p1.y);
+	p2x_.push_back(p2.x);
+	p2y_.push_back(p2.y);
+	p3x_.push_back(p3.x);
+	p3y_.push_back(p3.y);
+	referenceIndex_.push_back(referenceIndex);
 }
 
-double sm::vectorAngle2D(double ax, double ay, double bx, double by, double cx, double cy)
+sm::SGcsReferenceFrame sm::createGcsReferenceFrame(const SGcsCoords& p2Gcs, const SGcsCoords& p3Gcs)
 {
-	Mat vec1 = (Mat_<double>(2, 1) << (ax - bx), (ay - by));
-	Mat vec2 = (Mat_<double>(2, 1) << (cx - bx), (cy - by));
-	normalize(vec1, vec1);
-	normalize(vec2, vec2);
-	return acos(vec1.dot(vec2));
-}
+	SGcsReferenceFrame frame;
+	frame.p3Longitude_ = p3Gcs.longitude;
+	frame.p3Latitude_ = p3Gcs.latitude_;
 
-double sm::getVecRotFromEast(double ax, double ay)
-{
-	Mat vec = (Mat_<double>(2, 1) << ax, ay);
-	normalize(vec, vec);
-	Mat eastVector = (Mat_<double>(2, 1) << 1.0, 0.0);
+	//the longtitude and latitude are not in the same scale is it is needed to scale them to same scale for the computations
+	//keep in mind that for meassuring distances using global methods like haversine formula it is needed to convert the longtitude back for the meassuring
+	double longtitudeAdjustFactor = longtitudeAdjustingFactor(p3Gcs.latitude_);
+	//direction of the vector twoToThree (the angle to the vector pointing to east is given by its cosine and sine)
+	Vec2d gcsDiff = normalize(Vec2d((p2Gcs.longitude - p3Gcs.longitude) * longtitudeAdjustFactor, p2Gcs.latitude_ - p3Gcs.latitude_));
+	frame.eastCos_ = gcsDiff[0];
+	frame.eastSin_ = gcsDiff[1];
 
-	double adjustTheSign = vec.at<double>(1) < 0 ? -1.0 : 1.0; //the angle will be negative in case of negative y
-	double radAngleWithEast = adjustTheSign * acos(vec.dot(eastVector));
-	//cout << "angle with the vector to east: " << radToDeg(radAngleWithEast) << endl;
+	//for meassuring distance we have to use correct coordinates (so the unchanged coordinates have to be used)
+	frame.gcsDistance_ = sm::gcsDistance(p2Gcs, p3Gcs);
+	frame.metersInLongDeg_ = metersInLongDeg(p3Gcs.latitude_);
+	frame.metersInLatDeg_ = metersInLatDeg(p3Gcs.latitude_);
+	return frame;
+}
 
-	return radAngleWithEast;
+void sm::solve3Kto2Kand1UBatch(const SPlanarTriplesBatch& triples, const vector<SGcsReferenceFrame>& frames,
+	vector<double>& longitudes, vector<double>& latitudes)
+{
+	const size_t count = triples.size();
+	if (triples.p1y_.size() != count || triples.p2x_.size() != count || triples.p2y_.size() != count ||
+		triples.p3x_.size() != count || triples.p3y_.size() != count || triples.referenceIndex_.size() != count) {
+		throw invalid_argument("solve3Kto2Kand1UBatch: all the arrays of the triples have to have the same size.");
+	}
+	for (size_t i = 0; i < count; ++i) {
+		if (triples.referenceIndex_[i] < 0 || (size_t)triples.referenceIndex_[i] >= frames.size()) {
+			throw invalid_argument("solve3Kto2Kand1UBatch: reference index of the triple " + to_string(i) + " is out of range.");
+		}
+	}
+	longitudes.resize(count);
+	latitudes.resize(count);
+
+	const double* p1x = triples.p1x_.data();
+	const double* p1y = triples.p1y_.data();
+	const double* p2x = triples.p2x_.data();
+	const double* p2y = triples.p2y_.data();
+	const double* p3x = triples.p3x_.data();
+	const double* p3y = triples.p3y_.data();
+	const int* referenceIndex = triples.referenceIndex_.data();
+	const SGcsReferenceFrame* frame = frames.data();
+	double* longitude = longitudes.data();
+	double* latitude = latitudes.data();
+	auto solveRange = [&](const Range& range) {
+		for (int i = range.start; i < range.end; ++i) {
+			solve3Kto2Kand1U(p1x[i], p1y[i], p2x[i], p2y[i], p3x[i], p3y[i], frame[referenceIndex[i]], longitude[i], latitude[i]);
+		}
+	};
+	if (count < GCS_BATCH_STRIPE_SIZE) {
+		solveRange(Range(0, (int)count));
+	}
+	else {
+		parallel_for_(Range(0, (int)count), solveRange, (double)count / GCS_BATCH_STRIPE_SIZE);
+	}
 }
 
 sm::SGcsCoords sm::solve3Kto2Kand1U(const Point2d& p1, const Point2d& p2, const Point2d& p3,
 	const SGcsCoords& p2Gcs, const SGcsCoords& p3Gcs, Ptr<CLogger>& logger)
 {
-	//convert points to vectors
-	Mat p1Vec(p1);
-	Mat p2Vec(p2);
-	Mat p3Vec(p3);
-	
-	//gcs (Geographic coordinate system) coordinate system
-	//first longtitude (x) and then lattitude(y)
-	//converting coordinates to 
-	Mat gcsP2Vec(p2Gcs.convertToOpenCVFormat());
-	Mat gcsP3Vec(p3Gcs.convertToOpenCVFormat());
-
-	//the longtitude and latitude are not in the same scale is it is needed to scale them to same scale for the computations
-	//keep in mind that for meassuring distances using global methods like haversine formula it is needed to convert the longtitude back for the meassuring
-	double longtitudeAdjustFactor = longtitudeAdjustingFactor(p3Gcs.latitude_);
-
-	//adjust the points to make same meassures in both dirrections
-	//===========================================================================================================TODO!!!!!!
-	//TODO further research on the longtitude correction
-	gcsP2Vec.at<double>(0) *= longtitudeAdjustFactor;
-	gcsP3Vec.at<double>(0) *= longtitudeAdjustFactor;
-
-	//angle of vector twoToThree to the vector pointing to east
-	Mat gcsDiff = gcsP2Vec - gcsP3Vec;
-	double radAngleWithEast = getVecRotFromEast(gcsDiff.at<double>(0), gcsDiff.at<double>(1));
-	//logger->log("gcs Diff x: ").log(to_string(gcsDiff.at<double>(0))).log(" gcs Diff y: ").log(to_string(gcsDiff.at<double>(1))).endl();
-	//logger->log("angle from east: ").log(to_string(radToDeg(radAngleWithEast))).endl();
-
-	//p3 to p2
-	double radAngleAtP3 = sm::vectorAngle2D(p2.x, p2.y, p3.x, p3.y, p1.x, p1.y);
-	//logger->log("angle that is by the point three: ").log(to_string(radToDeg(radAngleAtP3))).endl();
-
-	//create vector from point three to the camera in the gcs
-	double radAngleDirVec = radAngleWithEast - radAngleAtP3;//angle between east vector and vector from point three and camera - angle of future direction vector of the line between point three and camera
-	Point2d lineDirVec(cos(radAngleDirVec), sin(radAngleDirVec));
-	//logger->log("angle that is taken from the east to the right point: ").log(to_string(radToDeg(radAngleDirVec))).endl();
-	//logger->log("cos: ").log(to_string(cos(radAngleDirVec))).log(" sin:").log(to_string(sin(radAngleDirVec))).endl();
-
-	//Computing the scale between two scales (between the camera space scale and the gcs scale)
-	//for meassuring distance we have to use correct coordinates (so the unchanged coordinates have to be used)
-	double gcsDistance = sm::gcsDistance(p2Gcs, p3Gcs);
-	//calculate distance in our space
-	double distance = sm::distance(p2.x, p2.y, p3.x, p3.y);
-	double distScaleFactor = distance / gcsDistance;
-	//logger->log("gcsDistance: ").log(to_string(gcsDistance)).endl();
-	//logger->log("our distance: ").log(to_string(distance)).endl();
-	//logger->log("scale factor of the distances: ").log(to_string(distScaleFactor)).endl();
-
-
-	//Calculating the p1 gcs location
-	double distanceP3ToP1 = sm::distance(p1.x, p1.y, p3.x, p3.y);
-	//just fill the parametric formula of a line and get the location of p1 (camera in the project)
-	Point2d p1GcsLoc;
-	//logger->log("distance from camera to p3: ").log(to_string((distanceP3ToP1 / distScaleFactor))).endl();
-	p1GcsLoc.x = p3Gcs.longitude + ((distanceP3ToP1 / distScaleFactor) * lineDirVec.x) / (metersInLongDeg(p3Gcs.latitude_));
-	p1GcsLoc.y = p3Gcs.latitude_ + ((distanceP3ToP1 / distScaleFactor) * lineDirVec.y) / (metersInLatDeg(p3Gcs.latitude_));
-	//logger->log("what is being added: ").log(to_string(metersInLongDeg(p3Gcs.latitude_))).endl();
-
-	//converting back to correct longtitude
-	//p1GcsLoc.x *= longtitudeCorrectionFactor(p3Gcs.latitude_);
-
-	return sm::SGcsCoords(p1GcsLoc.x, p1GcsLoc.y);
+	//the same computation as the batch one, only with the reference frame of this single camera
+	double longitude, latitude;
+	solve3Kto2Kand1U(p1.x, p1.y, p2.x, p2.y, p3.x, p3.y, createGcsReferenceFrame(p2Gcs, p3Gcs), longitude, latitude);
+	return sm::SGcsCoords(longitude, latitude);
 }
@@ -4,6 +4,9 @@
  * \author     Pavel Kriz
  * \date       1/5/2021
  * \brief      Contains functions computing different problems in 3D, 2D and geographical space.
+ *
+ * The geometry is computed with the fixed-size value types (Vec, Matx) so nothing is allocated on the heap,
+ * the small functions are inline. The functions with the Mat results are only adapters of the fixed-size ones.
 */
 //----------------------------------------------------------------------------------------
 
@@ -13,6 +16,11 @@
 //for the constants
 #define _USE_MATH_DEFINES
 #include<cmath>
+//min, max
+#include <algorithm>
+#include <vector>
+//invalid_argument
+#include <stdexcept>
 //output
 #include <iostream>
 //manipulating the stream
@@ -21,8 +29,12 @@
 #include <opencv2/core/types.hpp>
 //matrix
 #include <opencv2/core/mat.hpp>
+//fixed-size matrices and vectors
+#include <opencv2/core/matx.hpp>
 //core functions
 #include <opencv2/core.hpp>
+//parallel_for_
+#include <opencv2/core/utility.hpp>
 
 #include "SGcsCoords.h"
 #include "CLogger.h"
@@ -47,6 +59,10 @@ namespace sm {
      * @brief offset of camera in the height of the top of head
     */
     const double CAMERA_HOLDING_OFFSET = 0.2; // in meters
+    /**
+     * @brief the batch localization with at least that many triples is split into parallel stripes of about that size
+    */
+    const size_t GCS_BATCH_STRIPE_SIZE = 4096;
     
     /**
      * @brief returns distance in meters between two points in global coordinate system
@@ -63,7 +79,12 @@ namespace sm {
      * @param by y coordinate of point b 
      * @return distance between points a and b
     */
-    double distance(double ax, double ay, double bx, double by);
+    inline double distance(double ax, double ay, double bx, double by)
+    {
+        double diffX = ax - bx;
+        double diffY = ay - by;
+        return sqrt(diffX * diffX + diffY * diffY);
+    }
     /**
      * @brief Calculates Euclidean distance between points a and b in 3D
      * @param ax x coordinate of point a
@@ -74,7 +95,20 @@ namespace sm {
      * @param bz z coordinate of point b
      * @return distance between points a and b
     */
-    double distance(double ax, double ay, double az, double bx, double by, double bz);
+    inline double distance(double ax, double ay, double az, double bx, double by, double bz)
+    {
+        double diffX = ax - bx;
+        double diffY = ay - by;
+        double diffZ = az - bz;
+        return sqrt(diffX * diffX + diffY * diffY + diffZ * diffZ);
+    }
+    /**
+     * @brief Calculates Euclidean distance between points a and b in 3D
+     * @param a point a
+     * @param b point b
+     * @return distance between points a and b
+    */
+    inline double distance(const Vec3d& a, const Vec3d& b) { return norm(a - b); }
     
     /**
      * @brief Calculate point between A and B (halfway on the line from A to B)
@@ -85,14 +119,22 @@ namespace sm {
      * @param by y coordinate of point b
      * @return the midpoint
     */
-    Point2d getMidPoint2D(double ax, double ay, double bx, double by);
+    inline Point2d getMidPoint2D(double ax, double ay, double bx, double by) { return Point2d((ax + bx) / 2, (ay + by) / 2); }
     /**
-     * @brief From (x,y,z) creates (x,y,z,1)^T matrix
+     * @brief From (x,y,z) creates (x,y,z,1)^T vector
      * @param x coordinate
      * @param y coordinate
      * @param z coordinate
      * @return the homogeneus coordinates
     */
+    inline Vec4d getHomogenousVec3D(double x, double y, double z) { return Vec4d(x, y, z, 1.0); }
+    /**
+     * @brief From (x,y,z) creates (x,y,z,1)^T matrix (adapter of getHomogenousVec3D, the matrix is allocated)
+     * @param x coordinate
+     * @param y coordinate
+     * @param z coordinate
+     * @return the homogeneus coordinates (4x1 matrix)
+    */
     Mat getHomogenousVector3D(double x, double y, double z);
     /**
      * @brief Get how many meters are in one latitude degree for given latitude
@@ -124,13 +166,24 @@ namespace sm {
      * @param radAngle angle in radians
      * @return angle in degrees
     */
-    double radToDeg(double radAngle);
+    constexpr double radToDeg(double radAngle) { return radAngle * (180.0 / M_PI); }
     /**
      * @brief Convertion from degrees to radians
      * @param degAngle angle in degrees
      * @return angle in radians
     */
-    double degToRad(double degAngle);
+    constexpr double degToRad(double degAngle) { return degAngle * (M_PI / 180.0); }
+    /**
+     * @brief Angle between two vectors
+     * @param first first vector (non-zero)
+     * @param second second vector (non-zero)
+     * @return the angle between the two vectors in radians
+    */
+    inline double vectorAngle2D(const Vec2d& first, const Vec2d& second)
+    {
+        //clamped so the rounding of the parallel vectors does not give NaN
+        return acos(max(-1.0, min(1.0, normalize(first).dot(normalize(second)))));
+    }
     /**
      * @brief Angle between two vectors defined by points ABC, first vector: A - B, second vector C - B
      * @param ax x point A coordinate
@@ -141,7 +194,23 @@ namespace sm {
      * @param cy y point C coordinate
      * @return the angle between the two vectors
     */
-    double vectorAngle2D(double ax, double ay, double bx, double by, double cx, double cy);
+    inline double vectorAngle2D(double ax, double ay, double bx, double by, double cx, double cy)
+    {
+        return vectorAngle2D(Vec2d(ax - bx, ay - by), Vec2d(cx - bx, cy - by));
+    }
+    /**
+     * @brief return the angle between given vector and vector pointing to east (1.0, 0.0)
+     * 
+     * for negative Y is the angle negative
+     * 
+     * @param vec the vector (non-zero)
+     * @return the angle in radians
+    */
+    inline double getVecRotFromEast(const Vec2d& vec)
+    {
+        double adjustTheSign = vec[1] < 0 ? -1.0 : 1.0; //the angle will be negative in case of negative y
+        return adjustTheSign * vectorAngle2D(vec, Vec2d(1.0, 0.0));
+    }
     /**
      * @brief return the angle between given vector and vector pointing to east (1.0, 0.0)
      * 
@@ -151,7 +220,127 @@ namespace sm {
      * @param ay y coordinate of give vector
      * @return the angle in radians
     */
-    double getVecRotFromEast(double ax, double ay);
+    inline double getVecRotFromEast(double ax, double ay) { return getVecRotFromEast(Vec2d(ax, ay)); }
+    /**
+     * @brief Gives the homogenous matrix that transforms the points into the orthonormal basis (the inverse of the change of basis matrix)
+     * 
+     * The inverse of the orthonormal matrix is its transposition, so no inversion is computed.
+     * 
+     * @param xAxis x basis vector (unit, perpendicular to the others)
+     * @param yAxis y basis vector (unit, perpendicular to the others)
+     * @param zAxis z basis vector (unit, perpendicular to the others)
+     * @return 4x4 homogenous matrix
+    */
+    inline Matx44d toOrthonormalBasis(const Vec3d& xAxis, const Vec3d& yAxis, const Vec3d& zAxis)
+    {
+        return Matx44d(
+            xAxis[0], xAxis[1], xAxis[2], 0.0,
+            yAxis[0], yAxis[1], yAxis[2], 0.0,
+            zAxis[0], zAxis[1], zAxis[2], 0.0,
+            0.0, 0.0, 0.0, 1.0);
+    }
+
+    /**
+     * @brief Values of the solve3Kto2Kand1U that depend only on the global coordinates of p2 and p3 (the corners of the reference)
+     * 
+     * They are computed once per reference, so the localization of the scenes of the same reference needs no trigonometry.
+     * 
+    */
+    struct SGcsReferenceFrame {
+        double p3Longitude_ = 0.0; ///< longitude of p3
+        double p3Latitude_ = 0.0; ///< latitude of p3
+        double eastCos_ = 1.0; ///< cosine of the angle of the vector p3 -> p2 from east (longitude adjusted to the latitude scale)
+        double eastSin_ = 0.0; ///< sine of the angle of the vector p3 -> p2 from east (longitude adjusted to the latitude scale)
+        double gcsDistance_ = 0.0; ///< distance in meters between p2 and p3
+        double metersInLongDeg_ = 1.0; ///< meters in one longitude degree at p3
+        double metersInLatDeg_ = 1.0; ///< meters in one latitude degree at p3
+    };
+    /**
+     * @brief Planar point triples of many cameras in the structure of arrays layout (one item of every array per camera)
+     * 
+     * The points are the same as in solve3Kto2Kand1U (p1 is the camera), referenceIndex_ points into the reference frames.
+     * 
+    */
+    struct SPlanarTriplesBatch {
+        vector<double> p1x_, p1y_; ///< the camera points
+        vector<double> p2x_, p2y_; ///< the points with the known global location p2
+        vector<double> p3x_, p3y_; ///< the points with the known global location p3
+        vector<int> referenceIndex_; ///< index of the reference frame of the triple
+        /**
+         * @brief Gives the number of the triples
+         * @return the number of the triples
+        */
+        size_t size() const { return p1x_.size(); }
+        /**
+         * @brief Reserves the space for the triples
+         * @param count expected number of the triples
+        */
+        void reserve(size_t count);
+        /**
+         * @brief Appends the triple
+         * @param p1 the camera point
+         * @param p2 the point with the known global location p2
+         * @param p3 the point with the known global location p3
+         * @param referenceIndex index of the reference frame of the triple
+        */
+        void push_back(const Point2d& p1, const Point2d& p2, const Point2d& p3, int referenceIndex);
+    };
+    /**
+     * @brief Computes the values of the solve3Kto2Kand1U that depend only on the global coordinates of p2 and p3
+     * @param p2Gcs global location of p2
+     * @param p3Gcs global location of p3
+     * @return the reference frame
+    */
+    SGcsReferenceFrame createGcsReferenceFrame(const SGcsCoords& p2Gcs, const SGcsCoords& p3Gcs);
+    /**
+     * @brief computes global coordinates of p1 in the already prepared reference frame (see solve3Kto2Kand1U), no trigonometry is used
+     * 
+     * The angle of the direction p3 -> p1 is the difference of two angles, so its cosine and sine are composed
+     * from the cosines and sines of the two angles (they are given by the dot and cross products).
+     * 
+     * @param p1x x of the camera point
+     * @param p1y y of the camera point
+     * @param p2x x of the point p2
+     * @param p2y y of the point p2
+     * @param p3x x of the point p3
+     * @param p3y y of the point p3
+     * @param frame the reference frame of p2 and p3
+     * @param longitude output longitude of p1
+     * @param latitude output latitude of p1
+    */
+    inline void solve3Kto2Kand1U(double p1x, double p1y, double p2x, double p2y, double p3x, double p3y,
+        const SGcsReferenceFrame& frame, double& longitude, double& latitude)
+    {
+        double p3ToP2x = p2x - p3x, p3ToP2y = p2y - p3y;
+        double p3ToP1x = p1x - p3x, p3ToP1y = p1y - p3y;
+        double distanceP3ToP2 = sqrt(p3ToP2x * p3ToP2x + p3ToP2y * p3ToP2y);
+        double distanceP3ToP1 = sqrt(p3ToP1x * p3ToP1x + p3ToP1y * p3ToP1y);
+        double invNorms = 1.0 / (distanceP3ToP2 * distanceP3ToP1);
+        //unsigned angle at p3 between p3 -> p2 and p3 -> p1
+        double cosAtP3 = (p3ToP2x * p3ToP1x + p3ToP2y * p3ToP1y) * invNorms;
+        double sinAtP3 = abs(p3ToP2x * p3ToP1y - p3ToP2y * p3ToP1x) * invNorms;
+        //direction of the line from p3 to the camera - angle from east minus the angle at p3
+        double lineDirX = frame.eastCos_ * cosAtP3 + frame.eastSin_ * sinAtP3;
+        double lineDirY = frame.eastSin_ * cosAtP3 - frame.eastCos_ * sinAtP3;
+        //distance from p3 to p1 in meters (the scale between the local space and the gcs is given by the p2 - p3 distance)
+        double meters = distanceP3ToP1 * frame.gcsDistance_ / distanceP3ToP2;
+        longitude = frame.p3Longitude_ + meters * lineDirX / frame.metersInLongDeg_;
+        latitude = frame.p3Latitude_ + meters * lineDirY / frame.metersInLatDeg_;
+    }
+    /**
+     * @brief computes global coordinates of the cameras of many triples at once (see solve3Kto2Kand1U)
+     * 
+     * The triples are in the structure of arrays layout and the reference dependent values are precomputed,
+     * so the loop is only arithmetic (the compiler can vectorize it), large batches are split into parallel stripes.
+     * 
+     * @param triples the planar point triples
+     * @param frames reference frames (see createGcsReferenceFrame), indexed by the referenceIndex_ of the triples
+     * @param longitudes output longitudes of the cameras (one per triple)
+     * @param latitudes output latitudes of the cameras (one per triple)
+     * @throw invalid_argument if the arrays of the triples have different sizes or the reference index is out of range
+    */
+    void solve3Kto2Kand1UBatch(const SPlanarTriplesBatch& triples, const vector<SGcsReferenceFrame>& frames,
+        vector<double>& longitudes, vector<double>& latitudes);
 
     /**
      * @brief computes global coordinates (global coordinates system) for third point
@@ -62,6 +62,41 @@ const bool BEBLID_N_BITS_TEST = true;
 const xfeatures2d::BEBLID::BeblidSize BEBLID_N_BITS = xfeatures2d::BEBLID::SIZE_512_BITS;
 #endif
 
+//========================================CLAHE parameters========================================
+//used only in the adaptive contrast enhancement mode (see CClaheStage)
+const double CLAHE_LOW_CONTRAST_TILE_STDDEV = 12.0; ///< tile with lower standard deviation of the intensity is considered as a low contrast tile
+const double CLAHE_MAX_LOW_CONTRAST_TILES_RATIO = 0.1; ///< if the ratio of the low contrast tiles is not higher, the global histogram equalisation is used instead of CLAHE
+
+//========================================grid detection parameters========================================
+//the cell is detected in a bigger region so the keypoints near the cell border are not lost (the detectors ignore the image border)
+const int GRID_DETECTION_CELL_MARGIN = 32; ///< margin of the detected region around the cell in pixels
+
+//========================================matching parameters========================================
+const size_t MIN_FILTERED_MATCHES = 4; ///< the ratio test is relaxed until at least that many matches pass it (minimum for the homography)
+const double RATIO_TEST_ALPHA_STEP = 0.05; ///< step of the relaxation of the ratio test
+const int CASCADE_MIN_SUBSET_SIZE = 32; ///< minimal number of the descriptors in the first stage of the cascade
+const int CASCADE_SECOND_STAGE_FACTOR = 4; ///< the second stage of the cascade matches that many times more descriptors than the first one
+
+//========================================GEMM parameters========================================
+//the block sizes of the GEMM kernel are in DescriptorKernels.h
+const vector<int> GEMM_BENCHMARK_DESCRIPTORS_COUNTS = { 500, 1000, 2000, 4000, 8000 }; ///< numbers of the descriptors of the GEMM matching benchmark
+
+//========================================vocabulary (retrieval) parameters========================================
+const size_t VOCABULARY_MAX_TRAINING_DESCRIPTORS = 200000; ///< maximal number of the descriptors used for the training of the vocabulary (the rest is skipped uniformly)
+const int VOCABULARY_KMEANS_ITERATIONS = 10; ///< maximal number of the iterations of the k-means in every node of the vocabulary tree
+const uint64 VOCABULARY_RNG_SEED = 0x12345678; ///< seed of the random generator used by the k-means (the vocabulary is reproducible)
+
+//========================================HNSW parameters========================================
+const uint64 HNSW_RNG_SEED = 0x484E5357; ///< seed of the random generator of the node levels
+const int HNSW_MAX_LEVEL = 16; ///< maximal level of the node
+const int HNSW_BUILD_STRIPE_SIZE = 256; ///< approximate number of the nodes inserted by one parallel task
+const int HNSW_QUERY_STRIPE_SIZE = 64; ///< approximate number of the queries searched by one parallel task
+const vector<int> HNSW_RECALL_EF_SEARCH_VALUES = { 16, 32, 64, 128, 256 }; ///< efSearch values of the recall measurement
+
+//========================================streaming parameters========================================
+const double STREAM_SEQUENCE_FPS = 30.0; ///< frame rate of the image sequence (and of the videos without the frame rate information)
+const string STREAM_RECORDS_FILE_SUFFIX = "_stream.csv"; ///< suffix of the records file (it is placed in the output root and prefixed by the run name)
+
 //========================================CONSOLE IMAGE WINDOWS========================================
 //titles of the displayed windows
 const string PROTOTYPE_NAME = "BP_PK_CV_prototype";
@@ -100,9 +135,65 @@ const string RATIO_TEST_ALPHA_JSON_KEY = "ratio_test_alpha";
 const string STANDING_PERSON_OPTIMALISATION_JSON_KEY = "standing_person_optimalisation";
 const string FIND_PROJECTION_JSON_KEY = "find_projection_from_3D";
 const string FIND_GPS_JSON_KEY = "find_GPS";
+//optional parameters JSON keys (default value is used when the key is missing)
+const string PAUSE_AT_EXIT_JSON_KEY = "pause_at_exit";
+const string DESCRIPTOR_CACHE_JSON_KEY = "descriptor_cache";
+const string DESCRIPTOR_CACHE_DIR_JSON_KEY = "descriptor_cache_dir";
+const string EXTRACTION_THREADS_JSON_KEY = "extraction_threads";
+const string MATCHING_THREADS_JSON_KEY = "matching_threads";
+const string CONTRAST_ENHANCEMENT_JSON_KEY = "contrast_enhancement";
+const string CLAHE_CLIP_LIMIT_JSON_KEY = "clahe_clip_limit";
+const string CLAHE_TILES_GRID_JSON_KEY = "clahe_tiles_grid";
+const string CLAHE_PARALLEL_BANDS_JSON_KEY = "clahe_parallel_bands";
+const string MAX_SCENE_RESOLUTION_JSON_KEY = "max_scene_resolution";
+const string MAX_REFERENCE_RESOLUTION_JSON_KEY = "max_reference_resolution";
+const string DETECTION_GRID_COLS_JSON_KEY = "detection_grid_cols";
+const string DETECTION_GRID_ROWS_JSON_KEY = "detection_grid_rows";
+const string CELL_FEATURES_LIMIT_JSON_KEY = "cell_features_limit";
+const string QUANTIZED_REFERENCES_JSON_KEY = "quantized_references";
+const string PACKED_BINARY_DESCRIPTORS_JSON_KEY = "packed_binary_descriptors";
+const string RETRIEVAL_JSON_KEY = "vocabulary_retrieval";
+const string VOCABULARY_BRANCHING_JSON_KEY = "vocabulary_branching";
+const string VOCABULARY_DEPTH_JSON_KEY = "vocabulary_depth";
+const string SHORTLIST_SIZE_JSON_KEY = "shortlist_size";
+const string GLOBAL_DESCRIPTOR_INDEX_JSON_KEY = "global_descriptor_index";
+const string MATCHING_DIRECTION_JSON_KEY = "matching_direction";
+const string CROSS_CHECK_JSON_KEY = "cross_check";
+const string GEMM_BENCHMARK_JSON_KEY = "gemm_benchmark";
+const string HNSW_M_JSON_KEY = "hnsw_m";
+const string HNSW_EF_CONSTRUCTION_JSON_KEY = "hnsw_ef_construction";
+const string HNSW_EF_SEARCH_JSON_KEY = "hnsw_ef_search";
+const string HNSW_INDEX_FILE_JSON_KEY = "hnsw_index_file";
+const string HNSW_MEASURE_RECALL_JSON_KEY = "hnsw_measure_recall";
+const string GEOMETRIC_VERIFICATION_JSON_KEY = "geometric_verification";
+const string VERIFICATION_TOP_K_JSON_KEY = "verification_top_k";
+const string VERIFICATION_MAX_ITERATIONS_JSON_KEY = "verification_max_iterations";
+const string VERIFICATION_MIN_INLIERS_JSON_KEY = "verification_min_inliers";
+const string VERIFICATION_MIN_CONFIDENCE_JSON_KEY = "verification_min_confidence";
+const string CASCADE_REJECTION_JSON_KEY = "cascade_rejection";
+const string CASCADE_SUBSET_RATIO_JSON_KEY = "cascade_subset_ratio";
+const string CASCADE_TOLERANCE_JSON_KEY = "cascade_tolerance";
+const string GMS_FILTER_JSON_KEY = "gms_filter";
+const string GMS_GRID_SIZE_JSON_KEY = "gms_grid_size";
+const string GMS_THRESHOLD_FACTOR_JSON_KEY = "gms_threshold_factor";
+const string TRACKING_JSON_KEY = "tracking";
+const string TRACKING_MIN_INLIERS_JSON_KEY = "tracking_min_inliers";
+const string TRACKING_MAX_REPROJECTION_ERROR_JSON_KEY = "tracking_max_reprojection_error";
+const string TRACKING_WINDOW_SIZE_JSON_KEY = "tracking_window_size";
+const string TRACKING_PYRAMID_LEVELS_JSON_KEY = "tracking_pyramid_levels";
+const string POSE_SOLVER_JSON_KEY = "pose_solver";
+const string POSE_REFINEMENT_JSON_KEY = "pose_refinement";
+const string GPS_PRIOR_JSON_KEY = "gps_prior";
+const string GPS_PRIOR_LONGITUDE_JSON_KEY = "gps_prior_longitude";
+const string GPS_PRIOR_LATITUDE_JSON_KEY = "gps_prior_latitude";
+const string GPS_PRIOR_RADIUS_JSON_KEY = "gps_prior_radius";
 //scene images filepath JSON
 const string SCENE_INDEX_JSON_KEY = "scene_index";
 const string SCENES_ARRAY_JSON_KEY = "scenes";
+//optional scene JSON keys - streaming mode (default value is used when the key is missing)
+const string STREAM_SOURCE_JSON_KEY = "stream_source";
+const string STREAM_DROP_STALE_FRAMES_JSON_KEY = "stream_drop_stale_frames";
+const string STREAM_MAX_FRAMES_JSON_KEY = "stream_max_frames";
 //scene image additional informations
 const string CAMERA_NAME_JSON_KEY = "camera_name";
 const string FOCAL_LENGTH_JSON_KEY = "focal_length";